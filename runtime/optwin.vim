@@ -437,6 +437,8 @@ if has("syntax")
   call <SID>AddOption("synmaxcol", gettext("maximum column to look for syntax items"))
   call append("$", "\t" .. s:local_to_buffer)
   call <SID>OptionL("smc")
+  call <SID>AddOption("synmaxmem", gettext("maximum Kbyte for remembered syntax states"))
+  call <SID>OptionG("smm", &smm)
 endif
 call <SID>AddOption("highlight", gettext("which highlighting to use for various occasions"))
 call <SID>OptionG("hl", &hl)
@@ -1193,6 +1195,10 @@ call <SID>AddOption("maxmem", gettext("maximum amount of memory in Kbyte used fo
 call append("$", " \tset mm=" . &mm)
 call <SID>AddOption("maxmemtot", gettext("maximum amount of memory in Kbyte used for all buffers"))
 call append("$", " \tset mmt=" . &mmt)
+if exists("+mmapsize")
+  call <SID>AddOption("mmapsize", gettext("minimum size in Kbyte of a file whose lines are loaded when used"))
+  call append("$", " \tset mms=" . &mms)
+endif
 
 
 call <SID>Header(gettext("command line editing"))
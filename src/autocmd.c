@@ -2764,6 +2764,37 @@ getnextac(
  */
     int
 has_autocmd(event_T event, char_u *sfname, buf_T *buf)
+{
+    return has_autocmd_except(event, sfname, buf, NULL);
+}
+
+/*
+ * Return TRUE if augroup "group" is one of the names in "skip_groups", which
+ * ends in NULL.
+ */
+    static int
+au_group_skipped(int group, char **skip_groups)
+{
+    int	    i;
+
+    if (skip_groups == NULL || group < 0 || AUGROUP_NAME(group) == NULL)
+	return FALSE;
+    for (i = 0; skip_groups[i] != NULL; ++i)
+	if (STRCMP(AUGROUP_NAME(group), skip_groups[i]) == 0)
+	    return TRUE;
+    return FALSE;
+}
+
+/*
+ * Like has_autocmd(), but ignore the autocommands in the augroups named in
+ * "skip_groups", which ends in NULL.  "skip_groups" can be NULL.
+ */
+    int
+has_autocmd_except(
+    event_T	event,
+    char_u	*sfname,
+    buf_T	*buf,
+    char	**skip_groups)
 {
     AutoPat	*ap;
     char_u	*fname;
@@ -2787,6 +2818,7 @@ has_autocmd(event_T event, char_u *sfname, buf_T *buf)
 
     FOR_ALL_AUTOCMD_PATTERNS(event, ap)
 	if (ap->pat != NULL && ap->cmds != NULL
+	      && !au_group_skipped(ap->group, skip_groups)
 	      && (ap->buflocal_nr == 0
 		? match_file_pat(NULL, &ap->reg_prog,
 					  fname, sfname, tail, ap->allow_dirs)
@@ -1111,6 +1111,8 @@ free_buffer_stuff(
 #endif
 #ifdef FEAT_PROP_POPUP
     ga_clear_strings(&buf->b_textprop_text);
+    ga_clear(&buf->b_prop_index);
+    prop_index_invalidate(buf);
 #endif
     map_clear_mode(buf, MAP_ALL_MODES, TRUE, FALSE);  // clear local mappings
     map_clear_mode(buf, MAP_ALL_MODES, TRUE, TRUE);   // clear local abbrevs
@@ -1830,6 +1830,11 @@ buf_write(
 	    // quotum for number of files).
 	    // Appending will fail if the file does not exist and forceit is
 	    // FALSE.
+#ifdef USE_MMAP
+	    // When overwriting the file that lines are loaded from, all of
+	    // them need to be read first.
+	    ml_lazy_detach(buf, wfname);
+#endif
 	    while ((fd = mch_open((char *)wfname, O_WRONLY | O_EXTRA | (append
 				? (forceit ? (O_APPEND | O_CREAT) : O_APPEND)
 				: (O_CREAT | TRUNC_ON_OPEN))
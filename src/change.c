@@ -642,6 +642,9 @@ changed_common(
     // mark the buffer as modified
     changed();
 
+    // The text of the cached line may have been changed in place.
+    curbuf->b_ml.ml_flags &= ~ML_ASCII_CHECKED;
+
 #ifdef FEAT_EVAL
     // Immediately send this change to any listeners that require changes not
     // to be buffered.
@@ -1546,6 +1549,7 @@ del_bytes(
 #endif
 	curbuf->b_ml.ml_line_len -= count;
 	curbuf->b_ml.ml_line_textlen = 0;
+	curbuf->b_ml.ml_flags &= ~ML_ASCII_CHECKED;
     }
 
     // mark the buffer as changed and prepare for displaying
@@ -399,9 +399,7 @@ free_unused_channels(int copyID, int mask)
     }
 }
 
-#if defined(FEAT_GUI)
-
-# if defined(FEAT_GUI_X11) || defined(FEAT_GUI_GTK)
+#if defined(FEAT_GUI_X11) || defined(FEAT_GUI_GTK) || defined(USE_EPOLL)
 /*
  * Lookup the channel from the socket.  Set "partp" to the fd index.
  * Returns NULL when the socket isn't found.
@@ -426,7 +424,11 @@ channel_fd2channel(sock_T fd, ch_part_T *partp)
     }
     return NULL;
 }
+#endif
+
+#if defined(FEAT_GUI)
 
+# if defined(FEAT_GUI_X11) || defined(FEAT_GUI_GTK)
     static void
 channel_read_fd(int fd)
 {
@@ -613,6 +615,111 @@ channel_gui_unregister(channel_T *channel)
 
 #endif  // FEAT_GUI
 
+#ifdef USE_EPOLL
+// The epoll instance that watches the readable channel fds, so that they
+// don't need to be passed to select() one by one.  -1 when not created yet or
+// creating it failed.
+static int	channel_epoll_fd = -1;
+static int	channel_epoll_count = 0;    // number of fds in channel_epoll_fd
+
+// Number of channels that select() has to check by themselves: a part is
+// not in the epoll set or there is text waiting to be written to PART_IN.
+// When zero the list of channels doesn't need to be walked.
+static int	channel_select_count = 0;
+
+/*
+ * Update whether "channel" is counted in channel_select_count.  Called when
+ * its fds, its write queue or its input buffer changed.
+ */
+    static void
+channel_update_select(channel_T *channel)
+{
+    chanpart_T	*in_part = &channel->ch_part[PART_IN];
+    ch_part_T	part;
+    int		walk;
+
+    walk = in_part->ch_fd != INVALID_FD
+			    && (in_part->ch_writeque.wq_next != NULL
+					  || in_part->ch_bufref.br_buf != NULL);
+    for (part = PART_SOCK; part < PART_IN && !walk; ++part)
+	if (channel->ch_part[part].ch_fd != INVALID_FD
+				&& !channel->ch_part[part].ch_epoll_registered)
+	    walk = TRUE;
+    if (walk != channel->ch_select_walk)
+    {
+	channel->ch_select_walk = walk;
+	channel_select_count += walk ? 1 : -1;
+    }
+}
+
+/*
+ * Add the fd of "part" of "channel" to the epoll set.  When this fails the fd
+ * is added to the select() fd sets like before.
+ */
+    static void
+channel_epoll_register_one(channel_T *channel, ch_part_T part)
+{
+    chanpart_T		*ch_part = &channel->ch_part[part];
+    struct epoll_event	ev;
+
+    // For a keep-open channel select() returns immediately, it is polled
+    // instead, see channel_select_setup().
+    if (ch_part->ch_fd == INVALID_FD || ch_part->ch_epoll_registered
+						     || channel->ch_keep_open)
+	goto theend;
+
+    if (channel_epoll_fd < 0)
+    {
+	static int did_fail = FALSE;
+
+	if (did_fail)
+	    goto theend;
+	channel_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (channel_epoll_fd < 0)
+	{
+	    ch_error(NULL, "Creating epoll instance failed, using select()");
+	    did_fail = TRUE;
+	    goto theend;
+	}
+    }
+
+    CLEAR_FIELD(ev);
+    ev.events = EPOLLIN;
+    ev.data.fd = ch_part->ch_fd;
+    if (epoll_ctl(channel_epoll_fd, EPOLL_CTL_ADD, ch_part->ch_fd, &ev) == 0)
+	++channel_epoll_count;
+    else if (errno != EEXIST)  // stdout and stderr may use the same fd
+	goto theend;
+    ch_part->ch_epoll_registered = TRUE;
+
+theend:
+    // when not added select() checks the fd
+    channel_update_select(channel);
+}
+
+/*
+ * Remove the fd of "part" of "channel" from the epoll set.  Called before the
+ * fd is closed.  The fd stays in the set while another part reads from it.
+ */
+    static void
+channel_epoll_unregister_one(channel_T *channel, ch_part_T part)
+{
+    chanpart_T	*ch_part = &channel->ch_part[part];
+    ch_part_T	other;
+
+    if (!ch_part->ch_epoll_registered)
+	return;
+    ch_part->ch_epoll_registered = FALSE;
+
+    for (other = PART_SOCK; other < PART_IN; ++other)
+	if (channel->ch_part[other].ch_epoll_registered
+		&& channel->ch_part[other].ch_fd == ch_part->ch_fd)
+	    return;
+    if (epoll_ctl(channel_epoll_fd, EPOLL_CTL_DEL, ch_part->ch_fd, NULL) == 0)
+	--channel_epoll_count;
+}
+#endif
+
 /*
  * For Unix we need to call connect() again after connect() failed.
  * On Win32 one time is sufficient.
@@ -891,6 +998,9 @@ channel_open_unix(
 #ifdef FEAT_GUI
     channel_gui_register_one(channel, PART_SOCK);
 #endif
+#ifdef USE_EPOLL
+    channel_epoll_register_one(channel, PART_SOCK);
+#endif
 
     return channel;
 }
@@ -1057,6 +1167,9 @@ channel_open(
 #ifdef FEAT_GUI
     channel_gui_register_one(channel, PART_SOCK);
 #endif
+#ifdef USE_EPOLL
+    channel_epoll_register_one(channel, PART_SOCK);
+#endif
 
     return channel;
 }
@@ -1377,6 +1490,9 @@ ch_close_part(channel_T *channel, ch_part_T part)
     if (*fd == INVALID_FD)
 	return;
 
+#ifdef USE_EPOLL
+    channel_epoll_unregister_one(channel, part);
+#endif
     if (part == PART_SOCK)
 	sock_close(*fd);
     else
@@ -1395,6 +1511,9 @@ ch_close_part(channel_T *channel, ch_part_T part)
 	}
     }
     *fd = INVALID_FD;
+#ifdef USE_EPOLL
+    channel_update_select(channel);
+#endif
 
     // channel is closed, may want to end the job if it was the last
     channel->ch_to_be_closed &= ~(1U << part);
@@ -1412,6 +1531,9 @@ channel_set_pipes(channel_T *channel, sock_T in, sock_T out, sock_T err)
 	// the job ended.
 	if (mch_isatty(in))
 	    channel->ch_to_be_closed |= (1U << PART_IN);
+# endif
+# ifdef USE_EPOLL
+	channel_update_select(channel);
 # endif
     }
     if (out != INVALID_FD)
@@ -1424,6 +1546,9 @@ channel_set_pipes(channel_T *channel, sock_T in, sock_T out, sock_T err)
 	channel->ch_to_be_closed |= (1U << PART_OUT);
 # if defined(FEAT_GUI)
 	channel_gui_register_one(channel, PART_OUT);
+# endif
+# ifdef USE_EPOLL
+	channel_epoll_register_one(channel, PART_OUT);
 # endif
     }
     if (err != INVALID_FD)
@@ -1442,6 +1567,9 @@ channel_set_pipes(channel_T *channel, sock_T in, sock_T out, sock_T err)
 	    channel->ch_to_be_closed |= (1U << PART_ERR);
 # if defined(FEAT_GUI)
 	    channel_gui_register_one(channel, PART_ERR);
+# endif
+# ifdef USE_EPOLL
+	    channel_epoll_register_one(channel, PART_ERR);
 # endif
 	}
     }
@@ -1464,6 +1592,9 @@ channel_set_job(channel_T *channel, job_T *job, jobopt_T *options)
     chanpart_T *in_part = &channel->ch_part[PART_IN];
 
     set_bufref(&in_part->ch_bufref, job->jv_in_buf);
+#ifdef USE_EPOLL
+    channel_update_select(channel);
+#endif
     ch_log(channel, "reading from buffer '%s'",
 	    (char *)in_part->ch_bufref.br_buf->b_ffname);
     if (options->jo_set & JO_IN_TOP)
@@ -1630,6 +1761,9 @@ channel_write_in(channel_T *channel)
 	// buffer was wiped out or unloaded
 	ch_log(channel, "input buffer has been wiped out");
 	in_part->ch_bufref.br_buf = NULL;
+#ifdef USE_EPOLL
+	channel_update_select(channel);
+#endif
 	return;
     }
 
@@ -1694,6 +1828,9 @@ channel_buffer_free(buf_T *buf)
 		ch_log(channel, "%s buffer has been wiped out",
 							  ch_part_names[part]);
 		ch_part->ch_bufref.br_buf = NULL;
+#ifdef USE_EPOLL
+		channel_update_select(channel);
+#endif
 	    }
 	}
 }
@@ -2746,10 +2883,74 @@ invoke_one_time_callback(
     vim_free(item);
 }
 
+/*
+ * Get a message ending in NL for NL mode "channel"/"part", without the NL.
+ * When there is no NL and the channel was closed get all the text.
+ * Returns NULL when there is no complete message or out of memory.
+ */
+    static char_u *
+channel_get_nl_msg(channel_T *channel, ch_part_T part)
+{
+    chanpart_T	*ch_part = &channel->ch_part[part];
+    char_u	*nl = NULL;
+    char_u	*buf;
+    char_u	*msg;
+    char_u	*p;
+    readq_T	*node;
+
+    // See if we have a message ending in NL in the first buffer.  If
+    // not try to concatenate the first and the second buffer.
+    while (TRUE)
+    {
+	node = channel_peek(channel, part);
+	nl = channel_first_nl(node);
+	if (nl != NULL)
+	    break;
+	if (channel_collapse(channel, part, TRUE) == FAIL)
+	{
+	    if (ch_part->ch_fd == INVALID_FD && node->rq_buflen > 0)
+		break;
+	    return NULL; // incomplete message
+	}
+    }
+    buf = node->rq_buffer;
+
+    // Convert NUL to NL, the internal representation.
+    for (p = buf; (nl == NULL || p < nl) && p < buf + node->rq_buflen; ++p)
+	if (*p == NUL)
+	    *p = NL;
+
+    if (nl == NULL)
+    {
+	// get the whole buffer, drop the NL
+	msg = channel_get(channel, part, NULL);
+    }
+    else if (nl + 1 == buf + node->rq_buflen)
+    {
+	// get the whole buffer
+	msg = channel_get(channel, part, NULL);
+	*nl = NUL;
+    }
+    else
+    {
+	// Copy the message into allocated memory (excluding the NL)
+	// and remove it from the buffer (including the NL).
+	msg = vim_strnsave(buf, nl - buf);
+	channel_consume(channel, part, (int)(nl - buf) + 1);
+    }
+    return msg;
+}
+
+/*
+ * Append "msg" to "buffer".  When "more" is TRUE also append the following
+ * complete NL mode messages that have already been received, with one undo
+ * entry and one screen update for all of them.
+ */
     static void
 append_to_buffer(
     buf_T	*buffer,
     char_u	*msg,
+    int		more,
     channel_T	*channel,
     ch_part_T	part)
 {
@@ -2759,6 +2960,13 @@ append_to_buffer(
     chanpart_T  *ch_part = &channel->ch_part[part];
     int		save_p_ma = buffer->b_p_ma;
     int		empty = (buffer->b_ml.ml_flags & ML_EMPTY) ? 1 : 0;
+    garray_T	ga_lines;
+    string_T	first_line;
+    string_T	*lines;
+    long	count;
+    long	added;
+    readq_T	*node;
+    char_u	*next;
 
     if (!buffer->b_p_ma && !ch_part->ch_nomodifiable)
     {
@@ -2778,10 +2986,7 @@ append_to_buffer(
 	buffer->b_write_to_channel = FALSE;
     }
 
-    // Append to the buffer
-    ch_log(channel, "appending line %d to buffer %s",
-				       (int)lnum + 1 - empty, buffer->b_fname);
-
+    ga_init2(&ga_lines, sizeof(string_T), 100);
     buffer->b_p_ma = TRUE;
 
     // Set curbuf to "buffer", temporarily.
@@ -2793,6 +2998,32 @@ append_to_buffer(
 	return;
     }
 
+    first_line.string = msg;
+    first_line.length = STRLEN(msg);
+    lines = &first_line;
+    count = 1;
+    while (more && (node = channel_peek(channel, part)) != NULL
+	    && channel_first_nl(node) != NULL
+	    && ga_grow(&ga_lines, ga_lines.ga_len == 0 ? 2 : 1) == OK
+	    && (next = channel_get_nl_msg(channel, part)) != NULL)
+    {
+	lines = (string_T *)ga_lines.ga_data;
+	if (ga_lines.ga_len == 0)
+	    lines[ga_lines.ga_len++] = first_line;
+	lines[ga_lines.ga_len].string = next;
+	lines[ga_lines.ga_len].length = STRLEN(next);
+	count = ++ga_lines.ga_len;
+    }
+
+    // Append to the buffer
+    if (count == 1)
+	ch_log(channel, "appending line %d to buffer %s",
+				       (int)lnum + 1 - empty, buffer->b_fname);
+    else
+	ch_log(channel, "appending lines %d - %d to buffer %s",
+		       (int)lnum + 1 - empty, (int)(lnum + count - empty),
+							     buffer->b_fname);
+
     u_sync(TRUE);
     // ignore undo failure, undo is not very useful here
     vim_ignored = u_save(lnum - empty, lnum + 1);
@@ -2801,11 +3032,19 @@ append_to_buffer(
     {
 	// The buffer is empty, replace the first (dummy) line.
 	ml_replace(lnum, msg, TRUE);
+	added = ml_append_multi(lnum, lines + 1, count - 1, 0) + 1;
 	lnum = 0;
     }
     else
-	ml_append(lnum, msg, 0, FALSE);
-    appended_lines_mark(lnum, 1L);
+	added = ml_append_multi(lnum, lines, count, 0);
+    appended_lines_mark(lnum, added);
+    if (empty && added > 1)
+    {
+	// The cursor follows lines after the first one like when they were
+	// appended one by one.
+	lnum = 1;
+	--added;
+    }
 
     // reset notion of buffer
     aucmd_restbuf(&aco);
@@ -2828,14 +3067,14 @@ append_to_buffer(
 			    : (wp->w_cursor.lnum == lnum
 				&& wp->w_cursor.col == 0);
 
-		// If the cursor is at or above the new line, move it one line
-		// down.  If the topline is outdated update it now.
+		// If the cursor is at or above the new lines, move it down.
+		// If the topline is outdated update it now.
 		if (move_cursor || wp->w_topline > buffer->b_ml.ml_line_count)
 		{
 		    win_T *save_curwin = curwin;
 
 		    if (move_cursor)
-			++wp->w_cursor.lnum;
+			wp->w_cursor.lnum += added;
 		    curwin = wp;
 		    curbuf = curwin->w_buffer;
 		    scroll_cursor_bot(0, FALSE);
@@ -2863,6 +3102,11 @@ append_to_buffer(
 		in_part->ch_buf_bot = buffer->b_ml.ml_line_count;
 	}
     }
+
+    // The first message is freed by the caller.
+    for (count = 1; count < ga_lines.ga_len; ++count)
+	vim_free(lines[count].string);
+    ga_clear(&ga_lines);
 }
 
     static void
@@ -2907,7 +3151,6 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
     cbq_T	*cbitem;
     callback_T	*callback = NULL;
     buf_T	*buffer = NULL;
-    char_u	*p;
     int		called_otc;		// one time callbackup
 
     if (channel->ch_nb_close_cb != NULL)
@@ -3015,53 +3258,8 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 	}
 
 	if (ch_mode == CH_MODE_NL)
-	{
-	    char_u  *nl = NULL;
-	    char_u  *buf;
-	    readq_T *node;
-
-	    // See if we have a message ending in NL in the first buffer.  If
-	    // not try to concatenate the first and the second buffer.
-	    while (TRUE)
-	    {
-		node = channel_peek(channel, part);
-		nl = channel_first_nl(node);
-		if (nl != NULL)
-		    break;
-		if (channel_collapse(channel, part, TRUE) == FAIL)
-		{
-		    if (ch_part->ch_fd == INVALID_FD && node->rq_buflen > 0)
-			break;
-		    return FALSE; // incomplete message
-		}
-	    }
-	    buf = node->rq_buffer;
-
-	    // Convert NUL to NL, the internal representation.
-	    for (p = buf; (nl == NULL || p < nl)
-					    && p < buf + node->rq_buflen; ++p)
-		if (*p == NUL)
-		    *p = NL;
-
-	    if (nl == NULL)
-	    {
-		// get the whole buffer, drop the NL
-		msg = channel_get(channel, part, NULL);
-	    }
-	    else if (nl + 1 == buf + node->rq_buflen)
-	    {
-		// get the whole buffer
-		msg = channel_get(channel, part, NULL);
-		*nl = NUL;
-	    }
-	    else
-	    {
-		// Copy the message into allocated memory (excluding the NL)
-		// and remove it from the buffer (including the NL).
-		msg = vim_strnsave(buf, nl - buf);
-		channel_consume(channel, part, (int)(nl - buf) + 1);
-	    }
-	}
+	    // Returns NULL for an incomplete message.
+	    msg = channel_get_nl_msg(channel, part);
 	else
 	{
 	    // For a raw channel we don't know where the message ends, just
@@ -3141,7 +3339,11 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 		    write_to_term(buffer, msg, channel);
 		else
 #endif
-		    append_to_buffer(buffer, msg, channel, part);
+		    // Without a callback the following lines can be appended
+		    // at once.
+		    append_to_buffer(buffer, msg,
+				  ch_mode == CH_MODE_NL && callback == NULL,
+							       channel, part);
 	    }
 	}
 
@@ -3552,10 +3754,19 @@ channel_fill_wfds(int maxfd_arg, fd_set *wfds)
     int		maxfd = maxfd_arg;
     channel_T	*ch;
 
+# ifdef USE_EPOLL
+    // a channel with text to write is counted in channel_select_count
+    if (channel_select_count == 0)
+	return maxfd;
+# endif
     FOR_ALL_CHANNELS(ch)
     {
 	chanpart_T  *in_part = &ch->ch_part[PART_IN];
 
+# ifdef USE_EPOLL
+	if (!ch->ch_select_walk)
+	    continue;
+# endif
 	if (in_part->ch_fd != INVALID_FD
 		&& is_channel_write_remaining(in_part))
 	{
@@ -4485,6 +4696,11 @@ channel_send(
 	    return FAIL;
 	}
 
+#ifdef USE_EPOLL
+	// the write queue may have changed
+	if (part == PART_IN)
+	    channel_update_select(channel);
+#endif
 	channel->ch_error = FALSE;
 	return OK;
     }
@@ -4837,34 +5053,54 @@ channel_select_setup(
     fd_set	*wfds = wfds_in;
     ch_part_T	part;
 
+# ifdef USE_EPOLL
+    // The fds in the epoll set are all found with channel_epoll_fd, only the
+    // channels counted in channel_select_count need to be looked at.
+    if (channel_epoll_count > 0)
+    {
+	FD_SET(channel_epoll_fd, rfds);
+	if (maxfd < channel_epoll_fd)
+	    maxfd = channel_epoll_fd;
+    }
+    if (channel_select_count == 0)
+	return maxfd;
+# endif
+
     FOR_ALL_CHANNELS(channel)
     {
+# ifdef USE_EPOLL
+	if (!channel->ch_select_walk)
+	    continue;
+# endif
 	for (part = PART_SOCK; part < PART_IN; ++part)
 	{
 	    sock_T fd = channel->ch_part[part].ch_fd;
 
-	    if (fd != INVALID_FD)
+	    if (fd == INVALID_FD
+# ifdef USE_EPOLL
+		    || channel->ch_part[part].ch_epoll_registered
+# endif
+		    )
+		continue;
+	    if (channel->ch_keep_open)
 	    {
-		if (channel->ch_keep_open)
-		{
-		    // For unknown reason select() returns immediately for a
-		    // keep-open channel.  Instead of adding it to the rfds add
-		    // a short timeout and check, like polling.
-		    if (*tvp == NULL || tv->tv_sec > 0
+		// For unknown reason select() returns immediately for a
+		// keep-open channel.  Instead of adding it to the rfds add a
+		// short timeout and check, like polling.
+		if (*tvp == NULL || tv->tv_sec > 0
 					|| tv->tv_usec > KEEP_OPEN_TIME * 1000)
-		    {
-			*tvp = tv;
-			tv->tv_sec = 0;
-			tv->tv_usec = KEEP_OPEN_TIME * 1000;
-		    }
-		}
-		else
 		{
-		    FD_SET((int)fd, rfds);
-		    if (maxfd < (int)fd)
-			maxfd = (int)fd;
+		    *tvp = tv;
+		    tv->tv_sec = 0;
+		    tv->tv_usec = KEEP_OPEN_TIME * 1000;
 		}
 	    }
+	    else
+	    {
+		FD_SET((int)fd, rfds);
+		if (maxfd < (int)fd)
+		    maxfd = (int)fd;
+	    }
 	}
     }
 
@@ -4886,8 +5122,38 @@ channel_select_check(int ret_in, void *rfds_in, void *wfds_in)
     ch_part_T	part;
     chanpart_T	*in_part;
 
+# ifdef USE_EPOLL
+    if (ret > 0 && channel_epoll_count > 0
+				       && FD_ISSET(channel_epoll_fd, rfds))
+    {
+	struct epoll_event  events[MAX_OPEN_CHANNELS];
+	int		    n;
+	int		    i;
+
+	// Anything not handled now is reported again next time.
+	n = epoll_wait(channel_epoll_fd, events, MAX_OPEN_CHANNELS, 0);
+	for (i = 0; i < n; ++i)
+	{
+	    // The fd may have been closed while reading another one.
+	    channel = channel_fd2channel(events[i].data.fd, &part);
+	    if (channel != NULL)
+		channel_read(channel, part, "channel_select_check");
+	}
+	FD_CLR(channel_epoll_fd, rfds);
+	--ret;
+    }
+
+    // other channels were not added to the fd sets
+    if (channel_select_count == 0)
+	return ret;
+# endif
+
     FOR_ALL_CHANNELS(channel)
     {
+# ifdef USE_EPOLL
+	if (!channel->ch_select_walk)
+	    continue;
+# endif
 	for (part = PART_SOCK; part < PART_IN; ++part)
 	{
 	    sock_T fd = channel->ch_part[part].ch_fd;
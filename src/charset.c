@@ -18,6 +18,12 @@ static int win_nolbr_chartabsize(chartabsize_T *cts, int *headp);
 static unsigned nr2hex(unsigned c);
 
 static int    chartab_initialized = FALSE;
+static int    chartab_tick = 0;	// incremented when g_chartab[] or
+					// character widths change
+
+// Distance in bytes between the virtual columns remembered in
+// "w_vcol_cache".  Shorter lines don't use the cache.
+#define VCOL_CACHE_STEP 1024
 
 // b_chartab[] is an array of 32 bytes, each bit representing one of the
 // characters 0-255.
@@ -79,8 +85,14 @@ buf_init_chartab(
     char_u	*p;
     int		i;
 
+#ifdef FEAT_SYN_HL
+    // Syntax keywords may match differently.
+    ++syn_lines_tick;
+#endif
     if (global)
     {
+	++chartab_tick;
+
 	/*
 	 * Set the default size for printable characters:
 	 * From <Space> to '~' is 1 (printable), others are 2 (not printable).
@@ -153,6 +165,27 @@ buf_init_chartab(
     return OK;
 }
 
+/*
+ * Return a number that changes every time g_chartab[] is filled or the width
+ * of characters may have changed.  For caches that depend on 'isident',
+ * 'isfname', 'isprint' and character widths.
+ */
+    int
+get_chartab_tick(void)
+{
+    return chartab_tick;
+}
+
+/*
+ * Called when the number of cells a character takes may have changed, e.g.
+ * for 'ambiwidth' and setcellwidths().
+ */
+    void
+chartab_cells_changed(void)
+{
+    ++chartab_tick;
+}
+
 /**
  * Checks the format for the option settings 'iskeyword', 'isident', 'isfname'
  * or 'isprint'.
@@ -730,8 +763,16 @@ vim_strnsize(char_u *s, int len)
 
     while (*s != NUL && --len >= 0)
     {
-	int	    l = (*mb_ptr2len)(s);
+	int	    l;
 
+	// Printable ASCII is most common, it always takes one cell.
+	if (*s >= ' ' && *s <= '~')
+	{
+	    ++size;
+	    ++s;
+	    continue;
+	}
+	l = (*mb_ptr2len)(s);
 	size += ptr2cells(s);
 	s += l;
 	len -= l - 1;
@@ -800,13 +841,27 @@ linetabsize_col(int startcol, char_u *s)
 {
     chartabsize_T cts;
     vimlong_T vcol;
+    int ascii_one_cell = TRUE;
 
     init_chartabsize_arg(&cts, curwin, 0, startcol, s, s);
     vcol = cts.cts_vcol;
+#ifdef FEAT_LINEBREAK
+    // With 'linebreak', 'showbreak' and 'breakindent' a character may take
+    // more cells.
+    ascii_one_cell = !curwin->w_p_lbr && *get_showbreak_value(curwin) == NUL
+							   && !curwin->w_p_bri;
+#endif
 
     while (*cts.cts_ptr != NUL)
     {
-	vcol += lbr_chartabsize_adv(&cts);
+	if (ascii_one_cell && *cts.cts_ptr >= ' ' && *cts.cts_ptr <= '~')
+	{
+	    // printable ASCII takes one cell
+	    ++vcol;
+	    ++cts.cts_ptr;
+	}
+	else
+	    vcol += lbr_chartabsize_adv(&cts);
 	if (vcol > MAXCOL)
 	{
 	    cts.cts_vcol = MAXCOL;
@@ -827,9 +882,15 @@ linetabsize_col(int startcol, char_u *s)
 win_linetabsize(win_T *wp, linenr_T lnum, char_u *line, colnr_T len)
 {
     chartabsize_T cts;
+    int		  ascii_len;
 
     init_chartabsize_arg(&cts, wp, lnum, 0, line, line);
-    win_linetabsize_cts(&cts, len);
+    ascii_len = win_ascii_line_len(&cts, lnum);
+    if (ascii_len >= 0)
+	// every character takes one cell
+	cts.cts_vcol = len < ascii_len ? len : ascii_len;
+    else
+	win_linetabsize_cts(&cts, len);
     clear_chartabsize_arg(&cts);
     return (int)cts.cts_vcol;
 }
@@ -895,6 +956,29 @@ linetabsize_no_outer(win_T *wp, linenr_T lnum)
 #endif
 }
 
+/*
+ * When every character of line "lnum" in window "cts->cts_win" takes one cell
+ * return the length of the line, otherwise return -1.
+ * That is when the line only contains printable ASCII and 'linebreak',
+ * 'showbreak', 'breakindent' and text properties with text don't add cells.
+ * "cts" must have been initialized for the line as returned by ml_get_buf().
+ */
+    int
+win_ascii_line_len(chartabsize_T *cts, linenr_T lnum)
+{
+    win_T	*wp = cts->cts_win;
+
+#ifdef FEAT_LINEBREAK
+    if (wp->w_p_lbr || *get_showbreak_value(wp) != NUL || wp->w_p_bri)
+	return -1;
+#endif
+#ifdef FEAT_PROP_POPUP
+    if (cts->cts_has_prop_with_text)
+	return -1;
+#endif
+    return ml_line_ascii_len(wp->w_buffer, lnum, cts->cts_line);
+}
+
     void
 win_linetabsize_cts(chartabsize_T *cts, colnr_T len)
 {
@@ -1587,6 +1671,47 @@ in_win_border(win_T *wp, colnr_T vcol)
     return ((vcol - width1) % width2 == width2 - 1);
 }
 
+/*
+ * Return the virtual column cache of window "wp" for line "lnum".  It is
+ * cleared when it was for another line or the text or an option that changes
+ * the width of characters has changed.
+ */
+    static vcolcache_T *
+get_vcol_cache(win_T *wp, linenr_T lnum)
+{
+    vcolcache_T	*vc = &wp->w_vcol_cache;
+    buf_T	*buf = wp->w_buffer;
+    int		width1 = 0;
+    int		width2 = 0;
+
+    // Where a double-wide character wraps depends on the window width.
+    if (wp->w_p_wrap && has_mbyte)
+    {
+	width1 = wp->w_width - win_col_off(wp);
+	width2 = width1 + win_col_off2(wp);
+    }
+    if (vc->vc_points.ga_itemsize == 0)
+	ga_init2(&vc->vc_points, sizeof(vcolpoint_T), 20);
+    if (vc->vc_fnum != buf->b_fnum
+	    || vc->vc_lnum != lnum
+	    || vc->vc_changedtick != CHANGEDTICK(buf)
+	    || vc->vc_ts != buf->b_p_ts
+	    || vc->vc_width1 != width1
+	    || vc->vc_width2 != width2
+	    || vc->vc_chartab_tick != chartab_tick)
+    {
+	vc->vc_fnum = buf->b_fnum;
+	vc->vc_lnum = lnum;
+	vc->vc_changedtick = CHANGEDTICK(buf);
+	vc->vc_ts = buf->b_p_ts;
+	vc->vc_width1 = width1;
+	vc->vc_width2 = width2;
+	vc->vc_chartab_tick = chartab_tick;
+	vc->vc_points.ga_len = 0;
+    }
+    return vc;
+}
+
 /*
  * Get virtual column number of pos.
  *  start: on the first position of this character (TAB, ctrl)
@@ -1639,6 +1764,44 @@ getvcol(
 #endif
        )
     {
+	vcolcache_T *vc = NULL;
+	colnr_T	    next_point = MAXCOL;
+	int	    ascii_len = win_ascii_line_len(&cts, pos->lnum);
+
+	if (ascii_len >= 0)
+	{
+	    // Every character takes one cell, the virtual column is the
+	    // byte index.
+	    vcol = pos->col < ascii_len ? pos->col : ascii_len;
+	    ptr = line + vcol;
+	}
+	// In a long line start at the closest character before "pos" of
+	// which the virtual column is known.  Remember the virtual column
+	// every VCOL_CACHE_STEP bytes that are passed.
+	else if (pos->col >= VCOL_CACHE_STEP
+#ifdef FEAT_VARTABS
+		&& vts == NULL
+#endif
+		)
+	{
+	    vcolpoint_T *points;
+	    int		idx;
+
+	    vc = get_vcol_cache(wp, pos->lnum);
+	    points = (vcolpoint_T *)vc->vc_points.ga_data;
+	    idx = pos->col / VCOL_CACHE_STEP;
+	    if (idx > vc->vc_points.ga_len)
+		idx = vc->vc_points.ga_len;
+	    while (idx > 0 && points[idx - 1].vp_col > pos->col)
+		--idx;
+	    if (idx > 0)
+	    {
+		ptr = line + points[idx - 1].vp_col;
+		vcol = points[idx - 1].vp_vcol;
+	    }
+	    next_point = (vc->vc_points.ga_len + 1) * VCOL_CACHE_STEP;
+	}
+
 	for (;;)
 	{
 	    head = 0;
@@ -1687,6 +1850,20 @@ getvcol(
 
 	    vcol += incr;
 	    ptr = next_ptr;
+	    if (ptr - line >= next_point)
+	    {
+		if (ga_grow(&vc->vc_points, 1) == OK)
+		{
+		    vcolpoint_T *vp = (vcolpoint_T *)vc->vc_points.ga_data
+						       + vc->vc_points.ga_len++;
+
+		    vp->vp_col = (colnr_T)(ptr - line);
+		    vp->vp_vcol = vcol;
+		    next_point += VCOL_CACHE_STEP;
+		}
+		else
+		    next_point = MAXCOL;
+	    }
 	}
     }
     else
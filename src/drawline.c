@@ -1211,6 +1211,7 @@ win_line(
     int		prev_syntax_col = -1;	// column of prev_syntax_attr
     int		prev_syntax_attr = 0;	// syntax_attr at prev_syntax_col
     int		has_syntax = FALSE;	// this buffer has syntax highl.
+    int		syn_cached = FALSE;	// using syn_line_cache_attr()
     int		save_did_emsg;
 #endif
 #ifdef FEAT_PROP_POPUP
@@ -1346,22 +1347,33 @@ win_line(
 # endif
 	   )
 	{
-	    // Prepare for syntax highlighting in this line.  When there is an
-	    // error, stop syntax highlighting.
-	    save_did_emsg = did_emsg;
-	    did_emsg = FALSE;
-	    syntax_start(wp, lnum);
-	    if (did_emsg)
-		wp->w_s->b_syn_error = TRUE;
+	    if (syn_line_cache_find(wp, lnum, spv->spv_has_spell))
+	    {
+		// The attributes were stored when the line was drawn before.
+		syn_cached = TRUE;
+		has_syntax = TRUE;
+		extra_check = TRUE;
+	    }
 	    else
 	    {
-		did_emsg = save_did_emsg;
+		// Prepare for syntax highlighting in this line.  When there is
+		// an error, stop syntax highlighting.
+		save_did_emsg = did_emsg;
+		did_emsg = FALSE;
+		syntax_start(wp, lnum);
+		if (did_emsg)
+		    wp->w_s->b_syn_error = TRUE;
+		else
+		{
+		    did_emsg = save_did_emsg;
 #ifdef SYN_TIME_LIMIT
-		if (!wp->w_s->b_syn_slow)
+		    if (!wp->w_s->b_syn_slow)
 #endif
-		{
-		    has_syntax = TRUE;
-		    extra_check = TRUE;
+		    {
+			has_syntax = TRUE;
+			extra_check = TRUE;
+			syn_line_cache_start(wp, lnum, spv->spv_has_spell);
+		    }
 		}
 	    }
 	}
@@ -1782,6 +1794,26 @@ win_line(
 
 	init_chartabsize_arg(&cts, wp, lnum, wlv.vcol, line, ptr);
 	cts.cts_max_head_vcol = v;
+	if (!wp->w_p_list)
+	{
+	    int ascii_len = win_ascii_line_len(&cts, lnum);
+
+	    if (ascii_len >= 0)
+	    {
+		// Every character takes one cell, skip them without looking
+		// at each one.  The loop below handles the end of the line.
+		int skip = MIN(v - cts.cts_vcol,
+					 ascii_len - (int)(cts.cts_ptr - line));
+
+		if (skip > 0)
+		{
+		    cts.cts_ptr += skip;
+		    cts.cts_vcol += skip;
+		    prev_ptr = cts.cts_ptr - 1;
+		    charsize = 1;
+		}
+	    }
+	}
 	while (cts.cts_vcol < v)
 	{
 	    head = 0;
@@ -1891,7 +1923,7 @@ win_line(
 
 # ifdef FEAT_SYN_HL
 	    // Need to restart syntax highlighting for this line.
-	    if (has_syntax)
+	    if (has_syntax && !syn_cached)
 		syntax_start(wp, lnum);
 # endif
 	}
@@ -2548,7 +2580,23 @@ win_line(
 # ifdef FEAT_SPELL
 			can_spell = TRUE;
 # endif
-			syntax_attr = get_syntax_attr((colnr_T)v,
+			syntax_attr = -1;
+			if (syn_cached)
+			{
+			    syntax_attr = syn_line_cache_attr((colnr_T)v,
+# ifdef FEAT_SPELL
+					    spv->spv_has_spell ? &can_spell :
+# endif
+					    NULL);
+			    if (syntax_attr < 0)
+			    {
+				// Not stored this far, need to parse the line.
+				syn_cached = FALSE;
+				syntax_start(wp, lnum);
+			    }
+			}
+			if (syntax_attr < 0)
+			    syntax_attr = get_syntax_attr((colnr_T)v,
 # ifdef FEAT_SPELL
 					    spv->spv_has_spell ? &can_spell :
 # endif
@@ -2582,6 +2630,11 @@ win_line(
 		    else
 			syntax_flags = get_syntax_info(&syntax_seqnr);
 # endif
+		    syn_line_cache_add((colnr_T)v, ptr, syntax_attr,
+# ifdef FEAT_SPELL
+					    spv->spv_has_spell ? &can_spell :
+# endif
+					    NULL);
 		}
 	    }
 # ifdef FEAT_PROP_POPUP
@@ -4473,6 +4526,9 @@ win_line(
     vim_free(p_extra_free2);
 #endif
 
+#ifdef FEAT_SYN_HL
+    syn_line_cache_end(has_syntax);
+#endif
     vim_free(wlv.p_extra_free);
     vim_free(wlv.saved_p_extra_free);
     return wlv.row;
@@ -97,6 +97,8 @@ update_screen(int type_arg)
 #endif
     int		no_update = FALSE;
     int		save_pum_will_redraw = pum_will_redraw;
+    long	bytes_before;
+    long	writes_before;
 
     // Don't do anything if the screen structures are (not yet) valid.
     if (!screen_valid(TRUE))
@@ -155,6 +157,9 @@ update_screen(int type_arg)
 	return FAIL;
     }
     updating_screen = TRUE;
+    bytes_before = out_bytes_written();
+    writes_before = out_write_count();
+    out_redraw_start();
 
 #ifdef FEAT_PROP_POPUP
     // Update popup_mask if needed.  This may set w_redraw_top and w_redraw_bot
@@ -415,6 +420,10 @@ update_screen(int type_arg)
     }
 #endif
 
+    out_redraw_end();
+    redraw_bytes = out_bytes_written() - bytes_before;
+    redraw_writes = out_write_count() - writes_before;
+
 #ifdef FEAT_EVAL
     invoke_redraw_listener_start_or_end(false);
     redraw_listener_cleanup();
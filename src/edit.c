@@ -4254,7 +4254,8 @@ ins_bs(
 			    curbuf->b_ml.ml_line_ptr = newp;
 			    curbuf->b_ml.ml_line_len--;
 			    curbuf->b_ml.ml_line_textlen--;
-			    curbuf->b_ml.ml_flags |= ML_LINE_DIRTY;
+			    curbuf->b_ml.ml_flags = (curbuf->b_ml.ml_flags
+					| ML_LINE_DIRTY) & ~ML_ASCII_CHECKED;
 			}
 		    }
 		}
@@ -5240,8 +5241,8 @@ ins_tab(void)
 		    curbuf->b_ml.ml_line_ptr = newp;
 		    curbuf->b_ml.ml_line_len -= i;
 		    curbuf->b_ml.ml_line_textlen = 0;
-		    curbuf->b_ml.ml_flags =
-			   (curbuf->b_ml.ml_flags | ML_LINE_DIRTY) & ~ML_EMPTY;
+		    curbuf->b_ml.ml_flags = (curbuf->b_ml.ml_flags
+			       | ML_LINE_DIRTY) & ~(ML_EMPTY | ML_ASCII_CHECKED);
 		}
 		else
 #endif
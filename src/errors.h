@@ -3810,3 +3810,7 @@ EXTERN char e_cannot_add_redraw_listener_in_listener_callback[]
 EXTERN char e_no_redraw_listener_callbacks_defined[]
 	INIT(= N_("E1571: Must specify at least one callback for redraw_listener_add"));
 #endif
+#ifdef USE_MMAP
+EXTERN char e_file_was_changed_after_opening_lines_missing[]
+	INIT(= N_("E1572: File was changed after it was opened, lines are missing"));
+#endif
@@ -2736,6 +2736,8 @@ static const funcentry_T global_functions[] =
 			ret_string,	    f_reg_executing},
     {"reg_recording",	0, 0, 0,	    NULL,
 			ret_string,	    f_reg_recording},
+    {"regexpcacheinfo",	0, 0, 0,	    NULL,
+			ret_dict_number,    f_regexpcacheinfo},
     {"reltime",		0, 2, FEARG_1,	    arg2_list_number,
 			ret_list_any,	    f_reltime},
     {"reltimefloat",	1, 1, FEARG_1,	    arg1_list_number,
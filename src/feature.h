@@ -325,6 +325,30 @@
 # define FEAT_BYTEOFF
 #endif
 
+/*
+ * USE_MMAP		For huge files only locate the line breaks and load
+ *			the lines when they are used, see 'mmapsize'.
+ */
+#if defined(FEAT_NORMAL) && defined(UNIX)
+# define USE_MMAP
+#endif
+
+/*
+ * USE_SWAP_THREAD	Write the swap file in a separate thread, so that
+ *			syncing it does not make the user wait.
+ */
+#if defined(FEAT_NORMAL) && defined(UNIX) && defined(HAVE_PTHREAD)
+# define USE_SWAP_THREAD
+#endif
+
+/*
+ * USE_VIMGREP_THREADS	Use threads to find the files that can't match before
+ *			":vimgrep" loads them.
+ */
+#if defined(FEAT_QUICKFIX) && defined(UNIX) && defined(HAVE_PTHREAD)
+# define USE_VIMGREP_THREADS
+#endif
+
 /*
  * +viminfo		reading/writing the viminfo file. Takes about 8Kbyte
  *			of code.
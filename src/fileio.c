@@ -40,7 +40,11 @@ static char_u *readfile_charconvert(char_u *fname, char_u *fenc, int *fdp);
 static char_u *check_for_cryptkey(char_u *cryptkey, char_u *ptr, long *sizep, off_T *filesizep, int newfile, char_u *fname, int *did_ask);
 #endif
 static linenr_T readfile_linenr(linenr_T linecnt, char_u *p, char_u *endp);
+static int readfile_append(linenr_T *lnump, string_T *lines, int *countp, int newfile);
 static char_u *check_for_bom(char_u *p, long size, int *lenp, int flags);
+#ifdef USE_MMAP
+static int lazy_text_ok(char_u *text, long len, int fileformat, int try_unix);
+#endif
 
 #ifdef FEAT_EVAL
 static int readdirex_sort;
@@ -100,7 +104,8 @@ filemess(
  *
  * 1. We allocate blocks with lalloc, as big as possible.
  * 2. Each block is filled with characters from the file with a single read().
- * 3. The lines are inserted in the buffer with ml_append().
+ * 3. The lines are inserted in the buffer with ml_append_multi(), collected
+ *    in batches of READ_LINES_MAX lines.
  *
  * (caller must check that fname != NULL, unless READ_STDIN is used)
  *
@@ -167,6 +172,9 @@ readfile(
 #endif
     int		split = 0;		// number of split lines
 #define UNKNOWN	 0x0fffffff		// file size is unknown
+#define READ_LINES_MAX 256
+    string_T	read_lines[READ_LINES_MAX]; // lines not appended yet
+    int		read_lines_count = 0;
     linenr_T	linecnt;
     int		error = FALSE;		// errors encountered
     int		ff_error = EOL_UNKNOWN; // file format with errors
@@ -1147,6 +1155,82 @@ retry:
 #endif
     }
 
+#ifdef USE_MMAP
+    /*
+     * For a huge file that doesn't need any conversion only the line breaks
+     * are located, the lines that are used are read later.  See 'mmapsize'.
+     */
+    if (p_mms > 0 && newfile && wasempty && !skip_read && filesize == 0
+	    && from == 0 && lines_to_skip == 0 && lines_to_read == MAXLNUM
+	    && !filtering && !read_stdin && !read_buffer && !read_fifo
+	    && tmpname == NULL
+# ifdef FEAT_PERSISTENT_UNDO
+	    && !read_undo_file
+# endif
+	    && (!converted || fio_flags == FIO_UCSBOM))
+    {
+	char_u	    *mfenc = fenc;
+	char_u	    *mfenc_next = fenc_next;
+	int	    mfenc_alloced = FALSE;
+	long	    detect_len = converted ? 0x10000L / ICONV_MULT : 0x10000L;
+	char_u	    *head = NULL;
+	long	    head_len = 0;
+	stat_T	    mst;
+	off_T	    msize = 0;
+	int	    mno_eol = FALSE;
+	linenr_T    mlnum = 0;
+
+	// For "ucs-bom" without a BOM the next item in 'fileencodings' would
+	// be used.
+	if (converted && fenc_next != NULL
+				     && (eap == NULL || eap->force_enc == 0))
+	    mfenc = next_fenc(&mfenc_next, &mfenc_alloced);
+	if (!need_conversion(mfenc)
+		&& mch_fstat(fd, &mst) == 0
+		&& S_ISREG(mst.st_mode)
+		&& mst.st_size >= (off_T)p_mms * 1024
+		&& (head = alloc(detect_len)) != NULL)
+	    head_len = read_eintr(fd, head, (size_t)detect_len);
+	if (head_len > 0
+		&& lazy_text_ok(head, head_len, fileformat, try_unix) == OK)
+	    mlnum = ml_append_lazy(fd, enc_utf8 && !curbuf->b_p_bin,
+							   &msize, &mno_eol);
+	vim_free(head);
+	if (mlnum > 0)
+	{
+	    if (mfenc != fenc)
+	    {
+		if (fenc_alloced)
+		    vim_free(fenc);
+		fenc = mfenc;
+		fenc_alloced = mfenc_alloced;
+		fenc_next = mfenc_next;
+	    }
+	    if (fileformat == EOL_UNKNOWN)
+	    {
+		fileformat = EOL_UNIX;
+		if (set_options)
+		    set_fileformat(fileformat, OPT_LOCAL);
+	    }
+	    lnum = mlnum;
+	    filesize = msize;
+	    if (mno_eol)
+	    {
+		// last line has no EOL, remember for when writing
+		if (set_options)
+		    curbuf->b_p_eol = FALSE;
+		read_no_eol_lnum = lnum;
+	    }
+	    goto failed;	// not a failure, skip reading the file
+	}
+	if (mfenc_alloced)
+	    vim_free(mfenc);
+	// read the file as usual, from the start
+	if (head_len != 0 && vim_lseek(fd, (off_T)0, SEEK_SET) != 0)
+	    error = TRUE;
+    }
+#endif
+
     while (!error && !got_int)
     {
 	/*
@@ -2225,7 +2309,11 @@ rewind_retry:
 		    {
 			*ptr = NUL;	    // end of line
 			len = (colnr_T) (ptr - line_start + 1);
-			if (ml_append(lnum, line_start, len, newfile) == FAIL)
+			read_lines[read_lines_count].string = line_start;
+			read_lines[read_lines_count].length = len - 1;
+			if (++read_lines_count == READ_LINES_MAX
+				&& readfile_append(&lnum, read_lines,
+					  &read_lines_count, newfile) == FAIL)
 			{
 			    error = TRUE;
 			    break;
@@ -2234,7 +2322,6 @@ rewind_retry:
 			if (read_undo_file)
 			    sha256_update(&sha_ctx, line_start, len);
 #endif
-			++lnum;
 			if (--read_count == 0)
 			{
 			    error = TRUE;	// break loop
@@ -2254,7 +2341,21 @@ rewind_retry:
 	    while (++ptr, --size >= 0)
 	    {
 		if ((c = *ptr) != NUL && c != NL)  // catch most common case
+		{
+		    char_u  *nl;
+		    long    n;
+
+		    // Skip to the next NL or NUL, memchr() is much faster than
+		    // checking each byte.
+		    nl = memchr(ptr, NL, (size_t)size + 1);
+		    n = nl == NULL ? size + 1 : (long)(nl - ptr);
+		    nl = memchr(ptr, NUL, (size_t)n);
+		    if (nl != NULL)
+			n = (long)(nl - ptr);
+		    ptr += n - 1;
+		    size -= n - 1;
 		    continue;
+		}
 		if (c == NUL)
 		    *ptr = NL;	// NULs are replaced by newlines!
 		else
@@ -2290,12 +2391,17 @@ rewind_retry:
 					set_fileformat(EOL_UNIX, OPT_LOCAL);
 				    file_rewind = TRUE;
 				    keep_fileformat = TRUE;
+				    read_lines_count = 0;
 				    goto retry;
 				}
 				ff_error = EOL_DOS;
 			    }
 			}
-			if (ml_append(lnum, line_start, len, newfile) == FAIL)
+			read_lines[read_lines_count].string = line_start;
+			read_lines[read_lines_count].length = len - 1;
+			if (++read_lines_count == READ_LINES_MAX
+				&& readfile_append(&lnum, read_lines,
+					  &read_lines_count, newfile) == FAIL)
 			{
 			    error = TRUE;
 			    break;
@@ -2304,7 +2410,6 @@ rewind_retry:
 			if (read_undo_file)
 			    sha256_update(&sha_ctx, line_start, len);
 #endif
-			++lnum;
 			if (--read_count == 0)
 			{
 			    error = TRUE;	    // break loop
@@ -2318,6 +2423,10 @@ rewind_retry:
 		}
 	    }
 	}
+	// The lines are in "buffer", append them before it is reused.
+	if (read_lines_count > 0 && readfile_append(&lnum, read_lines,
+					 &read_lines_count, newfile) == FAIL)
+	    error = TRUE;
 	linerest = (long)(ptr - line_start);
 	ui_breakcheck();
     }
@@ -2789,6 +2898,28 @@ readfile_linenr(
     return lnum;
 }
 
+/*
+ * Append the "*countp" lines in "lines" after line "*lnump" and advance
+ * "*lnump" by the number of lines that were appended.  Resets "*countp".
+ * Returns FAIL when not all lines could be appended.
+ */
+    static int
+readfile_append(
+    linenr_T	*lnump,
+    string_T	*lines,
+    int		*countp,
+    int		newfile)
+{
+    long	done;
+    int		count = *countp;
+
+    *countp = 0;
+    done = ml_append_multi(*lnump, lines, (long)count,
+						newfile ? ML_APPEND_NEW : 0);
+    *lnump += done;
+    return done == count ? OK : FAIL;
+}
+
 /*
  * Fill "*eap" to force the 'fileencoding', 'fileformat' and 'binary' to be
  * equal to the buffer "buf".  Used for calling readfile().
@@ -3405,6 +3536,46 @@ check_for_bom(
     return (char_u *)name;
 }
 
+#ifdef USE_MMAP
+/*
+ * Check if the text of a file, of which the first "len" bytes are in "text",
+ * can be used as-is for the buffer lines: It has no BOM, is not encrypted
+ * and has Unix line endings.  When "fileformat" is EOL_UNKNOWN "text" is
+ * checked like readfile() would.  ml_append_lazy() checks the rest.
+ * Return OK or FAIL.
+ */
+    static int
+lazy_text_ok(
+    char_u	*text,
+    long	len,
+    int		fileformat,
+    int		try_unix)
+{
+    int		blen;
+
+    if (len < 2 || (!curbuf->b_p_bin
+		&& check_for_bom(text, len < 4 ? len : 4L, &blen,
+							   FIO_ALL) != NULL))
+	return FAIL;
+# ifdef FEAT_CRYPT
+    // the magic string that crypt.c checks for
+    if (len >= 9 && memcmp(text, "VimCrypt~", 9) == 0)
+	return FAIL;
+# endif
+
+    if (fileformat == EOL_UNKNOWN)
+    {
+	// A NL without any CR is detected as Unix format.
+	if (!try_unix || memchr(text, NL, (size_t)len) == NULL
+				       || memchr(text, CAR, (size_t)len) != NULL)
+	    return FAIL;
+    }
+    else if (fileformat != EOL_UNIX)
+	return FAIL;
+    return OK;
+}
+#endif
+
 /*
  * Try to find a shortname by comparing the fullname with the current
  * directory.
@@ -895,6 +895,12 @@ EXTERN int	diff_need_scrollbind INIT(= FALSE);
 // ('lines' and 'rows') must not be changed and prevents recursive updating.
 EXTERN int	updating_screen INIT(= FALSE);
 
+// Number of bytes written to the terminal by the last update_screen().
+EXTERN long	redraw_bytes INIT(= 0);
+
+// Number of times the output was written by the last update_screen().
+EXTERN long	redraw_writes INIT(= 0);
+
 // While computing a statusline and the like we do not want any w_redr_type or
 // must_redraw to be set.
 EXTERN int	redraw_not_allowed INIT(= FALSE);
@@ -1083,6 +1089,11 @@ EXTERN buf_T	*curbuf INIT(= NULL);	// currently active buffer
 // are to be loaded into memory.  Shouldn't be global...
 EXTERN int	mf_dont_release INIT(= FALSE);	// don't release blocks
 
+// Number of line lookups that were found in, or missed, the recently used
+// data blocks of a memline.  Only for measuring and testing.
+EXTERN long	ml_cache_hits INIT(= 0);
+EXTERN long	ml_cache_misses INIT(= 0);
+
 /*
  * List of files being edited (global argument list).  curwin->w_alist points
  * to this when the window is using the global argument list.
@@ -1906,6 +1917,10 @@ EXTERN int	virtual_op INIT(= MAYBE);
 #ifdef FEAT_SYN_HL
 // Display tick, incremented for each call to update_screen()
 EXTERN disptick_T	display_tick INIT(= 0);
+
+// Incremented when the syntax attributes of lines may change without a change
+// in the text: highlighting, ":syntax" and 'iskeyword' changes.
+EXTERN int		syn_lines_tick INIT(= 0);
 #endif
 
 #ifdef FEAT_SPELL
@@ -97,7 +97,7 @@ did_set_imstatusfunc(optset_T *args UNUSED)
 # ifdef FEAT_GUI_MACVIM
     void
 # else
-    static void
+    void
 # endif
 call_imactivatefunc(int active)
 {
@@ -115,7 +115,7 @@ call_imactivatefunc(int active)
 # ifdef FEAT_GUI_MACVIM
     int
 # else
-    static int
+    int
 # endif
 call_imstatusfunc(void)
 {
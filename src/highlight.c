@@ -2914,6 +2914,11 @@ clear_hl_tables(void)
     int		i;
     attrentry_T	*taep;
 
+#ifdef FEAT_SYN_HL
+    // Syntax attributes stored for lines drawn are now invalid.
+    ++syn_lines_tick;
+#endif
+
 #ifdef FEAT_GUI
     ga_clear(&gui_attr_table);
 #endif
@@ -3489,6 +3494,11 @@ set_hl_attr(
     attrentry_T	    at_en;
     hl_group_T	    *sgp = HL_TABLE() + idx;
 
+#ifdef FEAT_SYN_HL
+    // Syntax attributes stored for lines drawn are now invalid.
+    ++syn_lines_tick;
+#endif
+
     // The "Normal" group doesn't need an attribute number
     if (sgp->sg_name_u != NULL && STRCMP(sgp->sg_name_u, "NORMAL") == 0)
 	return;
@@ -4021,6 +4031,10 @@ highlight_changed(void)
     static int	hl_flags[HLF_COUNT] = HL_FLAGS;
 
     need_highlight_changed = FALSE;
+#ifdef FEAT_SYN_HL
+    // A highlight link may have changed.
+    ++syn_lines_tick;
+#endif
 
 #ifdef FEAT_TERMINAL
     term_update_colors_all();
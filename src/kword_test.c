@@ -8,7 +8,10 @@
  */
 
 /*
- * kword_test.c: Unittests for vim_iswordc() and vim_iswordp().
+ * kword_test.c: Unittests for vim_iswordc() and vim_iswordp() and for finding
+ * syntax keywords with check_keyword_id().
+ *
+ * Run "./kword_test bench" to measure how fast syntax keywords are found.
  */
 
 #undef NDEBUG
@@ -18,8 +21,12 @@
 #define NO_VIM_MAIN
 #include "main.c"
 
-// This file has to be included because the tested functions are static
+// These files have to be included because the tested functions are static
 #include "charset.c"
+#include "syntax.c"
+
+static buf_T	kw_buf;
+static win_T	kw_win;
 
 /*
  * Test the results of vim_iswordc() and vim_iswordp() are matched.
@@ -73,10 +80,289 @@ test_isword_funcs_utf8(void)
     }
 }
 
+/*
+ * Setup an empty buffer and window for syntax keywords.
+ */
+    static void
+init_keyword_buf(void)
+{
+    CLEAR_FIELD(kw_buf);
+    CLEAR_FIELD(kw_win);
+    kw_buf.b_p_isk = (char_u *)"@,48-57,_,192-255";
+    kw_win.w_buffer = &kw_buf;
+    kw_win.w_s = &kw_buf.b_s;
+    curbuf = &kw_buf;
+    curwin = &kw_win;
+    (void)buf_init_chartab(&kw_buf, FALSE);
+    hash_init(&kw_buf.b_s.b_keywtab);
+    hash_init(&kw_buf.b_s.b_keywtab_ic);
+    syn_block = &kw_buf.b_s;
+    syn_buf = &kw_buf;
+}
+
+    static void
+add_test_keyword(char *name, int id, int ic)
+{
+    kw_buf.b_s.b_syn_ic = ic;
+    add_keyword((char_u *)name, STRLEN(name), id, 0, NULL, NULL, 0);
+}
+
+/*
+ * Find a keyword the way check_keyword_id() did before using a trie: isolate
+ * the word, copy it and look it up in the hashtables.
+ */
+    static int
+find_keyword_in_hashtab(char_u *kwp, int *kwlenp)
+{
+    char_u	keyword[MAXKEYWLEN + 1];
+    hashtab_T	*ht;
+    hashitem_T	*hi;
+    int		kwlen = 0;
+    int		round;
+
+    do
+	kwlen += (*mb_ptr2len)(kwp + kwlen);
+    while (vim_iswordp_buf(kwp + kwlen, syn_buf));
+    if (kwlen > MAXKEYWLEN)
+	return 0;
+    vim_strncpy(keyword, kwp, kwlen);
+
+    for (round = 1; round <= 2; ++round)
+    {
+	ht = round == 1 ? &syn_block->b_keywtab : &syn_block->b_keywtab_ic;
+	if (ht->ht_used == 0)
+	    continue;
+	if (round == 2)
+	    (void)str_foldcase(kwp, kwlen, keyword, MAXKEYWLEN + 1);
+	hi = hash_find(ht, keyword);
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    *kwlenp = kwlen;
+	    return HI2KE(hi)->k_syn.id;
+	}
+    }
+    return 0;
+}
+
+/*
+ * Return the keyword ID found by check_keyword_id() at "text" and check that
+ * the keyword ends at "len".
+ */
+    static int
+keyword_id(char *text, int len)
+{
+    int		endcol = -1;
+    long	flags;
+    short	*next_list;
+    int		cchar;
+    int		id;
+
+    id = check_keyword_id((char_u *)text, 0, &endcol, &flags, &next_list,
+								NULL, &cchar);
+    assert(id == 0 || endcol == len);
+    return id;
+}
+
+/*
+ * Test finding syntax keywords with check_keyword_id().
+ */
+    static void
+test_check_keyword_id(void)
+{
+    char	*words[] = {"i", "if", "ifd", "ifdef", "int", "Int", "INT",
+			    "select", "SeLeCt", "fromage", "GRÜßE", "grüße",
+			    "ifdefx", "éclair", "Éclair", "x"};
+    char	*p;
+    int		i;
+    int		id;
+    int		len;
+
+    init_keyword_buf();
+    assert(keyword_id("if", 2) == 0);
+
+    add_test_keyword("if", 1, FALSE);
+    add_test_keyword("ifdef", 1, FALSE);
+    add_test_keyword("int", 1, FALSE);
+    add_test_keyword("Int", 2, FALSE);
+    add_test_keyword("SELECT", 3, TRUE);
+    add_test_keyword("from", 3, TRUE);
+    add_test_keyword("Grüße", 4, TRUE);
+    add_test_keyword("éclair", 4, FALSE);
+    // Prepended to the existing "if".
+    add_test_keyword("if", 5, FALSE);
+
+    assert(keyword_id("if x", 2) == 5);
+    assert(keyword_id("ifd", 3) == 0);
+    assert(keyword_id("ifdef(", 5) == 1);
+    assert(keyword_id("ifdefs", 6) == 0);
+    assert(keyword_id("i", 1) == 0);
+    assert(keyword_id("int", 3) == 1);
+    assert(keyword_id("Int", 3) == 2);
+    assert(keyword_id("INT", 3) == 0);
+    assert(keyword_id("select *", 6) == 3);
+    assert(keyword_id("SeLeCt", 6) == 3);
+    assert(keyword_id("fromage", 7) == 0);
+    assert(keyword_id("grüße", 7) == 4);
+    assert(keyword_id("GRüßE", 7) == 4);
+    assert(keyword_id("éclair", 7) == 4);
+    assert(keyword_id("Éclair", 7) == 0);
+
+    // Adding a keyword after the trie was built must find it.
+    add_test_keyword("ifd", 6, FALSE);
+    assert(keyword_id("ifd", 3) == 6);
+
+    // Must find the same as looking up the word in the hashtable.
+    for (i = 0; i < (int)ARRAY_LENGTH(words); ++i)
+    {
+	p = words[i];
+	len = 0;
+	id = find_keyword_in_hashtab((char_u *)p, &len);
+	assert(keyword_id(p, len) == id);
+    }
+
+    syntax_clear(&kw_buf.b_s);
+    assert(kw_buf.b_s.b_keywtrie.ga_len == 0);
+    assert(kw_buf.b_s.b_keywtrie_ic.ga_len == 0);
+}
+
+/*
+ * Return a pseudo random number, the same sequence every time.
+ */
+    static unsigned
+bench_random(void)
+{
+    static unsigned seed = 12345;
+
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+}
+
+/*
+ * Fill "buf" with a pseudo random word of "len" letters.
+ */
+    static void
+bench_word(char_u *buf, int len)
+{
+    int		i;
+
+    for (i = 0; i < len; ++i)
+	buf[i] = 'a' + bench_random() % 26;
+    buf[len] = NUL;
+}
+
+#define BENCH_KEYWORDS	5000
+#define BENCH_WORDS	20000
+#define BENCH_ROUNDS	200
+
+/*
+ * Measure how fast check_keyword_id() finds keywords, with a large number of
+ * keywords like for SQL, compared to isolating the word and using the
+ * hashtable.  Half of the words in the text are keywords.
+ */
+    static void
+bench_check_keyword_id(void)
+{
+    char_u	word[20];
+    char_u	*text;
+    char_u	**starts;
+    char_u	*p;
+    int		i;
+    int		round;
+    int		len;
+    long	found_trie = 0;
+    long	found_hash = 0;
+    clock_t	start;
+    double	build_time;
+    double	trie_time;
+    double	hash_time;
+    int		endcol;
+    long	flags;
+    short	*next_list;
+    int		cchar;
+
+    init_keyword_buf();
+    for (i = 0; i < BENCH_KEYWORDS; ++i)
+    {
+	bench_word(word, 3 + bench_random() % 8);
+	add_test_keyword((char *)word, 1 + i % 3, i % 4 == 0);
+    }
+
+    // Words in the text are separated by a space, every other one is a
+    // keyword, in upper case when it was added to ignore case.
+    text = alloc(BENCH_WORDS * 12);
+    starts = ALLOC_MULT(char_u *, BENCH_WORDS);
+    assert(text != NULL && starts != NULL);
+    p = text;
+    for (i = 0; i < BENCH_WORDS; ++i)
+    {
+	if (i % 2 == 0)
+	    bench_word(word, 3 + bench_random() % 8);
+	else
+	{
+	    hashitem_T	*hi;
+	    int		n = bench_random() % 2;
+	    hashtab_T	*ht = n == 0 ? &kw_buf.b_s.b_keywtab
+						    : &kw_buf.b_s.b_keywtab_ic;
+	    int		todo = 1 + bench_random() % (int)ht->ht_used;
+
+	    FOR_ALL_HASHTAB_ITEMS(ht, hi, todo)
+		if (!HASHITEM_EMPTY(hi) && --todo == 0)
+		    break;
+	    STRCPY(word, hi->hi_key);
+	    if (n == 1)
+		vim_strup(word);
+	}
+	starts[i] = p;
+	STRCPY(p, word);
+	p += STRLEN(word);
+	*p++ = ' ';
+    }
+    *p = NUL;
+
+    start = clock();
+    assert(keywtrie_get(&kw_buf.b_s.b_keywtab, &kw_buf.b_s.b_keywtrie)
+									!= NULL);
+    assert(keywtrie_get(&kw_buf.b_s.b_keywtab_ic, &kw_buf.b_s.b_keywtrie_ic)
+									!= NULL);
+    build_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (round = 0; round < BENCH_ROUNDS; ++round)
+	for (i = 0; i < BENCH_WORDS; ++i)
+	    if (check_keyword_id(starts[i], 0, &endcol, &flags, &next_list,
+							   NULL, &cchar) != 0)
+		++found_trie;
+    trie_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (round = 0; round < BENCH_ROUNDS; ++round)
+	for (i = 0; i < BENCH_WORDS; ++i)
+	    if (find_keyword_in_hashtab(starts[i], &len) != 0)
+		++found_hash;
+    hash_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    assert(found_trie == found_hash);
+    printf("%d keywords, %ld words checked, %ld found\n", BENCH_KEYWORDS,
+		       (long)BENCH_WORDS * BENCH_ROUNDS, found_trie);
+    printf("building the tries: %.3f sec, %d states\n", build_time,
+	      kw_buf.b_s.b_keywtrie.ga_len + kw_buf.b_s.b_keywtrie_ic.ga_len);
+    printf("check_keyword_id(): %.3f sec, %.1f Mwords/sec\n", trie_time,
+	       BENCH_WORDS * BENCH_ROUNDS / 1000000.0 / (trie_time + 1e-9));
+    printf("word in hashtable:  %.3f sec, %.1f Mwords/sec\n", hash_time,
+	       BENCH_WORDS * BENCH_ROUNDS / 1000000.0 / (hash_time + 1e-9));
+
+    syntax_clear(&kw_buf.b_s);
+    vim_free(starts);
+    vim_free(text);
+}
+
     int
-main(void)
+main(int argc, char **argv)
 {
     estack_init();
     test_isword_funcs_utf8();
+    test_check_keyword_id();
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+	bench_check_keyword_id();
     return 0;
 }
@@ -726,6 +726,9 @@ codepage_invalid:
     // The cell width depends on the type of multi-byte characters.
     (void)init_chartab();
 
+    // Compiled patterns depend on the encoding.
+    regcache_clear();
+
     // When enc_utf8 is set or reset, (de)allocate ScreenLinesUC[]
     screenalloc(FALSE);
 
@@ -1360,14 +1363,10 @@ utf_uint2cells(UINT32_T c)
 #endif
 
 /*
- * For UTF-8 character "c" return 2 for a double-width character, 1 for others.
- * Returns 4 or 6 for an unprintable character.
- * Is only correct for characters >= 0x80.
- * When p_ambw is "double", return 2 for a character with East Asian Width
- * class 'A'(mbiguous).
+ * Compute the value for utf_char2cells().
  */
-    int
-utf_char2cells(int c)
+    static int
+utf_char2cells_nocache(int c)
 {
     // Sorted list of non-overlapping intervals of East Asian double width
     // characters, generated with ../runtime/tools/unicode.vim.
@@ -1613,6 +1612,42 @@ utf_char2cells(int c)
     return 1;
 }
 
+/*
+ * Cell widths of the characters 0x80 - 0xffff, which are used most often.
+ * Zero when not computed yet.  Cleared when the widths may have changed.
+ */
+static char_u	utf_cells_cache[0x10000];
+static int	utf_cells_cache_tick = -1;
+
+/*
+ * For UTF-8 character "c" return 2 for a double-width character, 1 for others.
+ * Returns 4 or 6 for an unprintable character.
+ * Is only correct for characters >= 0x80.
+ * When p_ambw is "double", return 2 for a character with East Asian Width
+ * class 'A'(mbiguous).
+ */
+    int
+utf_char2cells(int c)
+{
+    int	    n;
+
+    if (c < 0x80 || c > 0xffff)
+	return utf_char2cells_nocache(c);
+
+    if (utf_cells_cache_tick != get_chartab_tick())
+    {
+	CLEAR_FIELD(utf_cells_cache);
+	utf_cells_cache_tick = get_chartab_tick();
+    }
+    n = utf_cells_cache[c];
+    if (n == 0)
+    {
+	n = utf_char2cells_nocache(c);
+	utf_cells_cache[c] = n;
+    }
+    return n;
+}
+
 /*
  * mb_ptr2cells() function pointer.
  * Return the number of display cells character at "*p" occupies.
@@ -2674,8 +2709,26 @@ utf_iscomposing(int c)
 	{0x1e944, 0x1e94a},
 	{0xe0100, 0xe01ef}
     };
+    // Bit for each character up to 0xffff, for a quick lookup.
+    static char_u	combining_bits[0x10000 / 8];
+    static int		combining_bits_done = FALSE;
+
+    if (c < 0 || c > 0xffff)
+	return intable(combining, sizeof(combining), c);
 
-    return intable(combining, sizeof(combining), c);
+    if (!combining_bits_done)
+    {
+	int	i;
+	int	n;
+
+	for (i = 0; i < (int)ARRAY_LENGTH(combining)
+					    && combining[i].first <= 0xffff; ++i)
+	    for (n = combining[i].first; n <= combining[i].last && n <= 0xffff;
+									  ++n)
+		combining_bits[n >> 3] |= 1 << (n & 7);
+	combining_bits_done = TRUE;
+    }
+    return (combining_bits[c >> 3] >> (c & 7)) & 1;
 }
 
 /*
@@ -5745,6 +5798,7 @@ update:
     cw_table_size_save = cw_table_size;
     cw_table = table;
     cw_table_size = table_size;
+    chartab_cells_changed();
 
     // Check that the new value does not conflict with 'listchars' or
     // 'fillchars'.
@@ -5754,6 +5808,7 @@ update:
 	emsg(_(error));
 	cw_table = cw_table_save;
 	cw_table_size = cw_table_size_save;
+	chartab_cells_changed();
 	vim_free(table);
 	return;
     }
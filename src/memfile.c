@@ -65,7 +65,53 @@ extern int dos2;			// this is in os_amiga.c
 
 static long_u	total_mem_used = 0;	// total memory used for memfiles
 
-static void mf_ins_hash(memfile_T *, bhdr_T *);
+#ifdef USE_SWAP_THREAD
+/*
+ * When syncing, blocks are written to the swap file by a separate thread.
+ * mf_sync() gives it a copy of each dirty block, so that the block can be
+ * changed again right away.  Before the swap file is used in any other way
+ * the queue must be emptied with mf_writer_wait().  The thread keeps the
+ * order of the writes, and it only touches the file descriptors in the queue.
+ * It uses pwrite(), so that it does not change the file offset that the main
+ * thread uses.
+ */
+typedef struct mf_wjob_S mf_wjob_T;
+struct mf_wjob_S
+{
+    mf_wjob_T	*wj_next;
+    int		wj_fd;		// file to write to, -1 for sync()
+    off_T	wj_offset;	// offset in the file
+    unsigned	wj_size;	// bytes in wj_data, zero for fsync()
+    char_u	*wj_data;	// copy of the block
+};
+
+// Maximum number of bytes waiting to be written.  When there are more
+// mf_sync() waits for the thread to catch up.
+# define MFW_MAX_PENDING (8 * 1024 * 1024)
+
+static pthread_mutex_t	mfw_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	mfw_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	mfw_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t	mfw_write_mutex = PTHREAD_MUTEX_INITIALIZER;
+						// held while doing a job
+static int		mfw_abandon = FALSE;	// drop the jobs, main thread
+						// writes the blocks itself
+static mf_wjob_T	*mfw_first = NULL;	// first job in the queue
+static mf_wjob_T	*mfw_last = NULL;	// last job in the queue
+static mf_wjob_T	*mfw_done = NULL;	// finished jobs, to be freed
+static long_u		mfw_pending = 0;	// bytes not written yet
+static int		mfw_busy = FALSE;	// thread is doing a job
+static int		mfw_failed = FALSE;	// a write failed
+static int		mfw_state = 0;		// 0: not started, 1: running,
+						// -1: could not start or stopped
+static int		mf_write_async = FALSE;	// mf_write() uses the queue
+
+static int  mf_writer_start(void);
+static int  mf_writer_add(int fd, off_T offset, char_u *data, unsigned size);
+static int  mf_write_queue(memfile_T *mfp, bhdr_T *hp, off_T offset, unsigned size);
+#endif
+
+static int mf_ins_hash(memfile_T *, bhdr_T *);
 static void mf_rem_hash(memfile_T *, bhdr_T *);
 static bhdr_T *mf_find_hash(memfile_T *, blocknr_T);
 static void mf_ins_used(memfile_T *, bhdr_T *);
@@ -84,9 +130,12 @@ static void mf_hash_init(mf_hashtab_T *);
 static void mf_hash_free(mf_hashtab_T *);
 static void mf_hash_free_all(mf_hashtab_T *);
 static mf_hashitem_T *mf_hash_find(mf_hashtab_T *, blocknr_T);
-static void mf_hash_add_item(mf_hashtab_T *, mf_hashitem_T *);
+static int mf_hash_add_item(mf_hashtab_T *, mf_hashitem_T *);
 static void mf_hash_rem_item(mf_hashtab_T *, mf_hashitem_T *);
 static int mf_hash_grow(mf_hashtab_T *);
+#ifdef USE_MMAP
+static int  mf_is_lazy(memfile_T *, blocknr_T);
+#endif
 
 /*
  * The functions for using a memfile:
@@ -102,6 +151,7 @@ static int mf_hash_grow(mf_hashtab_T *);
  * mf_release_all() release as much memory as possible
  * mf_trans_del()   may translate negative to positive block number
  * mf_fullname()    make file name full path (use before first :cd)
+ * mf_lazy_free()   stop using the file that lines are loaded from
  */
 
 /*
@@ -155,6 +205,9 @@ mf_open(char_u *fname, int flags)
     mf_hash_init(&mfp->mf_hash);
     mf_hash_init(&mfp->mf_trans);
     mfp->mf_page_size = MEMFILE_PAGE_SIZE;
+#ifdef USE_MMAP
+    mfp->mf_lazy = NULL;
+#endif
 #ifdef FEAT_CRYPT
     mfp->mf_old_key = NULL;
 #endif
@@ -240,6 +293,9 @@ mf_close(memfile_T *mfp, int del_file)
 	return;
     if (mfp->mf_fd >= 0)
     {
+#ifdef USE_SWAP_THREAD
+	(void)mf_writer_wait();
+#endif
 	if (close(mfp->mf_fd) < 0)
 	    emsg(_(e_close_error_on_swap_file));
     }
@@ -256,6 +312,9 @@ mf_close(memfile_T *mfp, int del_file)
 	vim_free(mf_rem_free(mfp));
     mf_hash_free(&mfp->mf_hash);
     mf_hash_free_all(&mfp->mf_trans);	    // free hashtable and its items
+#ifdef USE_MMAP
+    mf_lazy_free(mfp);
+#endif
     vim_free(mfp->mf_fname);
     vim_free(mfp->mf_ffname);
     vim_free(mfp);
@@ -286,6 +345,9 @@ mf_close_file(
 	// TODO: should check if all blocks are really in core
     }
 
+#ifdef USE_SWAP_THREAD
+    (void)mf_writer_wait();
+#endif
     if (close(mfp->mf_fd) < 0)			// close the file
 	emsg(_(e_close_error_on_swap_file));
     mfp->mf_fd = -1;
@@ -385,11 +447,18 @@ mf_new(memfile_T *mfp, int negative, int page_count)
 	    mfp->mf_blocknr_max += page_count;
 	}
     }
+    if (mf_ins_hash(mfp, hp) == FAIL)
+    {
+	// The block number is not used, leaving a gap is harmless.
+	if (hp->bh_bnum < 0)
+	    mfp->mf_neg_count--;
+	mf_free_bhdr(hp);
+	return NULL;
+    }
     hp->bh_flags = BH_LOCKED | BH_DIRTY;	// new block is always dirty
     mfp->mf_dirty = MF_DIRTY_YES;
     hp->bh_page_count = page_count;
     mf_ins_used(mfp, hp);
-    mf_ins_hash(mfp, hp);
 
     /*
      * Init the data to all zero, to avoid reading uninitialized data.
@@ -418,9 +487,13 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
      * see if it is in the cache
      */
     hp = mf_find_hash(mfp, nr);
-    if (hp == NULL)	// not in the hash list
+    if (hp == NULL)	// not in the hash table
     {
-	if (nr < 0 || nr >= mfp->mf_infile_count)   // can't be in the file
+	if ((nr < 0
+#ifdef USE_MMAP
+		    && !mf_is_lazy(mfp, nr)	    // not in the loaded file
+#endif
+		    ) || nr >= mfp->mf_infile_count)   // can't be in the file
 	    return NULL;
 
 	// could check here if the block is in the free list
@@ -439,21 +512,18 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
 	hp->bh_bnum = nr;
 	hp->bh_flags = 0;
 	hp->bh_page_count = page_count;
-	if (mf_read(mfp, hp) == FAIL)	    // cannot read the block!
+	if (mf_read(mfp, hp) == FAIL	    // cannot read the block!
+		|| mf_ins_hash(mfp, hp) == FAIL)    // add to the hash table
 	{
 	    mf_free_bhdr(hp);
 	    return NULL;
 	}
     }
     else
-    {
 	mf_rem_used(mfp, hp);	// remove from list, insert in front below
-	mf_rem_hash(mfp, hp);
-    }
 
     hp->bh_flags |= BH_LOCKED;
     mf_ins_used(mfp, hp);	// put in front of used list
-    mf_ins_hash(mfp, hp);	// put in front of hash list
 
     return hp;
 }
@@ -482,6 +552,12 @@ mf_put(
     flags &= ~BH_LOCKED;
     if (dirty)
     {
+#ifdef USE_MMAP
+	// A block from the loaded file is counted as a negative block once it
+	// has been changed.
+	if (!(flags & BH_DIRTY) && mf_is_lazy(mfp, hp->bh_bnum))
+	    mfp->mf_neg_count++;
+#endif
 	flags |= BH_DIRTY;
 	if (mfp->mf_dirty != MF_DIRTY_YES_NOSYNC)
 	    mfp->mf_dirty = MF_DIRTY_YES;
@@ -498,12 +574,16 @@ mf_put(
 mf_free(memfile_T *mfp, bhdr_T *hp)
 {
     vim_free(hp->bh_data);	// free the memory
-    mf_rem_hash(mfp, hp);	// get *hp out of the hash list
+    mf_rem_hash(mfp, hp);	// get *hp out of the hash table
     mf_rem_used(mfp, hp);	// get *hp out of the used list
     if (hp->bh_bnum < 0)
     {
+#ifdef USE_MMAP
+	// an unchanged block from the loaded file was not counted
+	if ((hp->bh_flags & BH_DIRTY) || !mf_is_lazy(mfp, hp->bh_bnum))
+#endif
+	    mfp->mf_neg_count--;
 	vim_free(hp);		// don't want negative numbers in free list
-	mfp->mf_neg_count--;
     }
     else
 	mf_ins_free(mfp, hp);	// put *hp in the free list
@@ -540,6 +620,17 @@ mf_sync(memfile_T *mfp, int flags)
     // previously.
     got_int = FALSE;
 
+#ifdef USE_SWAP_THREAD
+    // When syncing while waiting for the user to type, the blocks are
+    // passed to the writer thread.  Otherwise, e.g. for block zero, for
+    // ":preserve" and when Vim is going down, they are written right away.
+    // Also report a failure of an earlier write.
+    if ((flags & MFS_STOP) && mf_writer_start() == OK)
+	mf_write_async = (mf_writer_check(FALSE) == OK);
+    else
+	(void)mf_writer_wait();
+#endif
+
     /*
      * sync from last to first (may reduce the probability of an inconsistent
      * file) If a write fails, it is very likely caused by a full filesystem.
@@ -580,6 +671,18 @@ mf_sync(memfile_T *mfp, int flags)
     if (hp == NULL || status == FAIL)
 	mfp->mf_dirty = MF_DIRTY_NO;
 
+#ifdef USE_SWAP_THREAD
+    if (mf_write_async)
+    {
+	mf_write_async = FALSE;
+	// let the writer thread flush the file after writing the blocks
+	if ((flags & MFS_FLUSH) && *p_sws != NUL
+		&& mf_writer_add(STRCMP(p_sws, "fsync") == 0 ? mfp->mf_fd : -1,
+							    0, NULL, 0) == OK)
+	    flags &= ~MFS_FLUSH;
+    }
+#endif
+
     if ((flags & MFS_FLUSH) && *p_sws != NUL)
     {
 #if defined(UNIX)
@@ -678,16 +781,17 @@ mf_set_dirty(memfile_T *mfp)
 }
 
 /*
- * insert block *hp in front of hashlist of memfile *mfp
+ * insert block *hp in the hash table of memfile *mfp
+ * Returns FAIL when out of memory.
  */
-    static void
+    static int
 mf_ins_hash(memfile_T *mfp, bhdr_T *hp)
 {
-    mf_hash_add_item(&mfp->mf_hash, (mf_hashitem_T *)hp);
+    return mf_hash_add_item(&mfp->mf_hash, (mf_hashitem_T *)hp);
 }
 
 /*
- * remove block *hp from hashlist of memfile list *mfp
+ * remove block *hp from the hash table of memfile *mfp
  */
     static void
 mf_rem_hash(memfile_T *mfp, bhdr_T *hp)
@@ -696,7 +800,7 @@ mf_rem_hash(memfile_T *mfp, bhdr_T *hp)
 }
 
 /*
- * look in hash lists of memfile *mfp for block header with number 'nr'
+ * look in the hash table of memfile *mfp for block header with number 'nr'
  */
     static bhdr_T *
 mf_find_hash(memfile_T *mfp, blocknr_T nr)
@@ -782,17 +886,30 @@ mf_release(memfile_T *mfp, int page_count)
 
     /*
      * don't release a block if
-     *	there is no file for this memfile
+     *	there is no file for this memfile and no file lines are loaded from
      * or
      *	the number of blocks for this memfile is lower than the maximum
      *	  and
      *	total memory used is not up to 'maxmemtot'
      */
-    if (mfp->mf_fd < 0 || !need_release)
+    if (!need_release || (mfp->mf_fd < 0
+#ifdef USE_MMAP
+			    && mfp->mf_lazy == NULL
+#endif
+			    ))
 	return NULL;
 
+#ifdef USE_SWAP_THREAD
+    // A block can only be read back after it was written.
+    if (mfp->mf_fd >= 0)
+	(void)mf_writer_wait();
+#endif
+
+    // Without a file only a block that isn't dirty can be released, it can
+    // be read again from the loaded file.
     for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
-	if (!(hp->bh_flags & BH_LOCKED))
+	if (!(hp->bh_flags & BH_LOCKED)
+		&& (mfp->mf_fd >= 0 || !(hp->bh_flags & BH_DIRTY)))
 	    break;
     if (hp == NULL)	// not a single one that can be released
 	return NULL;
@@ -840,6 +957,9 @@ mf_release_all(void)
     bhdr_T	*hp;
     int		retval = FALSE;
 
+#ifdef USE_SWAP_THREAD
+    (void)mf_writer_wait();
+#endif
     FOR_ALL_BUFFERS(buf)
     {
 	mfp = buf->b_ml.ml_mfp;
@@ -849,14 +969,19 @@ mf_release_all(void)
 	    if (mfp->mf_fd < 0 && buf->b_may_swap)
 		ml_open_file(buf);
 
-	    // only if there is a swapfile
-	    if (mfp->mf_fd >= 0)
+	    // only if there is a swapfile or a file lines are loaded from
+	    if (mfp->mf_fd >= 0
+#ifdef USE_MMAP
+		    || mfp->mf_lazy != NULL
+#endif
+		    )
 	    {
 		for (hp = mfp->mf_used_last; hp != NULL; )
 		{
 		    if (!(hp->bh_flags & BH_LOCKED)
 			    && (!(hp->bh_flags & BH_DIRTY)
-				|| mf_write(mfp, hp) != FAIL))
+				|| (mfp->mf_fd >= 0
+					       && mf_write(mfp, hp) != FAIL)))
 		    {
 			mf_rem_used(mfp, hp);
 			mf_rem_hash(mfp, hp);
@@ -939,8 +1064,15 @@ mf_read(memfile_T *mfp, bhdr_T *hp)
     unsigned	page_size;
     unsigned	size;
 
+#ifdef USE_MMAP
+    if (hp->bh_bnum < 0)    // block from the loaded file
+	return ml_lazy_read(mfp, hp);
+#endif
     if (mfp->mf_fd < 0)	    // there is no file, can't read
 	return FAIL;
+#ifdef USE_SWAP_THREAD
+    (void)mf_writer_wait();
+#endif
 
     page_size = mfp->mf_page_size;
     offset = (off_T)page_size * hp->bh_bnum;
@@ -994,7 +1126,7 @@ mf_write(memfile_T *mfp, bhdr_T *hp)
     /*
      * We don't want gaps in the file. Write the blocks in front of *hp
      * to extend the file.
-     * If block 'mf_infile_count' is not in the hash list, it has been
+     * If block 'mf_infile_count' is not in the hash table, it has been
      * freed. Fill the space in the file with data from the current block.
      */
     for (;;)
@@ -1021,6 +1153,17 @@ mf_write(memfile_T *mfp, bhdr_T *hp)
 	{
 	    if (mfp->mf_fd >= 0)
 	    {
+#ifdef USE_SWAP_THREAD
+		if (mf_write_async)
+		{
+		    if (mf_write_queue(mfp,
+				   hp2 == NULL ? hp : hp2, offset, size) == OK)
+			break;
+		    // out of memory, write it now
+		    mf_write_async = FALSE;
+		    (void)mf_writer_wait();
+		}
+#endif
 		if (vim_lseek(mfp->mf_fd, offset, SEEK_SET) != offset)
 		{
 		    PERROR(_(e_seek_error_in_swap_file_write));
@@ -1102,6 +1245,266 @@ mf_write_block(
     return result;
 }
 
+#if defined(USE_SWAP_THREAD) || defined(PROTO)
+/*
+ * Write the data of "job" at its offset.  Signals are blocked in the writer
+ * thread, thus there is no EINTR.
+ * Return FALSE when writing failed.
+ */
+    static int
+mf_writer_pwrite(mf_wjob_T *job)
+{
+    size_t	done = 0;
+    ssize_t	n;
+
+    while (done < job->wj_size)
+    {
+	n = pwrite(job->wj_fd, job->wj_data + done, job->wj_size - done,
+						   job->wj_offset + done);
+	if (n <= 0)
+	    return FALSE;
+	done += n;
+    }
+    return TRUE;
+}
+
+/*
+ * The writer thread: do the jobs in the queue until the end of time.
+ */
+    static void *
+mf_writer_thread(void *arg UNUSED)
+{
+    mf_wjob_T	*job;
+    int		ok;
+
+    pthread_mutex_lock(&mfw_mutex);
+    for (;;)
+    {
+	while (mfw_first == NULL)
+	    pthread_cond_wait(&mfw_work_cond, &mfw_mutex);
+	job = mfw_first;
+	mfw_first = job->wj_next;
+	if (mfw_first == NULL)
+	    mfw_last = NULL;
+	mfw_busy = TRUE;
+	pthread_mutex_unlock(&mfw_mutex);
+
+	pthread_mutex_lock(&mfw_write_mutex);
+	if (mfw_abandon)
+	    ok = TRUE;
+	else if (job->wj_size > 0)
+	    ok = mf_writer_pwrite(job);
+	else if (job->wj_fd >= 0)
+	    ok = vim_fsync(job->wj_fd) == 0;
+	else
+	{
+# ifdef HAVE_SYNC
+	    sync();
+# endif
+	    ok = TRUE;
+	}
+	pthread_mutex_unlock(&mfw_write_mutex);
+
+	pthread_mutex_lock(&mfw_mutex);
+	if (!ok)
+	    mfw_failed = TRUE;
+	mfw_pending -= job->wj_size;
+	job->wj_next = mfw_done;
+	mfw_done = job;
+	mfw_busy = FALSE;
+	pthread_cond_broadcast(&mfw_done_cond);
+    }
+    return NULL;
+}
+
+/*
+ * Start the writer thread if it isn't running yet.
+ * Return FAIL when there is no writer thread.
+ */
+    static int
+mf_writer_start(void)
+{
+    pthread_t	thread;
+    sigset_t	all_sigs, old_sigs;
+    int		r;
+
+    if (mfw_state == 0)
+    {
+	// The thread must not handle any signals, block them while it is
+	// created so that it inherits that.
+	sigfillset(&all_sigs);
+	pthread_sigmask(SIG_SETMASK, &all_sigs, &old_sigs);
+	r = pthread_create(&thread, NULL, mf_writer_thread, NULL);
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+	if (r == 0)
+	{
+	    pthread_detach(thread);
+	    mfw_state = 1;
+	}
+	else
+	    mfw_state = -1;
+    }
+    return mfw_state == 1 ? OK : FAIL;
+}
+
+/*
+ * Add a job to the queue of the writer thread.  "data" is an allocated copy
+ * of "size" bytes, it is freed when the job is done.  When "size" is zero
+ * file descriptor "fd" is flushed, or all files when "fd" is -1.
+ * Waits when the thread is too far behind.
+ * Return FAIL when out of memory, "data" has been freed then.
+ */
+    static int
+mf_writer_add(int fd, off_T offset, char_u *data, unsigned size)
+{
+    mf_wjob_T	*job;
+
+    job = ALLOC_ONE(mf_wjob_T);
+    if (job == NULL)
+    {
+	vim_free(data);
+	return FAIL;
+    }
+    job->wj_next = NULL;
+    job->wj_fd = fd;
+    job->wj_offset = offset;
+    job->wj_size = size;
+    job->wj_data = data;
+
+    pthread_mutex_lock(&mfw_mutex);
+    while (mfw_pending > MFW_MAX_PENDING)
+	pthread_cond_wait(&mfw_done_cond, &mfw_mutex);
+    if (size == 0 && mfw_last != NULL && mfw_last->wj_size == 0
+						     && mfw_last->wj_fd == fd)
+    {
+	// the file is already going to be flushed after the last write
+	pthread_mutex_unlock(&mfw_mutex);
+	vim_free(job);
+	return OK;
+    }
+    if (mfw_last == NULL)
+	mfw_first = job;
+    else
+	mfw_last->wj_next = job;
+    mfw_last = job;
+    mfw_pending += size;
+    pthread_cond_signal(&mfw_work_cond);
+    pthread_mutex_unlock(&mfw_mutex);
+    return OK;
+}
+
+/*
+ * Give a copy of block "hp", "size" bytes at "offset" in the swap file, to
+ * the writer thread.  Takes care of encryption.
+ * Return FAIL or OK.
+ */
+    static int
+mf_write_queue(memfile_T *mfp, bhdr_T *hp, off_T offset, unsigned size)
+{
+    char_u	*data;
+
+#ifdef FEAT_CRYPT
+    // Encrypt if 'key' is set and this is a data block.
+    if (*mfp->mf_buffer->b_p_key != NUL)
+	data = ml_encrypt_data(mfp, hp->bh_data, offset, size);
+    else
+#endif
+	data = vim_memsave(hp->bh_data, size);
+    if (data == NULL)
+	return FAIL;
+    return mf_writer_add(mfp->mf_fd, offset, data, size);
+}
+
+/*
+ * Mark the blocks in memory of all swap files dirty, so that they are written
+ * again.
+ */
+    static void
+mf_writer_redo_all(void)
+{
+    buf_T	*buf;
+
+    FOR_ALL_BUFFERS(buf)
+	if (buf->b_ml.ml_mfp != NULL && buf->b_ml.ml_mfp->mf_fd >= 0)
+	{
+	    mf_set_dirty(buf->b_ml.ml_mfp);
+	    buf->b_ml.ml_mfp->mf_dirty = MF_DIRTY_YES;
+	}
+}
+
+/*
+ * Free the jobs that the writer thread has finished and check whether one of
+ * them failed.  When "wait" is TRUE first wait for the queue to be empty.
+ * When a write failed give an error message and mark the blocks in memory
+ * dirty, so that they are written again.
+ * Return FAIL when a write failed.
+ */
+    int
+mf_writer_check(int wait)
+{
+    mf_wjob_T	*done;
+    mf_wjob_T	*next;
+    int		failed;
+
+    if (mfw_state != 1)
+	return OK;
+
+    if (really_exiting)
+    {
+	// Preserving files when Vim is going down, possibly from a signal
+	// handler that interrupted the main thread while it held the mutex.
+	// Locking it would hang then.  Stop using the writer thread and write
+	// all the blocks again directly.  The thread must not write any block
+	// after that, it only holds mfw_write_mutex while doing a job.
+	if (pthread_mutex_trylock(&mfw_mutex) != 0)
+	{
+	    pthread_mutex_lock(&mfw_write_mutex);
+	    mfw_abandon = TRUE;
+	    pthread_mutex_unlock(&mfw_write_mutex);
+	    mfw_state = -1;
+	    mf_writer_redo_all();
+	    return FAIL;
+	}
+    }
+    else
+	pthread_mutex_lock(&mfw_mutex);
+    if (wait)
+	while (mfw_first != NULL || mfw_busy)
+	    pthread_cond_wait(&mfw_done_cond, &mfw_mutex);
+    done = mfw_done;
+    mfw_done = NULL;
+    failed = mfw_failed;
+    mfw_failed = FALSE;
+    pthread_mutex_unlock(&mfw_mutex);
+
+    for ( ; done != NULL; done = next)
+    {
+	next = done->wj_next;
+	vim_free(done->wj_data);
+	vim_free(done);
+    }
+
+    if (!failed)
+	return OK;
+
+    if (!did_swapwrite_msg)
+	emsg(_(e_write_error_in_swap_file));
+    did_swapwrite_msg = TRUE;
+    mf_writer_redo_all();
+    return FAIL;
+}
+
+/*
+ * Wait for the writer thread to write all the blocks it was given.
+ * Return FAIL when a write failed.
+ */
+    int
+mf_writer_wait(void)
+{
+    return mf_writer_check(TRUE);
+}
+#endif
+
 /*
  * Make block number for *hp positive and add it to the translation list
  *
@@ -1121,6 +1524,14 @@ mf_trans_add(memfile_T *mfp, bhdr_T *hp)
     if ((np = ALLOC_ONE(NR_TRANS)) == NULL)
 	return FAIL;
 
+    // Insert "np" into "mf_trans" hashtable with key "np->nt_old_bnum"
+    np->nt_old_bnum = hp->bh_bnum;
+    if (mf_hash_add_item(&mfp->mf_trans, (mf_hashitem_T *)np) == FAIL)
+    {
+	vim_free(np);
+	return FAIL;
+    }
+
 /*
  * Get a new number for the block.
  * If the first item in the free list has sufficient pages, use its number
@@ -1152,15 +1563,12 @@ mf_trans_add(memfile_T *mfp, bhdr_T *hp)
 	mfp->mf_blocknr_max += page_count;
     }
 
-    np->nt_old_bnum = hp->bh_bnum;	    // adjust number
-    np->nt_new_bnum = new_bnum;
+    np->nt_new_bnum = new_bnum;		    // adjust number
 
-    mf_rem_hash(mfp, hp);		    // remove from old hash list
+    // Removing the block makes room, inserting it again can't fail.
+    mf_rem_hash(mfp, hp);		    // remove with the old number
     hp->bh_bnum = new_bnum;
-    mf_ins_hash(mfp, hp);		    // insert in new hash list
-
-    // Insert "np" into "mf_trans" hashtable with key "np->nt_old_bnum"
-    mf_hash_add_item(&mfp->mf_trans, (mf_hashitem_T *)np);
+    (void)mf_ins_hash(mfp, hp);		    // insert with the new number
 
     return OK;
 }
@@ -1227,6 +1635,38 @@ mf_need_trans(memfile_T *mfp)
     return (mfp->mf_fname != NULL && mfp->mf_neg_count > 0);
 }
 
+#if defined(USE_MMAP) || defined(PROTO)
+/*
+ * Return TRUE if block "nr" is a data block that can be read from the file
+ * located by ml_append_lazy().
+ */
+    static int
+mf_is_lazy(memfile_T *mfp, blocknr_T nr)
+{
+    mf_lazy_T	*mlp = mfp->mf_lazy;
+
+    return mlp != NULL && nr <= mlp->mfl_first
+				       && nr > mlp->mfl_first - mlp->mfl_count;
+}
+
+/*
+ * Stop using the file that the lines of "mfp" are loaded from.  Blocks that
+ * were not read yet can't be read after this!
+ */
+    void
+mf_lazy_free(memfile_T *mfp)
+{
+    mf_lazy_T	*mlp = mfp->mf_lazy;
+
+    if (mlp == NULL)
+	return;
+    close(mlp->mfl_fd);
+    vim_free(mlp->mfl_offset);
+    vim_free(mlp->mfl_lines);
+    VIM_CLEAR(mfp->mf_lazy);
+}
+#endif
+
 /*
  * Open a swap file for a memfile.
  * The "fname" must be in allocated memory, and is consumed (also when an
@@ -1312,13 +1752,35 @@ mf_do_open(
  */
 
 /*
- * The number of buckets in the hashtable is increased by a factor of
- * MHT_GROWTH_FACTOR when the average number of items per bucket
- * exceeds 2 ^ MHT_LOG_LOAD_FACTOR.
+ * The number of slots in the hashtable is increased by a factor of
+ * MHT_GROWTH_FACTOR when more than half of them are used.  With linear
+ * probing the number of slots looked at stays small then.
  */
-#define MHT_LOG_LOAD_FACTOR 6
 #define MHT_GROWTH_FACTOR   2   // must be a power of two
 
+/*
+ * Multiplier for the hash value: 2^32 divided by the golden ratio.  Block
+ * numbers are mostly consecutive, multiplying spreads them over the table.
+ * The high bits of the 32 bit product are used, the low bits are not mixed
+ * well.
+ */
+#define MHT_HASH_MULT	    0x9e3779b9UL
+
+#define MHT_HASH(mht, key) ((long_u)((UINT32_T)((UINT32_T)(key) \
+					* MHT_HASH_MULT) >> (mht)->mht_shift))
+
+/*
+ * Set the number of slots of hash table "mht" to "size", a power of two.
+ */
+    static void
+mf_hash_set_size(mf_hashtab_T *mht, long_u size)
+{
+    mht->mht_mask = size - 1;
+    mht->mht_shift = 32;
+    for ( ; size > 1; size >>= 1)
+	--mht->mht_shift;
+}
+
 /*
  * Initialize an empty hash table.
  */
@@ -1326,8 +1788,8 @@ mf_do_open(
 mf_hash_init(mf_hashtab_T *mht)
 {
     CLEAR_POINTER(mht);
-    mht->mht_buckets = mht->mht_small_buckets;
-    mht->mht_mask = MHT_INIT_SIZE - 1;
+    mht->mht_slots = mht->mht_small_slots;
+    mf_hash_set_size(mht, MHT_INIT_SIZE);
 }
 
 /*
@@ -1337,8 +1799,8 @@ mf_hash_init(mf_hashtab_T *mht)
     static void
 mf_hash_free(mf_hashtab_T *mht)
 {
-    if (mht->mht_buckets != mht->mht_small_buckets)
-	vim_free(mht->mht_buckets);
+    if (mht->mht_slots != mht->mht_small_slots)
+	vim_free(mht->mht_slots);
 }
 
 /*
@@ -1348,15 +1810,9 @@ mf_hash_free(mf_hashtab_T *mht)
 mf_hash_free_all(mf_hashtab_T *mht)
 {
     long_u	    idx;
-    mf_hashitem_T   *mhi;
-    mf_hashitem_T   *next;
 
     for (idx = 0; idx <= mht->mht_mask; idx++)
-	for (mhi = mht->mht_buckets[idx]; mhi != NULL; mhi = next)
-	{
-	    next = mhi->mhi_next;
-	    vim_free(mhi);
-	}
+	vim_free(mht->mht_slots[idx].mhs_item);
 
     mf_hash_free(mht);
 }
@@ -1368,46 +1824,52 @@ mf_hash_free_all(mf_hashtab_T *mht)
     static mf_hashitem_T *
 mf_hash_find(mf_hashtab_T *mht, blocknr_T key)
 {
-    mf_hashitem_T   *mhi;
-
-    mhi = mht->mht_buckets[key & mht->mht_mask];
-    while (mhi != NULL && mhi->mhi_key != key)
-	mhi = mhi->mhi_next;
+    long_u	    idx;
+    mf_hashslot_T   *mhs;
 
-    return mhi;
+    for (idx = MHT_HASH(mht, key); ; idx = (idx + 1) & mht->mht_mask)
+    {
+	mhs = &mht->mht_slots[idx];
+	if (mhs->mhs_item == NULL || mhs->mhs_key == key)
+	    return mhs->mhs_item;
+    }
 }
 
 /*
  * Add item "mhi" to hashtable "mht".
- * "mhi" must not be NULL.
+ * "mhi" must not be NULL and its key must not be in "mht" yet.
+ * Returns FAIL when the table is full and can't grow, "mhi" was not added.
  */
-    static void
+    static int
 mf_hash_add_item(mf_hashtab_T *mht, mf_hashitem_T *mhi)
 {
     long_u	    idx;
 
-    idx = mhi->mhi_key & mht->mht_mask;
-    mhi->mhi_next = mht->mht_buckets[idx];
-    mhi->mhi_prev = NULL;
-    if (mhi->mhi_next != NULL)
-	mhi->mhi_next->mhi_prev = mhi;
-    mht->mht_buckets[idx] = mhi;
-
-    mht->mht_count++;
-
     /*
-     * Grow hashtable when we have more thank 2^MHT_LOG_LOAD_FACTOR
-     * items per bucket on average
+     * Grow hashtable when more than half of the slots will be used.  If that
+     * fails keep on using it until only one empty slot is left, searching
+     * stops at an empty slot.
      */
-    if (mht->mht_fixed == 0
-	&& (mht->mht_count >> MHT_LOG_LOAD_FACTOR) > mht->mht_mask)
+    if ((mht->mht_fixed == 0 && (mht->mht_count + 1) * 2 > mht->mht_mask + 1)
+	    || mht->mht_count + 1 > mht->mht_mask)
     {
 	if (mf_hash_grow(mht) == FAIL)
 	{
 	    // stop trying to grow after first failure to allocate memory
 	    mht->mht_fixed = 1;
+	    if (mht->mht_count + 1 > mht->mht_mask)
+		return FAIL;
 	}
     }
+
+    idx = MHT_HASH(mht, mhi->mhi_key);
+    while (mht->mht_slots[idx].mhs_item != NULL)
+	idx = (idx + 1) & mht->mht_mask;
+    mht->mht_slots[idx].mhs_key = mhi->mhi_key;
+    mht->mht_slots[idx].mhs_item = mhi;
+
+    mht->mht_count++;
+    return OK;
 }
 
 /*
@@ -1417,13 +1879,39 @@ mf_hash_add_item(mf_hashtab_T *mht, mf_hashitem_T *mhi)
     static void
 mf_hash_rem_item(mf_hashtab_T *mht, mf_hashitem_T *mhi)
 {
-    if (mhi->mhi_prev == NULL)
-	mht->mht_buckets[mhi->mhi_key & mht->mht_mask] = mhi->mhi_next;
-    else
-	mhi->mhi_prev->mhi_next = mhi->mhi_next;
+    long_u	    idx;
+    long_u	    next;
+    long_u	    home;
+    mf_hashslot_T   *slots = mht->mht_slots;
 
-    if (mhi->mhi_next != NULL)
-	mhi->mhi_next->mhi_prev = mhi->mhi_prev;
+    idx = MHT_HASH(mht, mhi->mhi_key);
+    while (slots[idx].mhs_item != mhi)
+    {
+	if (slots[idx].mhs_item == NULL)
+	    return;	// not found, should not happen
+	idx = (idx + 1) & mht->mht_mask;
+    }
+
+    /*
+     * Move following items of the same run back into the emptied slot when
+     * that is not before their home slot, so that no search for them stops
+     * at an empty slot too early.
+     */
+    next = idx;
+    for (;;)
+    {
+	next = (next + 1) & mht->mht_mask;
+	if (slots[next].mhs_item == NULL)
+	    break;
+	home = MHT_HASH(mht, slots[next].mhs_key);
+	// Can move when "home" is not cyclically in (idx, next].
+	if (((next - home) & mht->mht_mask) >= ((next - idx) & mht->mht_mask))
+	{
+	    slots[idx] = slots[next];
+	    idx = next;
+	}
+    }
+    slots[idx].mhs_item = NULL;
 
     mht->mht_count--;
 
@@ -1432,71 +1920,44 @@ mf_hash_rem_item(mf_hashtab_T *mht, mf_hashitem_T *mhi)
 }
 
 /*
- * Increase number of buckets in the hashtable by MHT_GROWTH_FACTOR and
+ * Increase number of slots in the hashtable by MHT_GROWTH_FACTOR and
  * rehash items.
  * Returns FAIL when out of memory.
  */
     static int
 mf_hash_grow(mf_hashtab_T *mht)
 {
-    long_u	    i, j;
-    int		    shift;
-    mf_hashitem_T   *mhi;
-    mf_hashitem_T   *tails[MHT_GROWTH_FACTOR];
-    mf_hashitem_T   **buckets;
+    long_u	    i, idx;
+    long_u	    old_size;
+    mf_hashslot_T   *old_slots;
+    mf_hashslot_T   *slots;
     size_t	    size;
 
-    size = (mht->mht_mask + 1) * MHT_GROWTH_FACTOR * sizeof(void *);
-    buckets = lalloc_clear(size, FALSE);
-    if (buckets == NULL)
+    // the hash value has 32 bits
+    if (mht->mht_shift == 0)
+	return FAIL;
+    size = (mht->mht_mask + 1) * MHT_GROWTH_FACTOR * sizeof(mf_hashslot_T);
+    slots = lalloc_clear(size, FALSE);
+    if (slots == NULL)
 	return FAIL;
 
-    shift = 0;
-    while ((mht->mht_mask >> shift) != 0)
-	shift++;
-
-    for (i = 0; i <= mht->mht_mask; i++)
-    {
-	/*
-	 * Traverse the items in the i-th original bucket and move them into
-	 * MHT_GROWTH_FACTOR new buckets, preserving their relative order
-	 * within each new bucket.  Preserving the order is important because
-	 * mf_get() tries to keep most recently used items at the front of
-	 * each bucket.
-	 *
-	 * Here we strongly rely on the fact the hashes are computed modulo
-	 * a power of two.
-	 */
-
-	CLEAR_FIELD(tails);
+    // Allocating may have released blocks, get the sizes only now.
+    old_slots = mht->mht_slots;
+    old_size = mht->mht_mask + 1;
+    mht->mht_slots = slots;
+    mf_hash_set_size(mht, old_size * MHT_GROWTH_FACTOR);
 
-	for (mhi = mht->mht_buckets[i]; mhi != NULL; mhi = mhi->mhi_next)
+    for (i = 0; i < old_size; i++)
+	if (old_slots[i].mhs_item != NULL)
 	{
-	    j = (mhi->mhi_key >> shift) & (MHT_GROWTH_FACTOR - 1);
-	    if (tails[j] == NULL)
-	    {
-		buckets[i + (j << shift)] = mhi;
-		tails[j] = mhi;
-		mhi->mhi_prev = NULL;
-	    }
-	    else
-	    {
-		tails[j]->mhi_next = mhi;
-		mhi->mhi_prev = tails[j];
-		tails[j] = mhi;
-	    }
+	    idx = MHT_HASH(mht, old_slots[i].mhs_key);
+	    while (slots[idx].mhs_item != NULL)
+		idx = (idx + 1) & mht->mht_mask;
+	    slots[idx] = old_slots[i];
 	}
 
-	for (j = 0; j < MHT_GROWTH_FACTOR; j++)
-	    if (tails[j] != NULL)
-		tails[j]->mhi_next = NULL;
-    }
-
-    if (mht->mht_buckets != mht->mht_small_buckets)
-	vim_free(mht->mht_buckets);
-
-    mht->mht_buckets = buckets;
-    mht->mht_mask = (mht->mht_mask + 1) * MHT_GROWTH_FACTOR - 1;
+    if (old_slots != mht->mht_small_slots)
+	vim_free(old_slots);
 
     return OK;
 }
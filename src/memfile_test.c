@@ -24,6 +24,7 @@
 
 #define index_to_key(i) ((i) ^ 15167)
 #define TEST_COUNT 50000
+#define COLLIDE_COUNT 300
 
 /*
  * Test mf_hash_*() functions.
@@ -35,7 +36,7 @@ test_mf_hash(void)
     mf_hashitem_T  *item;
     blocknr_T      key;
     long_u	   i;
-    long_u	   num_buckets;
+    long_u	   num_slots;
 
     mf_hash_init(&ht);
 
@@ -44,23 +45,23 @@ test_mf_hash(void)
     {
 	assert(ht.mht_count == i);
 
-	// check that number of buckets is a power of 2
-	num_buckets = ht.mht_mask + 1;
-	assert(num_buckets > 0 && (num_buckets & (num_buckets - 1)) == 0);
+	// check that number of slots is a power of 2
+	num_slots = ht.mht_mask + 1;
+	assert(num_slots > 0 && (num_slots & (num_slots - 1)) == 0);
 
 	// check load factor
-	assert(ht.mht_count <= (num_buckets << MHT_LOG_LOAD_FACTOR));
+	assert(ht.mht_count * 2 <= num_slots);
 
-	if (i < (MHT_INIT_SIZE << MHT_LOG_LOAD_FACTOR))
+	if (i <= MHT_INIT_SIZE / 2)
 	{
 	    // first expansion shouldn't have occurred yet
-	    assert(num_buckets == MHT_INIT_SIZE);
-	    assert(ht.mht_buckets == ht.mht_small_buckets);
+	    assert(num_slots == MHT_INIT_SIZE);
+	    assert(ht.mht_slots == ht.mht_small_slots);
 	}
 	else
 	{
-	    assert(num_buckets > MHT_INIT_SIZE);
-	    assert(ht.mht_buckets != ht.mht_small_buckets);
+	    assert(num_slots > MHT_INIT_SIZE);
+	    assert(ht.mht_slots != ht.mht_small_slots);
 	}
 
 	key = index_to_key(i);
@@ -74,11 +75,11 @@ test_mf_hash(void)
 
 	assert(mf_hash_find(&ht, key) == item);
 
-	if (ht.mht_mask + 1 != num_buckets)
+	if (ht.mht_mask + 1 != num_slots)
 	{
 	    // hash table was expanded
-	    assert(ht.mht_mask + 1 == num_buckets * MHT_GROWTH_FACTOR);
-	    assert(i + 1 == (num_buckets << MHT_LOG_LOAD_FACTOR));
+	    assert(ht.mht_mask + 1 == num_slots * MHT_GROWTH_FACTOR);
+	    assert(i == num_slots / 2);
 	}
     }
 
@@ -135,9 +136,131 @@ test_mf_hash(void)
     mf_hash_free_all(&ht);
 }
 
+/*
+ * Test removing items from long runs of colliding keys.
+ */
+    static void
+test_mf_hash_collisions(void)
+{
+    mf_hashtab_T   ht;
+    mf_hashitem_T  *items[COLLIDE_COUNT];
+    long_u	   i, j;
+    UINT32_T	   inv = MHT_HASH_MULT;
+
+    mf_hash_init(&ht);
+
+    // Inverse of MHT_HASH_MULT modulo 2^32, each step doubles the number of
+    // correct bits.
+    for (i = 0; i < 5; i++)
+	inv *= 2 - (UINT32_T)MHT_HASH_MULT * inv;
+
+    // Keys that multiplied by MHT_HASH_MULT give a small number all have the
+    // same hash value.
+    for (i = 0; i < COLLIDE_COUNT; i++)
+    {
+	items[i] = LALLOC_CLEAR_ONE(mf_hashitem_T);
+	assert(items[i] != NULL);
+	items[i]->mhi_key = (blocknr_T)(UINT32_T)(i * inv);
+	assert(MHT_HASH(&ht, items[i]->mhi_key) == 0);
+	mf_hash_add_item(&ht, items[i]);
+    }
+
+    // remove every third item, all others must still be found
+    for (i = 0; i < COLLIDE_COUNT; i += 3)
+    {
+	mf_hash_rem_item(&ht, items[i]);
+	assert(mf_hash_find(&ht, items[i]->mhi_key) == NULL);
+	for (j = 0; j < COLLIDE_COUNT; j++)
+	    if (j % 3 != 0 || j > i)
+		assert(mf_hash_find(&ht, items[j]->mhi_key) == items[j]);
+	vim_free(items[i]);
+    }
+    assert(ht.mht_count == COLLIDE_COUNT - (COLLIDE_COUNT + 2) / 3);
+
+    mf_hash_free_all(&ht);
+}
+
+/*
+ * Measure the speed of the hash table with "count" blocks, numbered like a
+ * memfile does: positive numbers for blocks in the file and negative numbers
+ * for blocks only in memory.
+ */
+    static void
+bench_mf_hash(long count)
+{
+    mf_hashtab_T   ht;
+    mf_hashitem_T  *items;
+    long	   i;
+    long	   n;
+    long	   found = 0;
+    long	   lookups = count * 4;
+    long_u	   r = 12345;
+    clock_t	   start;
+
+    items = ALLOC_MULT(mf_hashitem_T, count);
+    assert(items != NULL);
+    mf_hash_init(&ht);
+
+    start = clock();
+    for (i = 0; i < count; i++)
+    {
+	items[i].mhi_key = i % 4 == 0 ? -1 - i / 4 : i;
+	mf_hash_add_item(&ht, &items[i]);
+    }
+    printf("insert %ld blocks:      %.3f sec\n", count,
+				(double)(clock() - start) / CLOCKS_PER_SEC);
+
+    // look up existing blocks in random order
+    start = clock();
+    for (n = 0; n < lookups; n++)
+    {
+	r = r * 1103515245 + 12345;
+	i = (long)((r >> 8) % (long_u)count);
+	if (mf_hash_find(&ht, items[i].mhi_key) != NULL)
+	    ++found;
+    }
+    assert(found == lookups);
+    printf("%ld random hits:   %.3f sec\n", lookups,
+				(double)(clock() - start) / CLOCKS_PER_SEC);
+
+    // look up blocks that are not in the table
+    start = clock();
+    for (n = 0; n < lookups; n++)
+	if (mf_hash_find(&ht, count + n) != NULL)
+	    ++found;
+    assert(found == lookups);
+    printf("%ld misses:        %.3f sec\n", lookups,
+				(double)(clock() - start) / CLOCKS_PER_SEC);
+
+    // remove and add blocks, like releasing and reading them
+    start = clock();
+    for (n = 0; n < lookups; n++)
+    {
+	r = r * 1103515245 + 12345;
+	i = (long)((r >> 8) % (long_u)count);
+	mf_hash_rem_item(&ht, &items[i]);
+	mf_hash_add_item(&ht, &items[i]);
+    }
+    printf("%ld remove + add:  %.3f sec\n", lookups,
+				(double)(clock() - start) / CLOCKS_PER_SEC);
+
+    mf_hash_free(&ht);
+    vim_free(items);
+}
+
+/*
+ * Without arguments run the tests.  With "bench" and optionally the number
+ * of blocks run the benchmark.
+ */
     int
-main(void)
+main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+	bench_mf_hash(argc > 2 ? atol(argv[2]) : 2000000L);
+	return 0;
+    }
     test_mf_hash();
+    test_mf_hash_collisions();
     return 0;
 }
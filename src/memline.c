@@ -256,6 +256,8 @@ static void ml_flush_line(buf_T *);
 static bhdr_T *ml_new_data(memfile_T *, int, int);
 static bhdr_T *ml_new_ptr(memfile_T *);
 static bhdr_T *ml_find_line(buf_T *, linenr_T, int);
+static int ml_cache_take(buf_T *, linenr_T, mlcache_T *);
+static void ml_cache_clear(buf_T *);
 static int ml_add_stack(buf_T *);
 static void ml_lineadd(buf_T *, int);
 static int b0_magic_wrong(ZERO_BL *);
@@ -292,10 +294,14 @@ ml_open(buf_T *buf)
     buf->b_ml.ml_stack = NULL;	// no stack yet
     buf->b_ml.ml_stack_top = 0;	// nothing in the stack
     buf->b_ml.ml_locked = NULL;	// no cached block
+    buf->b_ml.ml_cache_len = 0;	// no recently used blocks
     buf->b_ml.ml_line_lnum = 0;	// no cached line
 #ifdef FEAT_BYTEOFF
     buf->b_ml.ml_chunksize = NULL;
     buf->b_ml.ml_usedchunks = 0;
+    buf->b_ml.ml_chunkindex = NULL;
+    buf->b_ml.ml_chunkindex_size = 0;
+    buf->b_ml.ml_chunkindex_valid = FALSE;
 #endif
 
     if (cmdmod.cmod_flags & CMOD_NOSWAPFILE)
@@ -711,6 +717,9 @@ ml_setname(buf_T *buf)
 	// need to close the swap file before renaming
 	if (mfp->mf_fd >= 0)
 	{
+#ifdef USE_SWAP_THREAD
+	    (void)mf_writer_wait();
+#endif
 	    close(mfp->mf_fd);
 	    mfp->mf_fd = -1;
 	}
@@ -879,14 +888,21 @@ ml_close(buf_T *buf, int del_file)
     if (buf->b_ml.ml_mfp == NULL)		// not open
 	return;
     mf_close(buf->b_ml.ml_mfp, del_file);	// close the .swp file
+    buf->b_ml.ml_cache_len = 0;		// blocks were freed by mf_close()
     if (buf->b_ml.ml_line_lnum != 0
 		      && (buf->b_ml.ml_flags & (ML_LINE_DIRTY | ML_ALLOCATED)))
 	vim_free(buf->b_ml.ml_line_ptr);
     vim_free(buf->b_ml.ml_stack);
 #ifdef FEAT_BYTEOFF
     VIM_CLEAR(buf->b_ml.ml_chunksize);
+    VIM_CLEAR(buf->b_ml.ml_chunkindex);
+    buf->b_ml.ml_chunkindex_size = 0;
+    buf->b_ml.ml_chunkindex_valid = FALSE;
 #endif
     buf->b_ml.ml_mfp = NULL;
+#ifdef FEAT_PROP_POPUP
+    prop_index_invalidate(buf);
+#endif
 
     // Reset the "recovered" flag, give the ATTENTION prompt the next time
     // this buffer is loaded.
@@ -1274,6 +1290,7 @@ ml_recover(int checkext)
     buf->b_ml.ml_stack_top = 0;		// nothing in the stack
     buf->b_ml.ml_line_lnum = 0;		// no cached line
     buf->b_ml.ml_locked = NULL;		// no locked block
+    buf->b_ml.ml_cache_len = 0;		// no recently used blocks
     buf->b_ml.ml_flags = 0;
 #ifdef FEAT_CRYPT
     buf->b_p_key = empty_option;
@@ -2571,6 +2588,12 @@ ml_preserve(buf_T *buf, int message)
 	return;
 #endif
 
+#ifdef USE_MMAP
+    // After ":preserve" the original file is not needed for recovery.
+    if (message)
+	ml_lazy_detach(buf, NULL);
+#endif
+
     // We only want to stop when interrupted here, not when interrupted
     // before.
     got_int = FALSE;
@@ -2715,6 +2738,40 @@ ml_get_buf_len(buf_T *buf, linenr_T lnum)
     return buf->b_ml.ml_line_textlen - 1;
 }
 
+/*
+ * When "line" is the cached line "lnum" of "buf", as returned by
+ * ml_get_buf(), and it only contains printable ASCII characters, return its
+ * length.  Otherwise return -1.
+ * Every byte of such a line is a character that takes one cell, there are no
+ * Tabs.  The result is remembered until another line is cached or the line
+ * is changed.
+ */
+    int
+ml_line_ascii_len(buf_T *buf, linenr_T lnum, char_u *line)
+{
+    if (lnum != buf->b_ml.ml_line_lnum || line != buf->b_ml.ml_line_ptr)
+	return -1;
+
+    if (!(buf->b_ml.ml_flags & ML_ASCII_CHECKED))
+    {
+	char_u	*p = line;
+
+	while (*p >= ' ' && *p <= '~')
+	    ++p;
+	buf->b_ml.ml_flags |= ML_ASCII_CHECKED;
+	if (*p == NUL)
+	{
+	    buf->b_ml.ml_flags |= ML_LINE_ASCII;
+	    buf->b_ml.ml_line_textlen = (colnr_T)(p - line) + 1;
+	}
+	else
+	    buf->b_ml.ml_flags &= ~ML_LINE_ASCII;
+    }
+    if (!(buf->b_ml.ml_flags & ML_LINE_ASCII))
+	return -1;
+    return buf->b_ml.ml_line_textlen - 1;
+}
+
 /*
  * Return a pointer to a line in a specific buffer
  *
@@ -2748,6 +2805,9 @@ errorret:
 	buf->b_ml.ml_line_len = 4;
 	buf->b_ml.ml_line_textlen = buf->b_ml.ml_line_len;
 	buf->b_ml.ml_line_lnum = lnum;
+	// ml_line_ptr is not "questions", don't look at it
+	buf->b_ml.ml_flags = (buf->b_ml.ml_flags | ML_ASCII_CHECKED)
+							      & ~ML_LINE_ASCII;
 	return questions;
     }
     if (lnum <= 0)			// pretend line 0 is line 1
@@ -2817,11 +2877,16 @@ errorret:
 #endif
 	    buf->b_ml.ml_line_textlen = buf->b_ml.ml_line_len;
 	buf->b_ml.ml_line_lnum = lnum;
-	buf->b_ml.ml_flags &= ~(ML_LINE_DIRTY | ML_ALLOCATED);
+	buf->b_ml.ml_flags &= ~(ML_LINE_DIRTY | ML_ALLOCATED
+							  | ML_ASCII_CHECKED);
     }
     if (will_change)
     {
 	buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	buf->b_ml.ml_flags &= ~ML_ASCII_CHECKED;
+#ifdef FEAT_PROP_POPUP
+	prop_index_invalidate(buf);
+#endif
 #ifdef FEAT_EVAL
 	if (ml_get_alloc_lines && (buf->b_ml.ml_flags & ML_ALLOCATED))
 	    // can't make the change in the data block
@@ -2961,6 +3026,9 @@ ml_append_int(
     if (lnum > buf->b_ml.ml_line_count || buf->b_ml.ml_mfp == NULL)
 	return FAIL;  // lnum out of range
 
+#ifdef FEAT_PROP_POPUP
+    prop_index_invalidate(buf);
+#endif
     if (lowest_marked && lowest_marked > lnum)
 	lowest_marked = lnum + 1;
 
@@ -3553,6 +3621,146 @@ ml_append_buf(
 }
 #endif
 
+/*
+ * Copy as many of the "count" lines in "lines" as fit into the locked data
+ * block, after line "lnum", which must be in that block.
+ * Returns the number of lines added, zero when none could be added here.
+ */
+    static long
+ml_append_fill(
+    buf_T	*buf,
+    linenr_T	lnum,
+    string_T	*lines,
+    long	count,
+    int		flags)
+{
+    bhdr_T	*hp = buf->b_ml.ml_locked;
+    DATA_BL	*dp;
+    int		db_idx;
+    int		line_count;
+    int		offset;
+    int		len;
+    int		i;
+    long	n;
+
+    if (hp == NULL
+	    || lnum < buf->b_ml.ml_locked_low
+	    || lnum > buf->b_ml.ml_locked_high)
+	return 0;
+#ifdef FEAT_PROP_POPUP
+    // Text properties may need to be continued on each line.
+    if (curbuf->b_has_textprop)
+	return 0;
+#endif
+#ifdef FEAT_NETBEANS_INTG
+    if (netbeans_active())
+	return 0;
+#endif
+
+    dp = (DATA_BL *)(hp->bh_data);
+    for (n = 0; n < count; ++n)
+    {
+	len = (int)lines[n].length + 1;
+	if ((int)dp->db_free < len + (int)INDEX_SIZE)
+	    break;
+
+	db_idx = lnum + n - buf->b_ml.ml_locked_low;
+	line_count = buf->b_ml.ml_locked_high - buf->b_ml.ml_locked_low + 1;
+	offset = (dp->db_index[db_idx]) & DB_INDEX_MASK;
+	if (line_count > db_idx + 1)
+	{
+	    // move the text of the lines that follow to the front
+	    mch_memmove((char *)dp + dp->db_txt_start - len,
+					       (char *)dp + dp->db_txt_start,
+					 (size_t)(offset - dp->db_txt_start));
+	    for (i = line_count - 1; i > db_idx; --i)
+		dp->db_index[i + 1] = dp->db_index[i] - len;
+	}
+	dp->db_txt_start -= len;
+	dp->db_free -= len + INDEX_SIZE;
+	++(dp->db_line_count);
+	dp->db_index[db_idx + 1] = offset - len;
+	mch_memmove((char *)dp + offset - len, lines[n].string, (size_t)len);
+	if (flags & ML_APPEND_MARK)
+	    dp->db_index[db_idx + 1] |= DB_MARKED;
+
+	// The pointer blocks are updated when the block is released.
+	++(buf->b_ml.ml_locked_lineadd);
+	++(buf->b_ml.ml_locked_high);
+	++(buf->b_ml.ml_line_count);
+	buf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+	if (!(flags & ML_APPEND_NEW))
+	    buf->b_ml.ml_flags |= ML_LOCKED_POS;
+
+#ifdef FEAT_BYTEOFF
+	ml_updatechunk(buf, lnum + n + 1, (long)len, ML_CHNK_ADDLINE);
+	if (buf->b_ml.ml_locked != hp)
+	{
+	    // Splitting a chunk released the block.
+	    ++n;
+	    break;
+	}
+#endif
+    }
+
+#ifdef FEAT_JOB_CHANNEL
+    if (n > 0 && buf->b_write_to_channel)
+	channel_write_new_lines(buf);
+#endif
+    return n;
+}
+
+/*
+ * Append "count" lines after line "lnum" in the current buffer.  Does the
+ * same as calling ml_append() for each line, but each data block is looked
+ * up once and filled with as many lines as fit.
+ * The text of each line in "lines" must be NUL terminated, the length
+ * excludes the NUL.
+ * Returns the number of lines appended, less than "count" for failure.
+ */
+    long
+ml_append_multi(
+    linenr_T	lnum,		// append after this line (can be 0)
+    string_T	*lines,		// text of the new lines
+    long	count,		// number of lines in "lines"
+    int		flags)		// ML_APPEND_ values
+{
+    buf_T	*buf = curbuf;
+    long	done = 0;
+
+    if (count <= 0)
+	return 0;
+    if (buf->b_ml.ml_mfp == NULL && open_buffer(FALSE, NULL, 0) == FAIL)
+	return 0;
+    if (lnum > buf->b_ml.ml_line_count)
+	return 0;  // lnum out of range
+
+    if (buf->b_ml.ml_line_lnum != 0)
+	ml_flush_line(buf);
+#ifdef FEAT_EVAL
+    may_invoke_listeners(buf, lnum + 1, lnum + 1, count);
+    if (buf->b_ml.ml_line_lnum != 0)
+	ml_flush_line(buf);
+#endif
+
+    while (done < count)
+    {
+	long	n;
+
+	// ml_append_int() finds the block and splits it when it is full,
+	// then the following lines are added to the same block.
+	if (ml_append_int(buf, lnum, lines[done].string,
+			     (colnr_T)lines[done].length + 1, flags) == FAIL)
+	    break;
+	++done;
+	++lnum;
+	n = ml_append_fill(buf, lnum, lines + done, count - done, flags);
+	done += n;
+	lnum += n;
+    }
+    return done;
+}
+
 /*
  * Replace line "lnum", with buffering, in current buffer.
  *
@@ -3667,8 +3875,12 @@ ml_replace_len(
     curbuf->b_ml.ml_line_ptr = line;
     curbuf->b_ml.ml_line_len = len;
     curbuf->b_ml.ml_line_textlen = !has_props ? len_arg + 1 : 0;
+#ifdef FEAT_PROP_POPUP
+    prop_index_invalidate(curbuf);
+#endif
     curbuf->b_ml.ml_line_lnum = lnum;
-    curbuf->b_ml.ml_flags = (curbuf->b_ml.ml_flags | ML_LINE_DIRTY) & ~ML_EMPTY;
+    curbuf->b_ml.ml_flags = (curbuf->b_ml.ml_flags | ML_LINE_DIRTY)
+					       & ~(ML_EMPTY | ML_ASCII_CHECKED);
 
     return OK;
 }
@@ -3798,6 +4010,8 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int flags)
 #ifdef FEAT_PROP_POPUP
     char_u	*textprop_save = NULL;
     long	textprop_len = 0;
+
+    prop_index_invalidate(buf);
 #endif
 
     if (lowest_marked && lowest_marked > lnum)
@@ -4315,9 +4529,21 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
     int		top;
     int		page_count;
     int		idx;
+    int		cache_hit = FALSE;
+    mlcache_T	mc;
 
     mfp = buf->b_ml.ml_mfp;
 
+    /*
+     * Inserting or deleting a line changes the line numbers of the blocks
+     * after it, and flushing is done before the tree is changed or walked
+     * directly.  Release the recently used blocks in all those cases.
+     */
+    if (action != ML_FIND)
+	ml_cache_clear(buf);
+    else if (!mf_dont_release)
+	cache_hit = ml_cache_take(buf, lnum, &mc);
+
     /*
      * If there is a locked block check if the wanted line is in it.
      * If not, flush and release the locked block.
@@ -4346,8 +4572,40 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
 	    return (buf->b_ml.ml_locked);
 	}
 
-	mf_put(mfp, buf->b_ml.ml_locked, buf->b_ml.ml_flags & ML_LOCKED_DIRTY,
-					    buf->b_ml.ml_flags & ML_LOCKED_POS);
+	/*
+	 * When only looking up lines, keep an unchanged block locked in the
+	 * cache of recently used blocks, it is likely to be used again soon.
+	 */
+	if (action == ML_FIND
+		&& !mf_dont_release
+		&& buf->b_ml.ml_locked_lineadd == 0
+		&& (buf->b_ml.ml_flags & (ML_LOCKED_DIRTY | ML_LOCKED_POS)) == 0
+		&& buf->b_ml.ml_stack_top <= ML_CACHE_DEPTH)
+	{
+	    mlcache_T	*newmc;
+
+	    if (buf->b_ml.ml_cache_len == ML_CACHE_SIZE)
+	    {
+		// drop the least recently used block
+		mf_put(mfp, buf->b_ml.ml_cache[ML_CACHE_SIZE - 1].mc_hp,
+								 FALSE, FALSE);
+		--buf->b_ml.ml_cache_len;
+	    }
+	    mch_memmove(buf->b_ml.ml_cache + 1, buf->b_ml.ml_cache,
+			       sizeof(mlcache_T) * buf->b_ml.ml_cache_len);
+	    ++buf->b_ml.ml_cache_len;
+	    newmc = &buf->b_ml.ml_cache[0];
+	    newmc->mc_hp = buf->b_ml.ml_locked;
+	    newmc->mc_low = buf->b_ml.ml_locked_low;
+	    newmc->mc_high = buf->b_ml.ml_locked_high;
+	    newmc->mc_stack_top = buf->b_ml.ml_stack_top;
+	    mch_memmove(newmc->mc_stack, buf->b_ml.ml_stack,
+				   sizeof(infoptr_T) * buf->b_ml.ml_stack_top);
+	}
+	else
+	    mf_put(mfp, buf->b_ml.ml_locked,
+				    buf->b_ml.ml_flags & ML_LOCKED_DIRTY,
+				    buf->b_ml.ml_flags & ML_LOCKED_POS);
 	buf->b_ml.ml_locked = NULL;
 
 	/*
@@ -4361,6 +4619,24 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
     if (action == ML_FLUSH)	    // nothing else to do
 	return NULL;
 
+    if (action == ML_FIND && !mf_dont_release)
+    {
+	if (cache_hit)
+	{
+	    ++ml_cache_hits;
+	    mch_memmove(buf->b_ml.ml_stack, mc.mc_stack,
+					  sizeof(infoptr_T) * mc.mc_stack_top);
+	    buf->b_ml.ml_stack_top = mc.mc_stack_top;
+	    buf->b_ml.ml_locked = mc.mc_hp;
+	    buf->b_ml.ml_locked_low = mc.mc_low;
+	    buf->b_ml.ml_locked_high = mc.mc_high;
+	    buf->b_ml.ml_locked_lineadd = 0;
+	    buf->b_ml.ml_flags &= ~(ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	    return mc.mc_hp;
+	}
+	++ml_cache_misses;
+    }
+
     bnum = 1;			    // start at the root of the tree
     page_count = 1;
     low = 1;
@@ -4497,6 +4773,45 @@ error_noblock:
     return NULL;
 }
 
+/*
+ * Find the recently used data block of "buf" that contains line "lnum".
+ * When found remove it from the cache, store it in "mc" and return TRUE.
+ * The block remains locked.
+ */
+    static int
+ml_cache_take(buf_T *buf, linenr_T lnum, mlcache_T *mc)
+{
+    int		i;
+
+    for (i = 0; i < buf->b_ml.ml_cache_len; ++i)
+	if (buf->b_ml.ml_cache[i].mc_low <= lnum
+				      && buf->b_ml.ml_cache[i].mc_high >= lnum)
+	    break;
+    if (i == buf->b_ml.ml_cache_len
+		|| buf->b_ml.ml_cache[i].mc_stack_top > buf->b_ml.ml_stack_size)
+	return FALSE;
+
+    *mc = buf->b_ml.ml_cache[i];
+    --buf->b_ml.ml_cache_len;
+    mch_memmove(buf->b_ml.ml_cache + i, buf->b_ml.ml_cache + i + 1,
+			      sizeof(mlcache_T) * (buf->b_ml.ml_cache_len - i));
+    return TRUE;
+}
+
+/*
+ * Release the recently used data blocks of "buf" that ml_find_line() keeps
+ * locked.
+ */
+    static void
+ml_cache_clear(buf_T *buf)
+{
+    int		i;
+
+    for (i = 0; i < buf->b_ml.ml_cache_len; ++i)
+	mf_put(buf->b_ml.ml_mfp, buf->b_ml.ml_cache[i].mc_hp, FALSE, FALSE);
+    buf->b_ml.ml_cache_len = 0;
+}
+
 /*
  * add an entry to the info pointer stack
  *
@@ -5678,8 +5993,131 @@ ml_crypt_prepare(memfile_T *mfp, off_T offset, int reading)
 
 #if defined(FEAT_BYTEOFF)
 
-#define MLCS_MAXL 800	// max no of lines in chunk
-#define MLCS_MINL 400   // should be half of MLCS_MAXL
+#define MLCS_MAXL 100	// max no of lines in chunk
+#define MLCS_MINL 50    // should be half of MLCS_MAXL
+
+/*
+ * The chunks are indexed with a Fenwick tree in ml_chunkindex[]: entry "i"
+ * (starting at one) holds the sums for chunks "i - (i & -i)" up to "i - 1".
+ * This finds the chunk for a line or a byte offset in O(log n) steps, also
+ * in a very big buffer.  Adding or deleting a line only updates the sums.
+ * When chunks are split or joined the index is invalidated and rebuilt in
+ * O(n) when it is used again.
+ */
+    static int
+ml_chunkindex_build(buf_T *buf)
+{
+    chunksize_T	*idx;
+    int		n = buf->b_ml.ml_usedchunks;
+    int		i, j;
+
+    if (buf->b_ml.ml_chunkindex_size < n + 1)
+    {
+	idx = vim_realloc(buf->b_ml.ml_chunkindex,
+			      sizeof(chunksize_T) * (buf->b_ml.ml_numchunks + 1));
+	if (idx == NULL)
+	    return FAIL;
+	buf->b_ml.ml_chunkindex = idx;
+	buf->b_ml.ml_chunkindex_size = buf->b_ml.ml_numchunks + 1;
+    }
+    idx = buf->b_ml.ml_chunkindex;
+    mch_memmove(idx + 1, buf->b_ml.ml_chunksize, sizeof(chunksize_T) * n);
+    for (i = 1; i <= n; ++i)
+    {
+	j = i + (i & -i);
+	if (j <= n)
+	{
+	    idx[j].mlcs_numlines += idx[i].mlcs_numlines;
+	    idx[j].mlcs_totalsize += idx[i].mlcs_totalsize;
+	}
+    }
+    buf->b_ml.ml_chunkindex_valid = TRUE;
+    return OK;
+}
+
+/*
+ * Add "lines" and "size" to chunk "ix" in the index, if it is valid.
+ */
+    static void
+ml_chunkindex_add(buf_T *buf, int ix, int lines, long size)
+{
+    int		i;
+
+    if (!buf->b_ml.ml_chunkindex_valid)
+	return;
+    for (i = ix + 1; i <= buf->b_ml.ml_usedchunks; i += i & -i)
+    {
+	buf->b_ml.ml_chunkindex[i].mlcs_numlines += lines;
+	buf->b_ml.ml_chunkindex[i].mlcs_totalsize += size;
+    }
+}
+
+/*
+ * Find the chunk that contains line "lnum" (when not zero) or byte "offset"
+ * (when not zero).  With "ffdos" a CR is counted for every line when
+ * looking for "offset".  The last chunk is used when beyond the end.
+ * Sets "*curlinep" to the first line and "*sizep" to the byte count before
+ * the chunk.
+ * Returns the index of the chunk.
+ */
+    static int
+ml_chunk_find(
+    buf_T	*buf,
+    linenr_T	lnum,
+    long	offset,
+    int		ffdos,
+    linenr_T	*curlinep,
+    long	*sizep)
+{
+    chunksize_T	*idx;
+    int		limit = buf->b_ml.ml_usedchunks - 1;
+    int		pos = 0;
+    int		step;
+    linenr_T	lines = 0;
+    long	size = 0;
+    long	extra = (offset != 0 && ffdos) ? 1 : 0;
+
+    if (!buf->b_ml.ml_chunkindex_valid && ml_chunkindex_build(buf) == FAIL)
+    {
+	// Out of memory, go over the chunks one by one.
+	chunksize_T *chp = buf->b_ml.ml_chunksize;
+
+	while (pos < limit
+		&& ((lnum != 0 && lnum > lines + chp[pos].mlcs_numlines)
+		    || (offset != 0 && offset > size + chp[pos].mlcs_totalsize
+					  + extra * chp[pos].mlcs_numlines)))
+	{
+	    lines += chp[pos].mlcs_numlines;
+	    size += chp[pos].mlcs_totalsize + extra * chp[pos].mlcs_numlines;
+	    ++pos;
+	}
+    }
+    else
+    {
+	// Skip over the biggest groups of chunks that are entirely before
+	// the line or offset.
+	idx = buf->b_ml.ml_chunkindex;
+	for (step = 1; step * 2 <= limit; step *= 2)
+	    ;
+	for ( ; step > 0; step /= 2)
+	{
+	    chunksize_T	*chp = idx + pos + step;
+
+	    if (pos + step <= limit
+		    && ((lnum != 0 && lnum > lines + chp->mlcs_numlines)
+			|| (offset != 0 && offset > size + chp->mlcs_totalsize
+					     + extra * chp->mlcs_numlines)))
+	    {
+		pos += step;
+		lines += chp->mlcs_numlines;
+		size += chp->mlcs_totalsize + extra * chp->mlcs_numlines;
+	    }
+	}
+    }
+    *curlinep = lines + 1;
+    *sizep = size;
+    return pos;
+}
 
 /*
  * Keep information for finding byte offset of a line, updtype may be one of:
@@ -5722,6 +6160,7 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
+	buf->b_ml.ml_chunkindex_valid = FALSE;
     }
 
     if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
@@ -5732,6 +6171,7 @@ ml_updatechunk(
 	buf->b_ml.ml_usedchunks = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
 	buf->b_ml.ml_chunksize[0].mlcs_totalsize = (long)buf->b_ml.ml_line_len;
+	buf->b_ml.ml_chunkindex_valid = FALSE;
 	return;
     }
 
@@ -5741,13 +6181,7 @@ ml_updatechunk(
      */
     if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
 	    || updtype != ML_CHNK_ADDLINE)
-    {
-	for (curline = 1, curix = 0;
-	     curix < buf->b_ml.ml_usedchunks - 1
-	     && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	     curix++)
-	    curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-    }
+	curix = ml_chunk_find(buf, line, 0L, FALSE, &curline, &size);
     else if (curix < buf->b_ml.ml_usedchunks - 1
 	      && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
     {
@@ -5760,6 +6194,8 @@ ml_updatechunk(
     if (updtype == ML_CHNK_DELLINE)
 	len = -len;
     curchnk->mlcs_totalsize += len;
+    ml_chunkindex_add(buf, curix, updtype == ML_CHNK_ADDLINE ? 1
+			       : updtype == ML_CHNK_DELLINE ? -1 : 0, len);
     if (updtype == ML_CHNK_ADDLINE)
     {
 	curchnk->mlcs_numlines++;
@@ -5850,6 +6286,7 @@ ml_updatechunk(
 	    buf->b_ml.ml_chunksize[curix].mlcs_totalsize = size;
 	    buf->b_ml.ml_chunksize[curix + 1].mlcs_totalsize -= size;
 	    buf->b_ml.ml_usedchunks++;
+	    buf->b_ml.ml_chunkindex_valid = FALSE;
 	    ml_upd_lastbuf = NULL;   // Force recalc of curix & curline
 	    return;
 	}
@@ -5863,6 +6300,7 @@ ml_updatechunk(
 	     */
 	    curchnk = buf->b_ml.ml_chunksize + curix + 1;
 	    buf->b_ml.ml_usedchunks++;
+	    buf->b_ml.ml_chunkindex_valid = FALSE;
 	    if (line == buf->b_ml.ml_line_count)
 	    {
 		curchnk->mlcs_numlines = 0;
@@ -5908,6 +6346,7 @@ ml_updatechunk(
 	else if (curix == 0 && curchnk->mlcs_numlines <= 0)
 	{
 	    buf->b_ml.ml_usedchunks--;
+	    buf->b_ml.ml_chunkindex_valid = FALSE;
 	    mch_memmove(buf->b_ml.ml_chunksize, buf->b_ml.ml_chunksize + 1,
 			buf->b_ml.ml_usedchunks * sizeof(chunksize_T));
 	    return;
@@ -5923,6 +6362,7 @@ ml_updatechunk(
 	curchnk[-1].mlcs_numlines += curchnk->mlcs_numlines;
 	curchnk[-1].mlcs_totalsize += curchnk->mlcs_totalsize;
 	buf->b_ml.ml_usedchunks--;
+	buf->b_ml.ml_chunkindex_valid = FALSE;
 	if (curix < buf->b_ml.ml_usedchunks)
 	    mch_memmove(buf->b_ml.ml_chunksize + curix,
 			buf->b_ml.ml_chunksize + curix + 1,
@@ -5946,7 +6386,6 @@ ml_updatechunk(
 ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
 {
     linenr_T	curline;
-    int		curix;
     long	size;
     bhdr_T	*hp;
     DATA_BL	*dp;
@@ -5974,24 +6413,10 @@ ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
     if (lnum == 0 && offset <= 0)
 	return 1;   // Not a "find offset" and offset 0 _must_ be in line 1
     /*
-     * Find the last chunk before the one containing our line. Last chunk is
-     * special because it will never qualify.
+     * Find the chunk containing our line. Last chunk is special because it
+     * will never qualify.
      */
-    curline = 1;
-    curix = size = 0;
-    while (curix < buf->b_ml.ml_usedchunks - 1
-	    && ((lnum != 0
-	     && lnum >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
-		|| (offset != 0
-	       && offset > size + buf->b_ml.ml_chunksize[curix].mlcs_totalsize
-		 + (long)ffdos * buf->b_ml.ml_chunksize[curix].mlcs_numlines)))
-    {
-	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	size += buf->b_ml.ml_chunksize[curix].mlcs_totalsize;
-	if (offset && ffdos)
-	    size += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	curix++;
-    }
+    (void)ml_chunk_find(buf, lnum, offset, ffdos, &curline, &size);
 
     while ((lnum != 0 && curline < lnum) || (offset != 0 && size < offset))
     {
@@ -6151,3 +6576,410 @@ goto_byte(long cnt)
 	mb_adjust_cursor();
 }
 #endif
+
+#if defined(USE_MMAP) || defined(PROTO)
+
+// Number of bytes read at a time when locating the line breaks.
+#define LAZY_READ_SIZE 0x10000
+
+/*
+ * Insert the text of file "fd" in the current buffer, which must be empty.
+ * Lines end in a NL, a NUL is stored as a NL like readfile() does.
+ * The file is read in chunks to locate the line breaks, only the pointer
+ * blocks are created here.  The data blocks are read by ml_lazy_read() when
+ * they are used.  When "check_utf8" is TRUE fail if the text is not valid
+ * UTF-8.
+ * "*sizep" is set to the size of the file and "*no_eolp" to TRUE when the
+ * last line does not end in a NL.
+ * Returns the number of lines inserted, zero when failed.
+ */
+    linenr_T
+ml_append_lazy(int fd, int check_utf8, off_T *sizep, int *no_eolp)
+{
+    buf_T	*buf = curbuf;
+    memfile_T	*mfp = buf->b_ml.ml_mfp;
+    mf_lazy_T	*mlp = NULL;
+    garray_T	ga_off;		// byte offset of each data block
+    garray_T	ga_pe;		// entry for each data or pointer block
+    PTR_EN	*pe = NULL;
+    PTR_BL	*pp;
+    bhdr_T	*hp;
+    char_u	*text;
+    char_u	*p;
+    char_u	*end;
+    char_u	*nl;
+    long	nread;
+    int		carry = 0;	// bytes of a character continuing in the
+				// next chunk
+    int		l;
+    off_T	size = 0;	// number of bytes read
+    off_T	start = 0;	// byte offset of the current line
+    long	len = 0;	// length of the current line so far
+    long	used = 0;	// bytes used in the current data block
+    long	avail;
+    linenr_T	lnum = 0;
+    linenr_T	retval = 0;
+    stat_T	st;
+    int		count_max;
+    int		room;
+    int		i, n, idx;
+#ifdef FEAT_BYTEOFF
+    garray_T	ga_chunk;
+    chunksize_T	*chp = NULL;
+#endif
+
+    *no_eolp = FALSE;
+    if (mfp == NULL || !(buf->b_ml.ml_flags & ML_EMPTY)
+	    || vim_lseek(fd, (off_T)0, SEEK_SET) != 0
+	    || (text = alloc(LAZY_READ_SIZE + MB_MAXBYTES)) == NULL)
+	return 0;
+
+    ga_init2(&ga_off, sizeof(off_T), 1000);
+    ga_init2(&ga_pe, sizeof(PTR_EN), 1000);
+#ifdef FEAT_BYTEOFF
+    ga_init2(&ga_chunk, sizeof(chunksize_T), 100);
+#endif
+
+    // Split the text into data blocks, filled like ml_append() does.  A line
+    // that doesn't fit in one page gets a block of its own.
+    avail = mfp->mf_page_size - HEADER_SIZE;
+    do
+    {
+	// The text is read with read() instead of mapping it into memory:
+	// when the file is truncated meanwhile accessing the mapped pages
+	// would raise SIGBUS.
+	nread = read_eintr(fd, text + carry, LAZY_READ_SIZE);
+	if (nread < 0)
+	    goto theend;
+	size += nread;
+	p = text + carry;
+	end = p + nread;
+	for (;;)
+	{
+	    if (nread == 0)
+	    {
+		// At the end of the file, the last line may not end in a NL.
+		if (len == 0)
+		    break;
+		*no_eolp = TRUE;
+		nl = end;
+	    }
+	    else if ((nl = memchr(p, NL, (size_t)(end - p))) == NULL)
+	    {
+		// the line continues in the next chunk
+		len += (long)(end - p);
+		if (len >= MAXCOL)
+		    goto theend;
+		break;
+	    }
+	    len += (long)(nl - p) + 1;	// text plus NL or NUL
+	    if (len >= MAXCOL)
+		goto theend;
+	    if (used == 0 || used + len + (long)INDEX_SIZE > avail)
+	    {
+		if (ga_grow(&ga_off, 1) == FAIL || ga_grow(&ga_pe, 1) == FAIL)
+		    goto theend;
+		((off_T *)ga_off.ga_data)[ga_off.ga_len++] = start;
+		pe = (PTR_EN *)ga_pe.ga_data + ga_pe.ga_len++;
+		pe->pe_line_count = 0;
+		pe->pe_old_lnum = lnum + 1;
+		pe->pe_page_count = 1;
+		used = 0;
+	    }
+	    used += len + INDEX_SIZE;
+	    ++pe->pe_line_count;
+	    if (used > avail)
+		pe->pe_page_count = (int)((used + HEADER_SIZE
+				+ mfp->mf_page_size - 1) / mfp->mf_page_size);
+#ifdef FEAT_BYTEOFF
+	    if (lnum % MLCS_MINL == 0)
+	    {
+		if (ga_grow(&ga_chunk, 1) == FAIL)
+		    goto theend;
+		chp = (chunksize_T *)ga_chunk.ga_data + ga_chunk.ga_len++;
+		chp->mlcs_numlines = 0;
+		chp->mlcs_totalsize = 0;
+	    }
+	    ++chp->mlcs_numlines;
+	    chp->mlcs_totalsize += len;
+#endif
+	    ++lnum;
+	    start += len;
+	    len = 0;
+	    if (nl == end)
+		break;
+	    p = nl + 1;
+	}
+
+	if (check_utf8)
+	{
+	    // Check the bytes kept from the previous chunk and the new ones.
+	    // The bytes of an incomplete character at the end are kept for
+	    // the next chunk.
+	    for (p = text; p < end; )
+	    {
+		if (*p < 0x80)
+		    ++p;
+		else
+		{
+		    // A length of 1 means it's an illegal byte, a length
+		    // beyond the end an incomplete character.
+		    l = utf_ptr2len_len(p, end - p < 6 ? (int)(end - p) : 6);
+		    if (l == 1 || (l > end - p && nread == 0))
+			goto theend;
+		    if (l > end - p)
+			break;
+		    p += l;
+		}
+	    }
+	    carry = (int)(end - p);
+	    mch_memmove(text, p, (size_t)carry);
+	}
+    }
+    while (nread > 0);
+
+    if (lnum == 0)
+	goto theend;
+    mlp = ALLOC_CLEAR_ONE(mf_lazy_T);
+    mlp = ALLOC_CLEAR_ONE(mf_lazy_T);
+    if (mlp == NULL || ga_grow(&ga_off, 1) == FAIL)
+	goto theend;
+    ((off_T *)ga_off.ga_data)[ga_off.ga_len] = size;
+    *sizep = size;
+    mlp->mfl_fd = -1;
+    mlp->mfl_count = ga_pe.ga_len;
+    mlp->mfl_lines = ALLOC_MULT(int, ga_pe.ga_len);
+    if (mlp->mfl_lines == NULL || mch_fstat(fd, &st) < 0
+					     || (mlp->mfl_fd = dup(fd)) < 0)
+	goto theend;
+#ifdef HAVE_FD_CLOEXEC
+    {
+	int fdflags = fcntl(mlp->mfl_fd, F_GETFD);
+
+	if (fdflags >= 0 && (fdflags & FD_CLOEXEC) == 0)
+	    (void)fcntl(mlp->mfl_fd, F_SETFD, fdflags | FD_CLOEXEC);
+    }
+#endif
+    mlp->mfl_dev = st.st_dev;
+    mlp->mfl_ino = st.st_ino;
+    mlp->mfl_first = mfp->mf_blocknr_min;
+    for (i = 0; i < ga_pe.ga_len; ++i)
+    {
+	pe = (PTR_EN *)ga_pe.ga_data + i;
+	pe->pe_bnum = mlp->mfl_first - i;
+	mlp->mfl_lines[i] = pe->pe_line_count;
+    }
+
+    ml_flush_line(buf);				    // flush buffered line
+    (void)ml_find_line(buf, (linenr_T)0, ML_FLUSH); // flush locked block
+
+    // Add levels of pointer blocks until the entries fit in the root block,
+    // in front of the entries that are already there.
+    if ((hp = mf_get(mfp, 1, 1)) == NULL)
+	goto theend;
+    pp = (PTR_BL *)(hp->bh_data);
+    count_max = pp->pb_count_max;
+    room = count_max - pp->pb_count;
+    mf_put(mfp, hp, FALSE, FALSE);
+    while (ga_pe.ga_len > room)
+    {
+	n = 0;
+	for (idx = 0; idx < ga_pe.ga_len; idx += count_max)
+	{
+	    if ((hp = ml_new_ptr(mfp)) == NULL)
+		goto theend;
+	    pp = (PTR_BL *)(hp->bh_data);
+	    pp->pb_count = ga_pe.ga_len - idx < count_max
+					     ? ga_pe.ga_len - idx : count_max;
+	    mch_memmove(pp->pb_pointer, (PTR_EN *)ga_pe.ga_data + idx,
+					       pp->pb_count * sizeof(PTR_EN));
+	    pe = (PTR_EN *)ga_pe.ga_data + n++;
+	    pe->pe_bnum = hp->bh_bnum;
+	    pe->pe_line_count = 0;
+	    for (i = 0; i < pp->pb_count; ++i)
+		pe->pe_line_count += pp->pb_pointer[i].pe_line_count;
+	    pe->pe_old_lnum = pp->pb_pointer[0].pe_old_lnum;
+	    pe->pe_page_count = 1;
+	    mf_put(mfp, hp, TRUE, FALSE);
+	}
+	ga_pe.ga_len = n;
+    }
+    if ((hp = mf_get(mfp, 1, 1)) == NULL)
+	goto theend;
+    pp = (PTR_BL *)(hp->bh_data);
+    mch_memmove(pp->pb_pointer + ga_pe.ga_len, pp->pb_pointer,
+					       pp->pb_count * sizeof(PTR_EN));
+    mch_memmove(pp->pb_pointer, ga_pe.ga_data, ga_pe.ga_len * sizeof(PTR_EN));
+    pp->pb_count += ga_pe.ga_len;
+    mf_put(mfp, hp, TRUE, FALSE);
+
+    // The data blocks get negative numbers, they are not counted in
+    // mf_neg_count until they are changed.
+    mlp->mfl_offset = ga_off.ga_data;
+    ga_off.ga_data = NULL;
+    mfp->mf_blocknr_min -= mlp->mfl_count;
+    mfp->mf_lazy = mlp;
+    mlp = NULL;
+
+    if (lowest_marked)
+	lowest_marked = 1;
+    buf->b_ml.ml_line_count += lnum;
+    buf->b_ml.ml_flags &= ~ML_EMPTY;
+    buf->b_ml.ml_stack_top = 0;		// stack is invalid now
+#ifdef FEAT_BYTEOFF
+    if (buf->b_ml.ml_usedchunks != -1)
+    {
+	// The empty line that was in the buffer goes in the last chunk.
+	++chp->mlcs_numlines;
+	++chp->mlcs_totalsize;
+	vim_free(buf->b_ml.ml_chunksize);
+	buf->b_ml.ml_chunksize = ga_chunk.ga_data;
+	buf->b_ml.ml_numchunks = ga_chunk.ga_maxlen;
+	buf->b_ml.ml_usedchunks = ga_chunk.ga_len;
+	buf->b_ml.ml_chunkindex_valid = FALSE;
+	ga_chunk.ga_data = NULL;
+    }
+#endif
+    retval = lnum;
+
+theend:
+    if (mlp != NULL)
+    {
+	if (mlp->mfl_fd >= 0)
+	    close(mlp->mfl_fd);
+	vim_free(mlp->mfl_lines);
+	vim_free(mlp);
+    }
+    vim_free(text);
+    ga_clear(&ga_off);
+    ga_clear(&ga_pe);
+#ifdef FEAT_BYTEOFF
+    ga_clear(&ga_chunk);
+#endif
+    return retval;
+}
+
+/*
+ * Read data block "hp" from the file located by ml_append_lazy().  Called by
+ * mf_read() for a block that is not in memory.
+ * When the file was changed the lines are made empty.
+ */
+    int
+ml_lazy_read(memfile_T *mfp, bhdr_T *hp)
+{
+    mf_lazy_T	*mlp = mfp->mf_lazy;
+    long	idx = (long)(mlp->mfl_first - hp->bh_bnum);
+    off_T	offset = mlp->mfl_offset[idx];
+    size_t	size = (size_t)(mlp->mfl_offset[idx + 1] - offset);
+    int		line_count = mlp->mfl_lines[idx];
+    DATA_BL	*dp = (DATA_BL *)(hp->bh_data);
+    char_u	*text = NULL;
+    char_u	*p = NULL;
+    char_u	*end = NULL;
+    char_u	*nl;
+    char_u	*s;
+    char_u	*e;
+    unsigned	len;
+    int		i = 0;
+    int		read_ok = FALSE;
+
+    dp->db_id = DATA_ID;
+    dp->db_line_count = line_count;
+    dp->db_txt_end = hp->bh_page_count * mfp->mf_page_size;
+    dp->db_txt_start = dp->db_txt_end;
+
+    if (!mlp->mfl_changed)
+    {
+	if ((text = alloc(size)) == NULL)
+	    return FAIL;
+	// A short read means the file was truncated.
+	read_ok = vim_lseek(mlp->mfl_fd, offset, SEEK_SET) == offset
+		&& (size_t)read_eintr(mlp->mfl_fd, text, size) == size;
+	p = text;
+	end = text + size;
+    }
+
+    if (read_ok)
+	for (i = 0; i < line_count; ++i)
+	{
+	    nl = memchr(p, NL, (size_t)(end - p));
+	    if (nl == NULL)
+	    {
+		// Only the last line of the file may be without a NL.
+		if (i < line_count - 1 || idx + 1 != mlp->mfl_count
+								   || p == end)
+		    break;
+		nl = end;
+	    }
+	    len = (unsigned)(nl - p);
+	    dp->db_txt_start -= len + 1;
+	    dp->db_index[i] = dp->db_txt_start;
+	    s = (char_u *)dp + dp->db_txt_start;
+	    mch_memmove(s, p, (size_t)len);
+	    e = s + len;
+	    *e = NUL;
+	    // a NUL in the file is stored as a NL
+	    while ((s = memchr(s, NUL, (size_t)(e - s))) != NULL)
+		*s++ = NL;
+	    p = nl == end ? end : nl + 1;
+	}
+
+    // The text does not have the same lines as when it was opened.
+    if (!read_ok || i < line_count || p != end)
+    {
+	if (!mlp->mfl_changed)
+	{
+	    mlp->mfl_changed = TRUE;
+	    emsg(_(e_file_was_changed_after_opening_lines_missing));
+	}
+	dp->db_txt_start = dp->db_txt_end;
+	for (i = 0; i < line_count; ++i)
+	{
+	    dp->db_index[i] = --dp->db_txt_start;
+	    *((char_u *)dp + dp->db_txt_start) = NUL;
+	}
+    }
+
+    dp->db_free = dp->db_txt_start - (unsigned)(HEADER_SIZE
+						    + line_count * INDEX_SIZE);
+    vim_free(text);
+    return OK;
+}
+
+/*
+ * Read all the lines of "buf" that were not loaded from the file yet and stop
+ * using the file.  The lines are marked as changed, so that they go into the
+ * swap file.
+ * When "fname" is not NULL only do this when it is the file the lines are
+ * loaded from, which is going to be overwritten.
+ */
+    void
+ml_lazy_detach(buf_T *buf, char_u *fname)
+{
+    memfile_T	*mfp = buf->b_ml.ml_mfp;
+    mf_lazy_T	*mlp;
+    bhdr_T	*hp;
+    linenr_T	lnum;
+    stat_T	st;
+
+    if (mfp == NULL || (mlp = mfp->mf_lazy) == NULL)
+	return;
+    if (fname != NULL && (mch_stat((char *)fname, &st) < 0
+				|| st.st_dev != mlp->mfl_dev
+				|| st.st_ino != mlp->mfl_ino))
+	return;
+
+    ml_flush_line(buf);
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count;
+					  lnum = buf->b_ml.ml_locked_high + 1)
+    {
+	if ((hp = ml_find_line(buf, lnum, ML_FIND)) == NULL)
+	    return;	// keep the file, lines can't be read otherwise
+	if (hp->bh_bnum <= mlp->mfl_first
+			       && hp->bh_bnum > mlp->mfl_first - mlp->mfl_count)
+	    buf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+    }
+    (void)ml_find_line(buf, (linenr_T)0, ML_FLUSH);
+    mf_lazy_free(mfp);
+}
+#endif
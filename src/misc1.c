@@ -415,9 +415,13 @@ plines_win_nofold(win_T *wp, linenr_T lnum)
 #endif
 	    )
 	return 1; // be quick for an empty line
-    win_linetabsize_cts(&cts, (colnr_T)MAXCOL);
+    col = win_ascii_line_len(&cts, lnum);
+    if (col < 0)
+    {
+	win_linetabsize_cts(&cts, (colnr_T)MAXCOL);
+	col = (int)cts.cts_vcol;
+    }
     clear_chartabsize_arg(&cts);
-    col = (int)cts.cts_vcol;
 
     // If list mode is on, then the '$' at the end of the line may take up one
     // extra column.
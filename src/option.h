@@ -818,6 +818,9 @@ EXTERN long	p_msc;		// 'maxsearchcount'
 #ifdef FEAT_SPELL
 EXTERN char_u	*p_msm;		// 'mkspellmem'
 #endif
+#ifdef USE_MMAP
+EXTERN long	p_mms;		// 'mmapsize'
+#endif
 EXTERN int	p_ml;		// 'modeline'
 EXTERN int	p_mle;		// 'modelineexpr'
 EXTERN long	p_mls;		// 'modelines'
@@ -988,6 +991,7 @@ EXTERN char_u	*p_sua;		// 'suffixesadd'
 EXTERN int	p_swf;		// 'swapfile'
 #ifdef FEAT_SYN_HL
 EXTERN long	p_smc;		// 'synmaxcol'
+EXTERN long	p_smm;		// 'synmaxmem'
 #endif
 EXTERN long	p_tpm;		// 'tabpagemax'
 #ifdef FEAT_STL_OPT
@@ -399,7 +399,7 @@ static struct vimoption options[] =
 #ifdef FEAT_ANTIALIAS
 			    (char_u *)&p_antialias, PV_NONE, did_set_antialias, NULL,
 #else
-			    (char_u *)NULL, PV_NONE, NULL, NULL
+			    (char_u *)NULL, PV_NONE, NULL, NULL,
 #endif
 #ifdef FEAT_GUI_MACVIM
 			    {(char_u *)TRUE, (char_u *)FALSE}
@@ -1884,6 +1884,13 @@ static struct vimoption options[] =
 			    {(char_u *)0L, (char_u *)0L}
 #endif
 			    SCTX_INIT},
+    {"mmapsize",    "mms",  P_NUM|P_VI_DEF,
+#ifdef USE_MMAP
+			    (char_u *)&p_mms, PV_NONE, NULL, NULL,
+#else
+			    (char_u *)NULL, PV_NONE, NULL, NULL,
+#endif
+			    {(char_u *)0L, (char_u *)0L} SCTX_INIT},
     {"modeline",    "ml",   P_BOOL|P_VIM,
 			    (char_u *)&p_ml, PV_ML, NULL, NULL,
 			    {(char_u *)FALSE, (char_u *)TRUE} SCTX_INIT},
@@ -2652,6 +2659,15 @@ static struct vimoption options[] =
 #else
 			    (char_u *)NULL, PV_NONE, NULL, NULL,
 			    {(char_u *)0L, (char_u *)0L}
+#endif
+			    SCTX_INIT},
+    {"synmaxmem",   "smm",  P_NUM|P_VI_DEF,
+#ifdef FEAT_SYN_HL
+			    (char_u *)&p_smm, PV_NONE, NULL, NULL,
+			    {(char_u *)1000L, (char_u *)0L}
+#else
+			    (char_u *)NULL, PV_NONE, NULL, NULL,
+			    {(char_u *)0L, (char_u *)0L}
 #endif
 			    SCTX_INIT},
     {"syntax",	    "syn",  P_STRING|P_ALLOCED|P_VI_DEF|P_NOGLOB|P_NFNAME,
@@ -3183,6 +3199,7 @@ static struct vimoption options[] =
     p_term("t_bc", T_BC)
     p_term("t_BE", T_BE)
     p_term("t_BD", T_BD)
+    p_term("t_BS", T_BSU)
     p_term("t_cd", T_CD)
     p_term("t_ce", T_CE)
     p_term("t_Ce", T_UCE)
@@ -3202,6 +3219,7 @@ static struct vimoption options[] =
     p_term("t_Ds", T_CDS)
     p_term("t_EC", T_CEC)
     p_term("t_EI", T_CEI)
+    p_term("t_ES", T_ESU)
     p_term("t_fs", T_FS)
     p_term("t_fd", T_FD)
     p_term("t_fe", T_FE)
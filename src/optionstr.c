@@ -1062,10 +1062,17 @@ expand_set_opt_listflag(
     char *
 did_set_ambiwidth(optset_T *args UNUSED)
 {
+    char	*errmsg;
+
     if (check_opt_strings(p_ambw, p_ambw_values, FALSE) != OK)
 	return e_invalid_argument;
 
-    return check_chars_options();
+    chartab_cells_changed();
+    errmsg = check_chars_options();
+    if (errmsg != NULL)
+	// the old value will be restored
+	chartab_cells_changed();
+    return errmsg;
 }
 
     int
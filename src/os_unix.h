@@ -196,6 +196,10 @@ typedef void (*sighandler_T) SIGPROTOARG;
 # include <sys/file.h>
 #endif
 
+#ifdef HAVE_PTHREAD
+# include <pthread.h>
+#endif
+
 #ifdef VMS
 typedef struct dsc$descriptor   DESC;
 #endif
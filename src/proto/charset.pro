@@ -1,6 +1,8 @@
 /* charset.c */
 int init_chartab(void);
 int buf_init_chartab(buf_T *buf, int global);
+int get_chartab_tick(void);
+void chartab_cells_changed(void);
 int check_isopt(char_u *var);
 void trans_characters(char_u *buf, int bufsize);
 char_u *transstr(char_u *s);
@@ -24,6 +26,7 @@ int win_linetabsize(win_T *wp, linenr_T lnum, char_u *line, colnr_T len);
 int linetabsize(win_T *wp, linenr_T lnum);
 int linetabsize_eol(win_T *wp, linenr_T lnum);
 int linetabsize_no_outer(win_T *wp, linenr_T lnum);
+int win_ascii_line_len(chartabsize_T *cts, linenr_T lnum);
 void win_linetabsize_cts(chartabsize_T *cts, colnr_T len);
 int vim_isIDc(int c);
 int vim_isNormalIDc(int c);
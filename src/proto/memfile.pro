@@ -11,8 +11,11 @@ void mf_free(memfile_T *mfp, bhdr_T *hp);
 int mf_sync(memfile_T *mfp, int flags);
 void mf_set_dirty(memfile_T *mfp);
 int mf_release_all(void);
+int mf_writer_check(int wait);
+int mf_writer_wait(void);
 blocknr_T mf_trans_del(memfile_T *mfp, blocknr_T old_nr);
 void mf_set_ffname(memfile_T *mfp);
 void mf_fullname(memfile_T *mfp);
 int mf_need_trans(memfile_T *mfp);
+void mf_lazy_free(memfile_T *mfp);
 /* vim: set ft=c : */
@@ -16,8 +16,11 @@ void free_resub_eval_result(void);
 char_u *reg_submatch(int no);
 list_T *reg_submatch_list(int no);
 int vim_regcomp_had_eol(void);
+void regcache_clear(void);
+void f_regexpcacheinfo(typval_T *argvars, typval_T *rettv);
 regprog_T *vim_regcomp(char_u *expr_arg, int re_flags);
 void vim_regfree(regprog_T *prog);
+char_u *vim_regmust(char_u *expr, int re_flags, int *icp);
 void free_regexp_stuff(void);
 int regprog_in_use(regprog_T *prog);
 int vim_regexec_prog(regprog_T **prog, int ignore_case, char_u *line, colnr_T col);
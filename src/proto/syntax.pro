@@ -1,10 +1,16 @@
 /* syntax.c */
 void syntax_start(win_T *wp, linenr_T lnum);
+int syn_idle_parse(void);
 void syn_stack_free_all(synblock_T *block);
 void syn_stack_apply_changes(buf_T *buf);
 void syntax_end_parsing(win_T *wp, linenr_T lnum);
 int syntax_check_changed(linenr_T lnum);
 int get_syntax_attr(colnr_T col, int *can_spell, int keep_state);
+int syn_line_cache_find(win_T *wp, linenr_T lnum, int need_spell);
+int syn_line_cache_attr(colnr_T col, int *can_spell);
+void syn_line_cache_start(win_T *wp, linenr_T lnum, int need_spell);
+void syn_line_cache_add(colnr_T col, char_u *ptr, int attr, int *can_spell);
+void syn_line_cache_end(int keep);
 void syntax_clear(synblock_T *block);
 void reset_synblock(win_T *wp);
 void ex_syntax(exarg_T *eap);
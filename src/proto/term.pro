@@ -15,15 +15,21 @@ int term_is_gui(char_u *name);
 char_u *tltoa(unsigned long i);
 void termcapinit(char_u *name);
 void out_flush(void);
+long out_bytes_written(void);
+long out_write_count(void);
+void out_redraw_start(void);
+void out_redraw_end(void);
 void out_flush_cursor(int force, int clear_selection);
 void out_flush_check(void);
 void out_trash(void);
+void free_out_buf(void);
 void out_char(unsigned c);
 void out_str_nf(char_u *s);
 void out_str_cf(char_u *s);
 void out_str(char_u *s);
 void term_windgoto(int row, int col);
 void term_cursor_right(int i);
+int term_goto_len(int row, int col, int right);
 void term_append_lines(int line_count);
 void term_delete_lines(int line_count);
 void term_enable_mouse(int enable);
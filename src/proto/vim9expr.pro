@@ -1,7 +1,7 @@
 /* vim9expr.c */
 int generate_ppconst(cctx_T *cctx, ppconst_T *ppconst);
 void clear_ppconst(ppconst_T *ppconst);
-int compile_member(int is_slice, int *keeping_dict, cctx_T *cctx);
+int compile_member(int is_slice, int *keeping_dict, varnumber_T *const_index, cctx_T *cctx);
 int compile_load_scriptvar(cctx_T *cctx, char_u *name, char_u *start, char_u **end, imported_T *import);
 int compile_load(char_u **arg, size_t namelen, char_u *end_arg, cctx_T *cctx, int is_expr, int error);
 int compile_arguments(char_u **arg, cctx_T *cctx, int *argcount, ca_special_T special_fn);
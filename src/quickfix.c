@@ -6654,6 +6654,363 @@ existing_swapfile(buf_T *buf)
     return FALSE;
 }
 
+#ifdef USE_VIMGREP_THREADS
+/*
+ * While ":vimgrep" loads and searches the files one by one, threads read the
+ * files further down the list and look for the literal text that every match
+ * of the pattern must contain.  A file without that text is not loaded.
+ * The threads only use system calls and their own memory, the regexp engine
+ * and the buffer code are only used by the main thread.
+ */
+# define VGR_MAX_THREADS    4
+# define VGR_READ_SIZE	    65536
+
+// Values for vs_state[].
+# define VGR_ST_TODO	    0	// not looked at yet
+# define VGR_ST_BUSY	    1	// a thread is reading the file
+# define VGR_ST_LOAD	    2	// must be loaded and searched
+# define VGR_ST_SKIP	    3	// cannot contain a match
+
+typedef struct
+{
+    pthread_mutex_t vs_mutex;
+    pthread_cond_t  vs_cond;	// signalled when a file was looked at
+    char_u	**vs_fnames;	// file names, not owned
+    char_u	*vs_state;	// VGR_ST_ value for each file
+    int		vs_fcount;	// number of files
+    int		vs_next;	// next file for a thread to look at
+    int		vs_cancel;	// when TRUE the threads stop
+    char_u	*vs_dir;	// directory for relative file names
+    char_u	*vs_must;	// text a match must contain
+    int		vs_mustlen;	// length of vs_must
+    int		vs_ic;		// ignore case, vs_must is lower case
+    int		vs_nthreads;	// number of threads started
+    pthread_t	vs_threads[VGR_MAX_THREADS];
+} vgr_scan_T;
+
+// Autocommands in these groups don't change the text of a file.
+static char *vgr_harmless_augroups[] = {"filetypedetect", "vimStartup", NULL};
+
+/*
+ * Return TRUE if the "len" bytes at "p" contain the text "vs->vs_must".
+ * When ignoring case a non-ASCII byte also counts, it might be part of a
+ * character that folds to an ASCII letter.
+ */
+    static int
+vgr_scan_match(vgr_scan_T *vs, char_u *p, long len)
+{
+    long    last = len - vs->vs_mustlen;
+    long    i;
+    int	    j;
+    char_u  *s;
+
+    if (!vs->vs_ic)
+    {
+	for (i = 0; i <= last; ++i)
+	{
+	    s = memchr(p + i, vs->vs_must[0], (size_t)(last - i + 1));
+	    if (s == NULL)
+		break;
+	    if (memcmp(s, vs->vs_must, (size_t)vs->vs_mustlen) == 0)
+		return TRUE;
+	    i = (long)(s - p);
+	}
+	return FALSE;
+    }
+
+    for (i = 0; i < len; ++i)
+	if (p[i] >= 0x80)
+	    return TRUE;
+    for (i = 0; i <= last; ++i)
+    {
+	for (j = 0; j < vs->vs_mustlen
+			&& TOLOWER_ASC(p[i + j]) == vs->vs_must[j]; ++j)
+	    ;
+	if (j == vs->vs_mustlen)
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Read file "fname" and check whether it may contain a match.
+ * "buf" has room for VGR_READ_SIZE + vs_mustlen bytes.
+ * Returns VGR_ST_SKIP or VGR_ST_LOAD.  Runs in a vimgrep thread.
+ */
+    static int
+vgr_scan_file(vgr_scan_T *vs, char_u *fname, char_u *buf)
+{
+    char_u	path[MAXPATHL];
+    size_t	dirlen = STRLEN(vs->vs_dir);
+    int		fd;
+    struct stat	st;
+    long	have = 0;
+    long	len;
+    int		keep = vs->vs_mustlen - 1;
+    int		first = TRUE;
+    int		result = VGR_ST_LOAD;
+    int		cancel;
+
+    if (*fname != '/')
+    {
+	if (dirlen + STRLEN(fname) + 2 > MAXPATHL)
+	    return VGR_ST_LOAD;
+	STRCPY(path, vs->vs_dir);
+	if (dirlen == 0 || path[dirlen - 1] != '/')
+	    path[dirlen++] = '/';
+	STRCPY(path + dirlen, fname);
+	fname = path;
+    }
+
+    fd = open((char *)fname, O_RDONLY | O_EXTRA, 0);
+    if (fd < 0)
+	return VGR_ST_LOAD;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+	for (;;)
+	{
+	    len = read(fd, buf + have, VGR_READ_SIZE);
+	    if (len < 0)
+		break;
+	    if (len == 0)
+	    {
+		result = VGR_ST_SKIP;
+		break;
+	    }
+	    // Text in UTF-16 or UTF-32 or encrypted text is converted when
+	    // the file is loaded.
+	    if (first && (buf[0] == 0xfe || buf[0] == 0xff
+			|| (len >= 4 && memcmp(buf, "\000\000\376\377", 4) == 0)
+			|| (len >= 9 && memcmp(buf, "VimCrypt~", 9) == 0)))
+		break;
+	    first = FALSE;
+	    len += have;
+	    if (vgr_scan_match(vs, buf, len))
+		break;
+
+	    // Keep the end, the text may continue in the next block.
+	    have = len < keep ? len : keep;
+	    mch_memmove(buf, buf + len - have, (size_t)have);
+
+	    pthread_mutex_lock(&vs->vs_mutex);
+	    cancel = vs->vs_cancel;
+	    pthread_mutex_unlock(&vs->vs_mutex);
+	    if (cancel)
+		break;
+	}
+    }
+    close(fd);
+    return result;
+}
+
+/*
+ * Function run by a vimgrep thread: look at the files that nobody looked at
+ * yet, in order, until all are done or the threads are cancelled.
+ */
+    static void *
+vgr_scan_thread(void *arg)
+{
+    vgr_scan_T	*vs = arg;
+    char_u	*buf;
+    int		fi;
+    int		state;
+
+    // Don't use alloc(), it is not thread safe.
+    buf = malloc(VGR_READ_SIZE + vs->vs_mustlen);
+
+    pthread_mutex_lock(&vs->vs_mutex);
+    while (!vs->vs_cancel)
+    {
+	while (vs->vs_next < vs->vs_fcount
+				   && vs->vs_state[vs->vs_next] != VGR_ST_TODO)
+	    ++vs->vs_next;
+	if (vs->vs_next >= vs->vs_fcount)
+	    break;
+	fi = vs->vs_next++;
+	vs->vs_state[fi] = VGR_ST_BUSY;
+	pthread_mutex_unlock(&vs->vs_mutex);
+
+	state = buf == NULL ? VGR_ST_LOAD
+			       : vgr_scan_file(vs, vs->vs_fnames[fi], buf);
+
+	pthread_mutex_lock(&vs->vs_mutex);
+	vs->vs_state[fi] = state;
+	pthread_cond_broadcast(&vs->vs_cond);
+    }
+    pthread_mutex_unlock(&vs->vs_mutex);
+
+    free(buf);
+    return NULL;
+}
+
+/*
+ * Return TRUE when a file that does not contain the bytes of an ASCII text
+ * can't contain that text after it was loaded.  That is so when the file is
+ * not converted or converted from latin1 to UTF-8.
+ */
+    static int
+vgr_fencs_keep_ascii(void)
+{
+    char_u	*p = p_fencs;
+    char_u	name[50];
+    char_u	*enc;
+    int		ok = TRUE;
+
+    if (!enc_utf8)
+	return FALSE;
+    while (ok && *p != NUL)
+    {
+	copy_option_part(&p, name, sizeof(name), ",");
+	enc = enc_canonize(name);
+	if (enc == NULL)
+	    return FALSE;
+	ok = STRCMP(enc, "ucs-bom") == 0 || STRCMP(enc, "utf-8") == 0
+						|| STRCMP(enc, "latin1") == 0;
+	vim_free(enc);
+    }
+    return ok;
+}
+
+/*
+ * Start the threads that find out which files can't match the pattern.
+ * Returns FAIL when that isn't possible, the files are then all loaded.
+ */
+    static int
+vgr_scan_start(vgr_scan_T *vs, vgr_args_T *args, char_u *dirname_start)
+{
+    char_u	*pat = args->spat;
+    char_u	*p;
+    long	ncpu;
+    sigset_t	all_sigs, old_sigs;
+
+    CLEAR_POINTER(vs);
+    if (args->fcount < 2 || (args->flags & VGR_FUZZY)
+						    || !vgr_fencs_keep_ascii())
+	return FAIL;
+
+    if (pat == NULL || *pat == NUL)
+	pat = last_search_pat();
+    if (pat == NULL)
+	return FAIL;
+    vs->vs_ic = args->regmatch.rmm_ic;
+    vs->vs_must = vim_regmust(pat, RE_MAGIC, &vs->vs_ic);
+    if (vs->vs_must == NULL)
+	return FAIL;
+
+    // Only plain printable ASCII is found in the file as-is.
+    for (p = vs->vs_must; *p != NUL; ++p)
+    {
+	if (*p < ' ' || *p > '~')
+	    break;
+	if (vs->vs_ic)
+	    *p = TOLOWER_ASC(*p);
+    }
+    vs->vs_mustlen = (int)(p - vs->vs_must);
+    vs->vs_dir = vim_strsave(dirname_start);
+    vs->vs_state = alloc_clear(args->fcount);
+    if (*p != NUL || vs->vs_mustlen == 0 || vs->vs_dir == NULL
+						      || vs->vs_state == NULL)
+    {
+	VIM_CLEAR(vs->vs_must);
+	VIM_CLEAR(vs->vs_dir);
+	VIM_CLEAR(vs->vs_state);
+	return FAIL;
+    }
+    vs->vs_fnames = args->fnames;
+    vs->vs_fcount = args->fcount;
+    pthread_mutex_init(&vs->vs_mutex, NULL);
+    pthread_cond_init(&vs->vs_cond, NULL);
+
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu > VGR_MAX_THREADS)
+	ncpu = VGR_MAX_THREADS;
+
+    // The threads must not handle any signals, block them while they are
+    // created so that they inherit that.
+    sigfillset(&all_sigs);
+    pthread_sigmask(SIG_SETMASK, &all_sigs, &old_sigs);
+    do
+    {
+	if (pthread_create(&vs->vs_threads[vs->vs_nthreads], NULL,
+						     vgr_scan_thread, vs) != 0)
+	    break;
+	++vs->vs_nthreads;
+    } while (vs->vs_nthreads < ncpu);
+    pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+
+    if (vs->vs_nthreads == 0)
+    {
+	pthread_cond_destroy(&vs->vs_cond);
+	pthread_mutex_destroy(&vs->vs_mutex);
+	VIM_CLEAR(vs->vs_must);
+	VIM_CLEAR(vs->vs_dir);
+	VIM_CLEAR(vs->vs_state);
+	return FAIL;
+    }
+    return OK;
+}
+
+/*
+ * Return TRUE if file "fi" doesn't need to be loaded, because it can't
+ * contain a match.  Waits for a thread that is reading the file.
+ */
+    static int
+vgr_scan_skip(vgr_scan_T *vs, int fi)
+{
+    static event_T events[] = {EVENT_BUFREADCMD, EVENT_BUFREADPRE,
+			       EVENT_BUFREADPOST, EVENT_SWAPEXISTS,
+			       EVENT_BUFUNLOAD, EVENT_BUFDELETE,
+			       EVENT_BUFWIPEOUT};
+    int		i;
+    int		state;
+
+    if (vs->vs_nthreads == 0)
+	return FALSE;
+
+    // Autocommands might change the text or need to be triggered.
+    for (i = 0; i < (int)ARRAY_LENGTH(events); ++i)
+	if (has_autocmd_except(events[i], vs->vs_fnames[fi], NULL,
+						      vgr_harmless_augroups))
+	    return FALSE;
+
+    pthread_mutex_lock(&vs->vs_mutex);
+    // When no thread took this file yet, mark it to be loaded.
+    if (vs->vs_state[fi] == VGR_ST_TODO)
+	vs->vs_state[fi] = VGR_ST_LOAD;
+    while (vs->vs_state[fi] == VGR_ST_BUSY)
+	pthread_cond_wait(&vs->vs_cond, &vs->vs_mutex);
+    state = vs->vs_state[fi];
+    pthread_mutex_unlock(&vs->vs_mutex);
+
+    return state == VGR_ST_SKIP;
+}
+
+/*
+ * Stop the vimgrep threads and free the memory.
+ */
+    static void
+vgr_scan_stop(vgr_scan_T *vs)
+{
+    int	    i;
+
+    if (vs->vs_nthreads == 0)
+	return;
+
+    pthread_mutex_lock(&vs->vs_mutex);
+    vs->vs_cancel = TRUE;
+    pthread_mutex_unlock(&vs->vs_mutex);
+    for (i = 0; i < vs->vs_nthreads; ++i)
+	pthread_join(vs->vs_threads[i], NULL);
+    vs->vs_nthreads = 0;
+
+    pthread_cond_destroy(&vs->vs_cond);
+    pthread_mutex_destroy(&vs->vs_mutex);
+    VIM_CLEAR(vs->vs_must);
+    VIM_CLEAR(vs->vs_dir);
+    VIM_CLEAR(vs->vs_state);
+}
+#endif
+
 /*
  * Search for a pattern in a list of files and populate the quickfix list with
  * the matches.
@@ -6679,6 +7036,11 @@ vgr_process_files(
     char_u	*dirname_now = NULL;
     int		found_match;
     aco_save_T	aco;
+#ifdef USE_VIMGREP_THREADS
+    vgr_scan_T	scan;
+
+    scan.vs_nthreads = 0;
+#endif
 
     dirname_start = alloc_id(MAXPATHL, aid_qf_dirname_start);
     dirname_now = alloc_id(MAXPATHL, aid_qf_dirname_now);
@@ -6689,6 +7051,11 @@ vgr_process_files(
     // ":lcd %:p:h" changes the meaning of short path names.
     mch_dirname(dirname_start, MAXPATHL);
 
+#ifdef USE_VIMGREP_THREADS
+    // Find out in the background which files can't match.
+    (void)vgr_scan_start(&scan, cmd_args, dirname_start);
+#endif
+
     seconds = (time_t)0;
     for (fi = 0; fi < cmd_args->fcount && !got_int && cmd_args->tomatch > 0;
 									++fi)
@@ -6703,6 +7070,12 @@ vgr_process_files(
 	}
 
 	buf = buflist_findname_exp(cmd_args->fnames[fi]);
+#ifdef USE_VIMGREP_THREADS
+	// No need to load a file without a match.
+	if ((buf == NULL || buf->b_ml.ml_mfp == NULL)
+						    && vgr_scan_skip(&scan, fi))
+	    continue;
+#endif
 	if (buf == NULL || buf->b_ml.ml_mfp == NULL)
 	{
 	    // Remember that a buffer with this name already exists.
@@ -6808,6 +7181,9 @@ vgr_process_files(
     status = OK;
 
 theend:
+#ifdef USE_VIMGREP_THREADS
+    vgr_scan_stop(&scan);
+#endif
     vim_free(dirname_now);
     vim_free(dirname_start);
     return status;
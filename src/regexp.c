@@ -349,6 +349,7 @@ init_class_tab(void)
 #define RF_HASNL    4	// can match a NL
 #define RF_ICOMBINE 8	// ignore combining characters
 #define RF_LOOKBH   16	// uses "\@<=" or "\@<!"
+#define RF_HADEOL   32	// had_eol was set when compiling
 
 /*
  * Global work variables for vim_regcomp().
@@ -2915,6 +2916,120 @@ static char_u regname[][30] = {
 			    };
 #endif
 
+/*
+ * Cache of compiled patterns.  The same pattern is often compiled again and
+ * again, e.g. by substitute() in a loop or "=~" in a function.  A program
+ * freed with vim_regfree() is kept here and vim_regcomp() takes it out again
+ * when the same pattern is compiled with the same flags and options.
+ * A program is never shared, it holds state while matching.
+ */
+#define REGCACHE_SIZE	30
+
+static regprog_T    *regcache[REGCACHE_SIZE];	// most recently used first
+static int	    regcache_len = 0;
+static long	    regcache_hits = 0;
+static long	    regcache_misses = 0;
+
+/*
+ * Return the options, other than the flags passed to vim_regcomp(), that a
+ * compiled program depends on.
+ */
+    static int
+regcache_opts(void)
+{
+    return p_re
+	    + (vim_strchr(p_cpo, CPO_LITERAL) != NULL ? 4 : 0)
+	    + (vim_strchr(p_cpo, CPO_BACKSL) != NULL ? 8 : 0)
+	    + (reg_do_extmatch << 4);
+}
+
+/*
+ * Return TRUE when the program for "expr" may be cached.
+ */
+    static int
+regcache_usable(char_u *expr)
+{
+    return vim_strchr(expr, '~') == NULL && strstr((char *)expr, "[:") == NULL;
+}
+
+/*
+ * Take the program for pattern "expr" out of the cache.
+ * Returns NULL when it is not there.
+ */
+    static regprog_T *
+regcache_get(char_u *expr, int re_flags, int opts)
+{
+    int		i;
+    regprog_T	*prog;
+
+    for (i = 0; i < regcache_len; ++i)
+    {
+	prog = regcache[i];
+	if (prog->re_flags == (unsigned)re_flags
+		&& prog->re_cache_opts == opts
+		&& STRCMP(prog->re_pattern, expr) == 0)
+	{
+	    --regcache_len;
+	    mch_memmove(regcache + i, regcache + i + 1,
+				     (regcache_len - i) * sizeof(regprog_T *));
+	    ++regcache_hits;
+	    return prog;
+	}
+    }
+    ++regcache_misses;
+    return NULL;
+}
+
+/*
+ * Really free a compiled program.
+ */
+    static void
+regprog_free(regprog_T *prog)
+{
+    vim_free(prog->re_pattern);
+    prog->engine->regfree(prog);
+}
+
+/*
+ * Add "prog" to the cache.  When it is full the least recently used program
+ * is freed.
+ */
+    static void
+regcache_add(regprog_T *prog)
+{
+    if (regcache_len == REGCACHE_SIZE)
+	regprog_free(regcache[--regcache_len]);
+    mch_memmove(regcache + 1, regcache, regcache_len * sizeof(regprog_T *));
+    regcache[0] = prog;
+    ++regcache_len;
+}
+
+/*
+ * Free all programs in the cache.  Used when 'encoding' changes.
+ */
+    void
+regcache_clear(void)
+{
+    while (regcache_len > 0)
+	regprog_free(regcache[--regcache_len]);
+}
+
+#if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * "regexpcacheinfo()" function
+ */
+    void
+f_regexpcacheinfo(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    if (rettv_dict_alloc(rettv) == FAIL)
+	return;
+    dict_add_number(rettv->vval.v_dict, "hits", regcache_hits);
+    dict_add_number(rettv->vval.v_dict, "misses", regcache_misses);
+    dict_add_number(rettv->vval.v_dict, "count", regcache_len);
+    dict_add_number(rettv->vval.v_dict, "size", REGCACHE_SIZE);
+}
+#endif
+
 /*
  * Compile a regular expression into internal code.
  * Returns the program in allocated memory.
@@ -2927,6 +3042,20 @@ vim_regcomp(char_u *expr_arg, int re_flags)
     regprog_T   *prog = NULL;
     char_u	*expr = expr_arg;
     int		called_emsg_before;
+    int		called_emsg_start = called_emsg;
+    int		cache_opts = regcache_opts();
+
+    // A pattern with "~" depends on the previous substitute string, the
+    // backtracking engine uses the options for "[:keyword:]" when compiling.
+    if (regcache_usable(expr))
+    {
+	prog = regcache_get(expr, re_flags, cache_opts);
+	if (prog != NULL)
+	{
+	    had_eol = (prog->regflags & RF_HADEOL) != 0;
+	    return prog;
+	}
+    }
 
     regexp_engine = p_re;
 
@@ -3010,6 +3139,13 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 	// out to be very slow when executing it.
 	prog->re_engine = regexp_engine;
 	prog->re_flags  = re_flags;
+
+	// Remember the pattern for the cache, unless a message was given.
+	prog->re_cache_opts = cache_opts;
+	if (had_eol)
+	    prog->regflags |= RF_HADEOL;
+	if (regcache_usable(expr_arg) && called_emsg == called_emsg_start)
+	    prog->re_pattern = vim_strsave(expr_arg);
     }
 
     return prog;
@@ -3017,18 +3153,83 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 
 /*
  * Free a compiled regexp program, returned by vim_regcomp().
+ * It is kept in the cache for when the same pattern is compiled again.
  */
     void
 vim_regfree(regprog_T *prog)
 {
-    if (prog != NULL)
-	prog->engine->regfree(prog);
+    if (prog == NULL)
+	return;
+    if (prog->re_pattern != NULL && !prog->re_in_use)
+	regcache_add(prog);
+    else
+	regprog_free(prog);
+}
+
+#if defined(FEAT_QUICKFIX) || defined(PROTO)
+/*
+ * Find the longest literal string that every match of pattern "expr" must
+ * contain.  Only the text outside of alternatives and multis is used, thus
+ * "foo\(bar\)*" gives "foo".  Lines that do not contain the string can't
+ * match.
+ * "*icp" is set to TRUE when the pattern contains "\c" and to FALSE when it
+ * contains "\C".  It is not changed otherwise.
+ * Returns the string in allocated memory, NULL when there is none or it
+ * can't be used, e.g. because the pattern contains "\Z".
+ */
+    char_u *
+vim_regmust(char_u *expr, int re_flags, int *icp)
+{
+    bt_regprog_T    *prog;
+    char_u	    *scan;
+    char_u	    *longest = NULL;
+    size_t	    len = 0;
+    char_u	    *res = NULL;
+
+    if (STRNCMP(expr, "\\%#=", 4) == 0)
+    {
+	if (expr[4] < '0' || expr[4] > '2')
+	    return NULL;
+	expr += 5;
+    }
+
+    // Always use the backtracking engine, its program is easy to inspect.
+    // The pattern was already compiled, don't give an error twice.
+    rex.reg_buf = curbuf;
+    ++emsg_off;
+    prog = (bt_regprog_T *)bt_regengine.regcomp(expr, re_flags);
+    --emsg_off;
+    if (prog == NULL)
+	return NULL;
+
+    scan = prog->program + 1;	// First BRANCH.
+    if (OP(regnext(scan)) == END)   // Only one top-level choice.
+    {
+	for (scan = OPERAND(scan); scan != NULL; scan = regnext(scan))
+	    if (OP(scan) == EXACTLY && STRLEN(OPERAND(scan)) > len)
+	    {
+		longest = OPERAND(scan);
+		len = STRLEN(longest);
+	    }
+    }
+
+    if (prog->regflags & RF_ICASE)
+	*icp = TRUE;
+    else if (prog->regflags & RF_NOICASE)
+	*icp = FALSE;
+    if (longest != NULL && !(prog->regflags & RF_ICOMBINE))
+	res = vim_strnsave(longest, len);
+
+    vim_regfree((regprog_T *)prog);
+    return res;
 }
+#endif
 
 #if defined(EXITFREE)
     void
 free_regexp_stuff(void)
 {
+    regcache_clear();
     ga_clear(&regstack);
     ga_clear(&backpos);
     vim_free(reg_tofree);
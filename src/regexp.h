@@ -53,6 +53,8 @@ typedef struct regprog
     unsigned		re_engine;   // automatic, backtracking or nfa engine
     unsigned		re_flags;    // second argument for vim_regcomp()
     int			re_in_use;   // prog is being executed
+    char_u		*re_pattern; // pattern for the regprog cache or NULL
+    int			re_cache_opts; // options the prog was compiled with
 } regprog_T;
 
 /*
@@ -68,6 +70,8 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    char_u		*re_pattern;
+    int			re_cache_opts;
 
     int			regstart;
     char_u		reganch;
@@ -105,12 +109,17 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    char_u		*re_pattern;
+    int			re_cache_opts;
 
     nfa_state_T		*start;		// points into state[]
 
     int			reganch;	// pattern starts with ^
     int			regstart;	// char at start of pattern
     char_u		*match_text;	// plain text to match with
+    char_u		*regmust;	// text that every match contains
+    int			regmust_ascii;	// "regmust" only has ASCII
+    struct nfa_dfa_S	*dfa;		// lazily built DFA, NULL until used
 
     int			has_zend;	// pattern contains \ze
     int			has_backref;	// pattern contains \1 .. \9
@@ -2497,6 +2497,7 @@ bt_regcomp(char_u *expr, int re_flags)
     if (r == NULL)
 	return NULL;
     r->re_in_use = FALSE;
+    r->re_pattern = NULL;
 
     // Second pass: emit code.
     regcomp_start(expr, re_flags);
@@ -504,6 +504,274 @@ nfa_get_match_text(nfa_state_T *start)
     return ret;
 }
 
+/*
+ * Literal text in a part of the pattern, used by nfa_get_regmust().
+ */
+typedef struct
+{
+    garray_T	rl_pre;	    // text that every match of the part starts with
+    garray_T	rl_suf;	    // text that every match of the part ends with
+    garray_T	rl_must;    // longest text that every match contains
+    int		rl_exact;   // the part only matches "rl_pre", which is equal
+			    // to "rl_suf" and "rl_must"
+} reglit_T;
+
+/*
+ * Set "rl" to a part of the pattern without known text.  When "exact" is TRUE
+ * the part matches without any text, such as "\<".
+ */
+    static void
+reglit_unknown(reglit_T *rl, int exact)
+{
+    rl->rl_pre.ga_len = 0;
+    rl->rl_suf.ga_len = 0;
+    rl->rl_must.ga_len = 0;
+    rl->rl_exact = exact;
+}
+
+/*
+ * Replace the top "n" of the "*spp" items of "stack" with one part without
+ * known text.  "exact" is passed to reglit_unknown().
+ * Returns FAIL when there are less than "n" items.
+ */
+    static int
+reglit_replace(reglit_T *stack, int *spp, int n, int exact)
+{
+    if (*spp < n)
+	return FAIL;
+    *spp -= n;
+    reglit_unknown(&stack[(*spp)++], exact);
+    return OK;
+}
+
+/*
+ * Append "len" bytes at "p" to "gap".
+ */
+    static void
+reglit_append(garray_T *gap, char_u *p, int len)
+{
+    if (len > 0 && ga_grow(gap, len) == OK)
+    {
+	mch_memmove((char_u *)gap->ga_data + gap->ga_len, p, (size_t)len);
+	gap->ga_len += len;
+    }
+}
+
+/*
+ * Concatenate parts "a" and "b" of the pattern, the result goes in "a".
+ */
+    static void
+reglit_concat(reglit_T *a, reglit_T *b)
+{
+    garray_T	join;
+
+    // Text that spans both parts: the end of "a" and the start of "b".
+    ga_init2(&join, 1, 40);
+    reglit_append(&join, a->rl_suf.ga_data, a->rl_suf.ga_len);
+    reglit_append(&join, b->rl_pre.ga_data, b->rl_pre.ga_len);
+
+    if (a->rl_exact)
+    {
+	a->rl_pre.ga_len = 0;
+	reglit_append(&a->rl_pre, join.ga_data, join.ga_len);
+    }
+    if (b->rl_exact)
+	reglit_append(&a->rl_suf, b->rl_suf.ga_data, b->rl_suf.ga_len);
+    else
+    {
+	a->rl_suf.ga_len = 0;
+	reglit_append(&a->rl_suf, b->rl_suf.ga_data, b->rl_suf.ga_len);
+    }
+
+    if (b->rl_must.ga_len > a->rl_must.ga_len)
+    {
+	a->rl_must.ga_len = 0;
+	reglit_append(&a->rl_must, b->rl_must.ga_data, b->rl_must.ga_len);
+    }
+    if (join.ga_len > a->rl_must.ga_len)
+    {
+	a->rl_must.ga_len = 0;
+	reglit_append(&a->rl_must, join.ga_data, join.ga_len);
+    }
+    a->rl_exact = a->rl_exact && b->rl_exact;
+    ga_clear(&join);
+}
+
+/*
+ * Find the longest literal text that every match of the pattern must contain,
+ * using the postfix form of the pattern from "postfix" to "end".
+ * Returns the text in allocated memory, NULL when there is none or when the
+ * pattern can match a line break, then the text may be in another line.
+ */
+    static char_u *
+nfa_get_regmust(int *postfix, int *end)
+{
+    reglit_T	*stack;
+    int		size = (int)(end - postfix) + 1;
+    int		sp = 0;
+    int		i;
+    int		*p;
+    int		ok = TRUE;
+    char_u	*ret = NULL;
+    char_u	buf[MB_MAXBYTES + 1];
+    int		len;
+
+    stack = ALLOC_CLEAR_MULT(reglit_T, size);
+    if (stack == NULL)
+	return NULL;
+    for (i = 0; i < size; ++i)
+    {
+	ga_init2(&stack[i].rl_pre, 1, 40);
+	ga_init2(&stack[i].rl_suf, 1, 40);
+	ga_init2(&stack[i].rl_must, 1, 40);
+    }
+
+    for (p = postfix; p < end && ok; ++p)
+    {
+	switch (*p)
+	{
+	    case NFA_CONCAT:
+		if (sp < 2)
+		{
+		    ok = FALSE;
+		    break;
+		}
+		--sp;
+		reglit_concat(&stack[sp - 1], &stack[sp]);
+		break;
+
+	    case NFA_OR:
+	    case NFA_RANGE:
+		ok = reglit_replace(stack, &sp, 2, FALSE) == OK;
+		break;
+
+	    case NFA_STAR:
+	    case NFA_STAR_NONGREEDY:
+	    case NFA_QUEST:
+	    case NFA_QUEST_NONGREEDY:
+	    case NFA_END_COLL:
+	    case NFA_END_NEG_COLL:
+	    case NFA_COMPOSING:
+	    case NFA_PREV_ATOM_LIKE_PATTERN:
+		ok = reglit_replace(stack, &sp, 1, FALSE) == OK;
+		break;
+
+	    case NFA_PREV_ATOM_JUST_BEFORE:
+	    case NFA_PREV_ATOM_JUST_BEFORE_NEG:
+		++p;  // skip the count
+		// FALLTHROUGH
+	    case NFA_PREV_ATOM_NO_WIDTH:
+	    case NFA_PREV_ATOM_NO_WIDTH_NEG:
+		// Zero-width, the text it looks at is not part of the match.
+		ok = reglit_replace(stack, &sp, 1, TRUE) == OK;
+		break;
+
+	    case NFA_OPT_CHARS:
+		++p;
+		ok = reglit_replace(stack, &sp, *p, FALSE) == OK;
+		break;
+
+	    case NFA_MOPEN:
+	    case NFA_MOPEN1:
+	    case NFA_MOPEN2:
+	    case NFA_MOPEN3:
+	    case NFA_MOPEN4:
+	    case NFA_MOPEN5:
+	    case NFA_MOPEN6:
+	    case NFA_MOPEN7:
+	    case NFA_MOPEN8:
+	    case NFA_MOPEN9:
+#ifdef FEAT_SYN_HL
+	    case NFA_ZOPEN:
+	    case NFA_ZOPEN1:
+	    case NFA_ZOPEN2:
+	    case NFA_ZOPEN3:
+	    case NFA_ZOPEN4:
+	    case NFA_ZOPEN5:
+	    case NFA_ZOPEN6:
+	    case NFA_ZOPEN7:
+	    case NFA_ZOPEN8:
+	    case NFA_ZOPEN9:
+#endif
+	    case NFA_NOPEN:
+		// A group matches the same text as what is inside it.  An
+		// empty group at the start matches nothing.
+		if (sp == 0)
+		    reglit_unknown(&stack[sp++], TRUE);
+		break;
+
+	    case NFA_LNUM:
+	    case NFA_LNUM_GT:
+	    case NFA_LNUM_LT:
+	    case NFA_VCOL:
+	    case NFA_VCOL_GT:
+	    case NFA_VCOL_LT:
+	    case NFA_COL:
+	    case NFA_COL_GT:
+	    case NFA_COL_LT:
+	    case NFA_MARK:
+	    case NFA_MARK_GT:
+	    case NFA_MARK_LT:
+		++p;  // skip the number
+		// FALLTHROUGH
+	    case NFA_BOL:
+	    case NFA_EOL:
+	    case NFA_BOF:
+	    case NFA_EOF:
+	    case NFA_BOW:
+	    case NFA_EOW:
+	    case NFA_ZSTART:
+	    case NFA_ZEND:
+	    case NFA_CURSOR:
+	    case NFA_VISUAL:
+	    case NFA_EMPTY:
+		reglit_unknown(&stack[sp++], TRUE);
+		break;
+
+	    case NFA_NEWL:
+		ok = FALSE;
+		break;
+
+	    default:
+		if (*p >= NFA_FIRST_NL && *p <= NFA_LAST_NL)
+		    ok = FALSE;
+		else if (*p > 0 && !(enc_utf8 && utf_iscomposing(*p)))
+		{
+		    // A plain character.
+		    if (has_mbyte)
+			len = (*mb_char2bytes)(*p, buf);
+		    else
+		    {
+			buf[0] = *p;
+			len = 1;
+		    }
+		    reglit_unknown(&stack[sp], TRUE);
+		    reglit_append(&stack[sp].rl_pre, buf, len);
+		    reglit_append(&stack[sp].rl_suf, buf, len);
+		    reglit_append(&stack[sp].rl_must, buf, len);
+		    ++sp;
+		}
+		else
+		    reglit_unknown(&stack[sp++], FALSE);
+		break;
+	}
+	if (sp >= size)
+	    ok = FALSE;
+    }
+
+    if (ok && sp == 1 && stack[0].rl_must.ga_len > 0)
+	ret = vim_strnsave(stack[0].rl_must.ga_data, stack[0].rl_must.ga_len);
+
+    for (i = 0; i < size; ++i)
+    {
+	ga_clear(&stack[i].rl_pre);
+	ga_clear(&stack[i].rl_suf);
+	ga_clear(&stack[i].rl_must);
+    }
+    vim_free(stack);
+    return ret;
+}
+
 /*
  * Allocate more space for post_start.  Called when
  * running above the estimated number of states.
@@ -2930,6 +3198,8 @@ nfa_dump(nfa_regprog_T *prog)
 		prog->regstart, prog->regstart);
     if (prog->match_text != NULL)
 	fprintf(debugf, "match_text: \"%s\"\n", prog->match_text);
+    if (prog->regmust != NULL)
+	fprintf(debugf, "regmust: \"%s\"\n", prog->regmust);
 
     fclose(debugf);
 }
@@ -5654,6 +5924,42 @@ skip_to_start(int c, colnr_T *colp)
     return OK;
 }
 
+/*
+ * Return TRUE if "s" does not contain "prog->regmust", thus there can't be a
+ * match.  When ignoring case a line with non-ASCII text is always tried, a
+ * character might fold to an ASCII letter.
+ */
+    static int
+regmust_missing(nfa_regprog_T *prog, char_u *s)
+{
+    char_u  *must = prog->regmust;
+    int	    c;
+    int	    i;
+
+    if (rex.reg_icombine)
+	return FALSE;
+    if (!rex.reg_ic)
+	return strstr((char *)s, (char *)must) == NULL;
+
+    if (!prog->regmust_ascii)
+	return FALSE;
+    c = TOLOWER_ASC(*must);
+    for ( ; *s != NUL; ++s)
+    {
+	if (*s >= 0x80)
+	    return FALSE;
+	if (TOLOWER_ASC(*s) == c)
+	{
+	    for (i = 1; must[i] != NUL
+				 && TOLOWER_ASC(s[i]) == TOLOWER_ASC(must[i]); ++i)
+		;
+	    if (must[i] == NUL)
+		return FALSE;
+	}
+    }
+    return TRUE;
+}
+
 /*
  * Check for a match with match_text.
  * Called after skip_to_start() has found regstart.
@@ -5720,6 +6026,640 @@ find_match_text(colnr_T *startcol, int regstart, char_u *match_text)
     return 0L;
 }
 
+/*
+ * Lazily built DFA.
+ *
+ * Simulating the NFA means keeping a list of states for every position in the
+ * text, which is slow for a pattern with many states.  When the pattern has
+ * no back references the set of NFA states that can be active at a position
+ * can be turned into one DFA state.  These are only computed when they are
+ * needed and then cached, so that moving to the next character is mostly one
+ * lookup in a table indexed with the character class of the byte.
+ *
+ * The DFA only tells whether a line may contain a match.  What it can't check
+ * (look-around, \%V, \< and \>, text in the next line, composing characters)
+ * is assumed to match, thus when the DFA says there is no match that is
+ * correct and the NFA doesn't need to run.  Otherwise the NFA finds the match
+ * and the submatches as before.
+ */
+#define DFA_MAX_STATES	500	// maximum number of cached DFA states
+#define DFA_MAX_MEM	200000L	// maximum memory used for cached states
+#define DFA_MAX_FLUSHES	5	// give up after flushing the cache this often
+#define DFA_HASH_SIZE	64	// must be a power of two
+
+// Values for ds_flags.
+#define DS_MATCH	1	// a match may end here
+#define DS_MATCH_EOL	2	// a match may end here at the end of the line
+#define DS_DEAD		4	// no match is possible from here
+
+// NFA states that consume a character.
+#define DFA_CONSUMES(c) ((c) > 0 || ((c) >= NFA_ANY && (c) <= NFA_NUPPER_IC) \
+			|| (c) == NFA_START_COLL || (c) == NFA_START_NEG_COLL)
+
+typedef struct nfa_dstate_S nfa_dstate_T;
+struct nfa_dstate_S
+{
+    nfa_dstate_T    *ds_hashnext;   // next state with the same hash
+    nfa_dstate_T    **ds_next;	    // next state for each character class,
+				    // NULL when not computed yet
+    unsigned	    ds_hash;
+    int		    ds_flags;	    // DS_ flags
+    int		    ds_len;	    // number of items in ds_states[]
+    int		    ds_states[1];   // NFA state numbers, actually longer
+};
+
+typedef struct nfa_dfa_S
+{
+    int		    dfa_disabled;	// pattern not supported or cache
+					// flushed too often
+    int		    dfa_optclass;	// pattern uses \i, \k, \f or \p
+
+    // Values the cached states were computed for.
+    int		    dfa_ic;
+    int		    dfa_utf8;
+    unsigned	    dfa_cmp_flags;
+    int		    dfa_chartab_tick;
+    char_u	    dfa_chartab[32];	// copy of b_chartab[]
+
+    int		    dfa_nclass;		// number of character classes, zero
+					// when not computed yet
+    char_u	    dfa_class[256];	// character class of each byte
+    nfa_dstate_T    *dfa_start[2];	// start state in column zero and after
+    nfa_dstate_T    *dfa_hash[DFA_HASH_SIZE];
+    int		    dfa_nstates;	// number of cached states
+    long	    dfa_mem;		// memory used by cached states
+    int		    dfa_flushes;
+
+    // Used while computing a state.
+    int		    *dfa_list;		// NFA state numbers
+    int		    dfa_listlen;
+    int		    dfa_flags;
+    int		    *dfa_gen_mark;	// "dfa_gen" when NFA state was added
+    int		    dfa_gen;
+} nfa_dfa_T;
+
+/*
+ * Return TRUE when the DFA can handle NFA state with code "c".
+ */
+    static int
+dfa_supported_state(int c)
+{
+    if (c > 0
+	    || (c >= NFA_MOPEN && c <= NFA_MCLOSE9)
+#ifdef FEAT_SYN_HL
+	    || (c >= NFA_ZOPEN && c <= NFA_ZCLOSE9)
+#endif
+	    || (c >= NFA_ANY && c <= NFA_NUPPER_IC)
+	    || (c >= NFA_CURSOR && c <= NFA_CLASS_FNAME)
+	    || (c >= NFA_START_INVISIBLE
+				  && c <= NFA_START_INVISIBLE_BEFORE_NEG_FIRST))
+	return TRUE;
+
+    switch (c)
+    {
+	case NFA_SPLIT:
+	case NFA_MATCH:
+	case NFA_EMPTY:
+	case NFA_START_COLL:
+	case NFA_END_COLL:
+	case NFA_START_NEG_COLL:
+	case NFA_RANGE_MIN:
+	case NFA_RANGE_MAX:
+	case NFA_BOL:
+	case NFA_EOL:
+	case NFA_BOW:
+	case NFA_EOW:
+	case NFA_BOF:
+	case NFA_EOF:
+	case NFA_NEWL:
+	case NFA_ZSTART:
+	case NFA_ZEND:
+	case NFA_NOPEN:
+	case NFA_NCLOSE:
+	case NFA_END_INVISIBLE:
+	case NFA_END_INVISIBLE_NEG:
+	case NFA_ANY_COMPOSING:
+	    return TRUE;
+    }
+    // back references, \@>, composing characters, etc.
+    return FALSE;
+}
+
+/*
+ * Return TRUE if the collection starting at "start" matches character "c".
+ * Like the NFA_START_COLL code in nfa_regmatch(), without composing
+ * characters.
+ */
+    static int
+dfa_match_coll(nfa_state_T *start, int c)
+{
+    nfa_state_T	*state = start->out;
+    int		result_if_matched = (start->c == NFA_START_COLL);
+    int		c1, c2;
+
+    for (;;)
+    {
+	if (state->c == NFA_END_COLL)
+	    return !result_if_matched;
+	if (state->c == NFA_RANGE_MIN)
+	{
+	    c1 = state->val;
+	    state = state->out; // advance to NFA_RANGE_MAX
+	    c2 = state->val;
+	    if (c >= c1 && c <= c2)
+		return result_if_matched;
+	    if (rex.reg_ic)
+	    {
+		int c_low = MB_CASEFOLD(c);
+
+		for ( ; c1 <= c2; ++c1)
+		    if (MB_CASEFOLD(c1) == c_low)
+			return result_if_matched;
+	    }
+	}
+	else if (state->c < 0 ? check_char_class(state->c, c)
+			   : (c == state->c
+			       || (rex.reg_ic
+				     && MB_CASEFOLD(c) == MB_CASEFOLD(state->c))))
+	    return result_if_matched;
+	state = state->out;
+    }
+}
+
+/*
+ * Return the state that follows NFA state "state" when it matches character
+ * "c" at "p".  Returns NULL if it doesn't match.
+ */
+    static nfa_state_T *
+dfa_match_char(nfa_state_T *state, int c, char_u *p)
+{
+    int	    result;
+
+    switch (state->c)
+    {
+	case NFA_EOL:
+	    return NULL;
+	case NFA_START_COLL:
+	case NFA_START_NEG_COLL:
+	    // next state is in out of the NFA_END_COLL
+	    return dfa_match_coll(state, c) ? state->out1->out : NULL;
+	case NFA_ANY:	    result = c > 0; break;
+	case NFA_IDENT:	    result = vim_isIDc(c); break;
+	case NFA_SIDENT:    result = !VIM_ISDIGIT(c) && vim_isIDc(c); break;
+	case NFA_KWORD:	    result = vim_iswordp_buf(p, rex.reg_buf); break;
+	case NFA_SKWORD:    result = !VIM_ISDIGIT(c)
+					  && vim_iswordp_buf(p, rex.reg_buf);
+			    break;
+	case NFA_FNAME:	    result = vim_isfilec(c); break;
+	case NFA_SFNAME:    result = !VIM_ISDIGIT(c) && vim_isfilec(c); break;
+	case NFA_PRINT:	    result = vim_isprintc(PTR2CHAR(p)); break;
+	case NFA_SPRINT:    result = !VIM_ISDIGIT(c)
+					       && vim_isprintc(PTR2CHAR(p));
+			    break;
+	case NFA_WHITE:	    result = VIM_ISWHITE(c); break;
+	case NFA_NWHITE:    result = !VIM_ISWHITE(c); break;
+	case NFA_DIGIT:	    result = ri_digit(c); break;
+	case NFA_NDIGIT:    result = !ri_digit(c); break;
+	case NFA_HEX:	    result = ri_hex(c); break;
+	case NFA_NHEX:	    result = !ri_hex(c); break;
+	case NFA_OCTAL:	    result = ri_octal(c); break;
+	case NFA_NOCTAL:    result = !ri_octal(c); break;
+	case NFA_WORD:	    result = ri_word(c); break;
+	case NFA_NWORD:	    result = !ri_word(c); break;
+	case NFA_HEAD:	    result = ri_head(c); break;
+	case NFA_NHEAD:	    result = !ri_head(c); break;
+	case NFA_ALPHA:	    result = ri_alpha(c); break;
+	case NFA_NALPHA:    result = !ri_alpha(c); break;
+	case NFA_LOWER:	    result = ri_lower(c); break;
+	case NFA_NLOWER:    result = !ri_lower(c); break;
+	case NFA_UPPER:	    result = ri_upper(c); break;
+	case NFA_NUPPER:    result = !ri_upper(c); break;
+	case NFA_LOWER_IC:  result = ri_lower(c)
+					       || (rex.reg_ic && ri_upper(c));
+			    break;
+	case NFA_NLOWER_IC: result = !(ri_lower(c)
+					      || (rex.reg_ic && ri_upper(c)));
+			    break;
+	case NFA_UPPER_IC:  result = ri_upper(c)
+					       || (rex.reg_ic && ri_lower(c));
+			    break;
+	case NFA_NUPPER_IC: result = !(ri_upper(c)
+					      || (rex.reg_ic && ri_lower(c)));
+			    break;
+	default:	    // regular character
+			    result = c == state->c || (rex.reg_ic
+				      && MB_CASEFOLD(c) == MB_CASEFOLD(state->c));
+			    break;
+    }
+    return result ? state->out : NULL;
+}
+
+/*
+ * Add NFA state "state" and the states that can be reached from it without
+ * consuming a character to the list in "dfa".
+ * "bol" is TRUE at the start of the line.  When "eol" is TRUE check for a
+ * match at the end of the line, only NFA_MATCH matters then.
+ */
+    static void
+dfa_addstate(
+    nfa_regprog_T   *prog,
+    nfa_dfa_T	    *dfa,
+    nfa_state_T	    *state,
+    int		    bol,
+    int		    eol)
+{
+    int	    c;
+    int	    idx;
+
+    for (;;)
+    {
+	idx = (int)(state - prog->state);
+	if (dfa->dfa_gen_mark[idx] == dfa->dfa_gen)
+	    return;
+	dfa->dfa_gen_mark[idx] = dfa->dfa_gen;
+
+	c = state->c;
+	if (c == NFA_MATCH || c == NFA_NEWL)
+	{
+	    // After a line break the NFA has to find out.
+	    dfa->dfa_flags |= DS_MATCH;
+	    return;
+	}
+	if (c == NFA_SPLIT)
+	{
+	    dfa_addstate(prog, dfa, state->out, bol, eol);
+	    state = state->out1;
+	}
+	else if (c == NFA_BOL)
+	{
+	    if (!bol)
+		return;
+	    state = state->out;
+	}
+	else if (c == NFA_EOL)
+	{
+	    if (!eol)
+	    {
+		// checked at the end of the line
+		dfa->dfa_list[dfa->dfa_listlen++] = idx;
+		return;
+	    }
+	    state = state->out;
+	}
+	else if (c >= NFA_START_INVISIBLE
+				  && c <= NFA_START_INVISIBLE_BEFORE_NEG_FIRST)
+	    // Skip over look-around, continue after NFA_END_INVISIBLE.
+	    state = state->out1->out;
+	else if (DFA_CONSUMES(c))
+	{
+	    if (!eol)
+		dfa->dfa_list[dfa->dfa_listlen++] = idx;
+	    return;
+	}
+	else
+	    // Other zero-width items are assumed to match.
+	    state = state->out;
+    }
+}
+
+    static int
+dfa_compare_ints(const void *s1, const void *s2)
+{
+    return *(int *)s1 - *(int *)s2;
+}
+
+/*
+ * Remove all cached DFA states.
+ */
+    static void
+dfa_clear(nfa_dfa_T *dfa)
+{
+    int		    i;
+    nfa_dstate_T    *ds;
+
+    for (i = 0; i < DFA_HASH_SIZE; ++i)
+	while (dfa->dfa_hash[i] != NULL)
+	{
+	    ds = dfa->dfa_hash[i];
+	    dfa->dfa_hash[i] = ds->ds_hashnext;
+	    vim_free(ds->ds_next);
+	    vim_free(ds);
+	}
+    dfa->dfa_start[0] = NULL;
+    dfa->dfa_start[1] = NULL;
+    dfa->dfa_nstates = 0;
+    dfa->dfa_mem = 0;
+}
+
+/*
+ * Remove all cached DFA states because there are too many.  When this happens
+ * too often stop using the DFA.
+ */
+    static void
+dfa_flush(nfa_dfa_T *dfa)
+{
+    dfa_clear(dfa);
+    if (++dfa->dfa_flushes >= DFA_MAX_FLUSHES)
+	dfa->dfa_disabled = TRUE;
+}
+
+/*
+ * Free the DFA of a regprog.
+ */
+    static void
+dfa_free(nfa_dfa_T *dfa)
+{
+    if (dfa == NULL)
+	return;
+    dfa_clear(dfa);
+    vim_free(dfa->dfa_list);
+    vim_free(dfa->dfa_gen_mark);
+    vim_free(dfa);
+}
+
+/*
+ * Find the DFA state for the NFA states in dfa->dfa_list and the flags in
+ * dfa->dfa_flags.  Adds a new state if it doesn't exist yet.
+ * Returns NULL when out of memory or there are too many states.
+ */
+    static nfa_dstate_T *
+dfa_find_state(nfa_regprog_T *prog, nfa_dfa_T *dfa)
+{
+    int		    len = dfa->dfa_listlen;
+    int		    *list = dfa->dfa_list;
+    unsigned	    hash = dfa->dfa_flags;
+    nfa_dstate_T    *ds;
+    long	    size;
+    int		    i;
+
+    if (len > 1)
+	qsort((void *)list, (size_t)len, sizeof(int), dfa_compare_ints);
+    for (i = 0; i < len; ++i)
+	hash = hash * 31 + list[i];
+
+    for (ds = dfa->dfa_hash[hash & (DFA_HASH_SIZE - 1)]; ds != NULL;
+							 ds = ds->ds_hashnext)
+	if (ds->ds_hash == hash && ds->ds_len == len
+		&& (ds->ds_flags & DS_MATCH) == dfa->dfa_flags
+		&& memcmp(ds->ds_states, list, len * sizeof(int)) == 0)
+	    return ds;
+
+    size = offsetof(nfa_dstate_T, ds_states) + (len + 1) * sizeof(int);
+    if (dfa->dfa_nstates >= DFA_MAX_STATES
+	    || dfa->dfa_mem + size + dfa->dfa_nclass * sizeof(nfa_dstate_T *)
+								 > DFA_MAX_MEM)
+	return NULL;
+    ds = lalloc(size, FALSE);
+    if (ds == NULL)
+	return NULL;
+    ds->ds_next = (nfa_dstate_T **)lalloc_clear(
+			  dfa->dfa_nclass * sizeof(nfa_dstate_T *), FALSE);
+    if (ds->ds_next == NULL)
+    {
+	vim_free(ds);
+	return NULL;
+    }
+    ds->ds_hash = hash;
+    ds->ds_flags = dfa->dfa_flags;
+    ds->ds_len = len;
+    mch_memmove(ds->ds_states, list, len * sizeof(int));
+
+    if ((ds->ds_flags & DS_MATCH) == 0)
+    {
+	// Check for a match at the end of the line, after a "$".
+	++dfa->dfa_gen;
+	dfa->dfa_flags = 0;
+	for (i = 0; i < len; ++i)
+	    if (prog->state[list[i]].c == NFA_EOL)
+		dfa_addstate(prog, dfa, prog->state[list[i]].out, TRUE, TRUE);
+	if (dfa->dfa_flags & DS_MATCH)
+	    ds->ds_flags |= DS_MATCH_EOL;
+	else if (len == 0)
+	    // Nothing is active and a match can't start here.
+	    ds->ds_flags |= DS_DEAD;
+    }
+
+    ds->ds_hashnext = dfa->dfa_hash[hash & (DFA_HASH_SIZE - 1)];
+    dfa->dfa_hash[hash & (DFA_HASH_SIZE - 1)] = ds;
+    ++dfa->dfa_nstates;
+    dfa->dfa_mem += size + dfa->dfa_nclass * sizeof(nfa_dstate_T *);
+    return ds;
+}
+
+/*
+ * Compute the DFA state that follows "ds" for character "c" at "p".
+ * Returns NULL when the cache is full.
+ */
+    static nfa_dstate_T *
+dfa_step(
+    nfa_regprog_T   *prog,
+    nfa_dfa_T	    *dfa,
+    nfa_dstate_T    *ds,
+    int		    c,
+    char_u	    *p)
+{
+    nfa_state_T	    *next;
+    int		    i;
+
+    ++dfa->dfa_gen;
+    dfa->dfa_listlen = 0;
+    dfa->dfa_flags = 0;
+    for (i = 0; i < ds->ds_len; ++i)
+    {
+	next = dfa_match_char(&prog->state[ds->ds_states[i]], c, p);
+	if (next != NULL)
+	    dfa_addstate(prog, dfa, next, FALSE, FALSE);
+    }
+    // A match may start at every position.
+    dfa_addstate(prog, dfa, prog->start, FALSE, FALSE);
+    return dfa_find_state(prog, dfa);
+}
+
+/*
+ * Split the single-byte characters in classes that all NFA states handle the
+ * same way, so that transitions only need to be stored per class.
+ */
+    static void
+dfa_make_classes(nfa_regprog_T *prog, nfa_dfa_T *dfa)
+{
+    int		maxc = enc_utf8 ? 0x80 : 0x100;
+    int		nclass = 1;
+    int		newclass[512];
+    char_u	buf[2];
+    int		i;
+    int		c;
+    int		n;
+
+    vim_memset(dfa->dfa_class, 0, sizeof(dfa->dfa_class));
+    buf[1] = NUL;
+    for (i = 0; i < prog->nstate && nclass < maxc - 1; ++i)
+    {
+	if (!DFA_CONSUMES(prog->state[i].c))
+	    continue;
+	for (n = 0; n < nclass * 2; ++n)
+	    newclass[n] = -1;
+	n = 0;
+	// NUL is never looked up, it is the end of the line
+	for (c = 1; c < maxc; ++c)
+	{
+	    int k;
+
+	    buf[0] = c;
+	    k = dfa->dfa_class[c] * 2
+			    + (dfa_match_char(&prog->state[i], c, buf) != NULL);
+	    if (newclass[k] < 0)
+		newclass[k] = n++;
+	    dfa->dfa_class[c] = newclass[k];
+	}
+	nclass = n;
+    }
+    dfa->dfa_nclass = nclass;
+}
+
+/*
+ * Get the DFA for "prog", make sure it was computed for the current options.
+ * Returns NULL when the DFA can't be used.
+ */
+    static nfa_dfa_T *
+dfa_get(nfa_regprog_T *prog)
+{
+    nfa_dfa_T	*dfa = prog->dfa;
+    int		i;
+    int		c;
+
+    if (rex.reg_icombine || rex.reg_line_lbr || (has_mbyte && !enc_utf8))
+	return NULL;
+
+    if (dfa == NULL)
+    {
+	dfa = ALLOC_CLEAR_ONE(nfa_dfa_T);
+	if (dfa == NULL)
+	    return NULL;
+	prog->dfa = dfa;
+	for (i = 0; i < prog->nstate; ++i)
+	{
+	    c = prog->state[i].c;
+	    if (!dfa_supported_state(c))
+	    {
+		dfa->dfa_disabled = TRUE;
+		break;
+	    }
+	    if ((c >= NFA_IDENT && c <= NFA_SPRINT) || c == NFA_CLASS_PRINT
+		    || (c >= NFA_CLASS_IDENT && c <= NFA_CLASS_FNAME))
+		dfa->dfa_optclass = TRUE;
+	}
+	if (!dfa->dfa_disabled)
+	{
+	    dfa->dfa_list = ALLOC_MULT(int, prog->nstate);
+	    dfa->dfa_gen_mark = ALLOC_CLEAR_MULT(int, prog->nstate);
+	    if (dfa->dfa_list == NULL || dfa->dfa_gen_mark == NULL)
+		dfa->dfa_disabled = TRUE;
+	}
+    }
+    if (dfa->dfa_disabled)
+	return NULL;
+
+    if (dfa->dfa_nclass == 0
+	    || dfa->dfa_ic != rex.reg_ic
+	    || dfa->dfa_utf8 != enc_utf8
+	    || dfa->dfa_cmp_flags != cmp_flags
+	    || (dfa->dfa_optclass
+		&& (dfa->dfa_chartab_tick != get_chartab_tick()
+		    || memcmp(dfa->dfa_chartab, rex.reg_buf->b_chartab,
+						  sizeof(dfa->dfa_chartab)) != 0)))
+    {
+	dfa_clear(dfa);
+	dfa->dfa_ic = rex.reg_ic;
+	dfa->dfa_utf8 = enc_utf8;
+	dfa->dfa_cmp_flags = cmp_flags;
+	dfa->dfa_chartab_tick = get_chartab_tick();
+	mch_memmove(dfa->dfa_chartab, rex.reg_buf->b_chartab,
+						     sizeof(dfa->dfa_chartab));
+	dfa_make_classes(prog, dfa);
+    }
+    return dfa;
+}
+
+/*
+ * Return TRUE when there can't be a match in "line" that starts at column
+ * "col" or later.  Returns FALSE when there may be a match or the DFA can't
+ * be used.
+ */
+    static int
+dfa_no_match(nfa_regprog_T *prog, char_u *line, colnr_T col)
+{
+    nfa_dfa_T	    *dfa = dfa_get(prog);
+    nfa_dstate_T    *ds;
+    nfa_dstate_T    *next;
+    char_u	    *p = line + col;
+    int		    c;
+    int		    len;
+
+    if (dfa == NULL)
+	return FALSE;
+
+    ds = dfa->dfa_start[col == 0 ? 0 : 1];
+    if (ds == NULL)
+    {
+	++dfa->dfa_gen;
+	dfa->dfa_listlen = 0;
+	dfa->dfa_flags = 0;
+	dfa_addstate(prog, dfa, prog->start, col == 0, FALSE);
+	ds = dfa_find_state(prog, dfa);
+	if (ds == NULL)
+	{
+	    dfa_flush(dfa);
+	    return FALSE;
+	}
+	dfa->dfa_start[col == 0 ? 0 : 1] = ds;
+    }
+
+    for (;;)
+    {
+	if (ds->ds_flags & DS_MATCH)
+	    return FALSE;
+	if (ds->ds_flags & DS_DEAD)
+	    return TRUE;
+	c = *p;
+	if (c == NUL)
+	    return (ds->ds_flags & DS_MATCH_EOL) == 0;
+
+	if (!enc_utf8 || (c < 0x80 && p[1] < 0x80))
+	{
+	    // Single byte character, use the cached transition.
+	    next = ds->ds_next[dfa->dfa_class[c]];
+	    if (next == NULL)
+	    {
+		next = dfa_step(prog, dfa, ds, c, p);
+		if (next == NULL)
+		{
+		    dfa_flush(dfa);
+		    return FALSE;
+		}
+		ds->ds_next[dfa->dfa_class[c]] = next;
+	    }
+	    ++p;
+	}
+	else
+	{
+	    // Multi-byte character or a character that may be followed by a
+	    // composing character.  The NFA handles composing characters.
+	    c = utf_ptr2char(p);
+	    len = utfc_ptr2len(p);
+	    if (len != utf_ptr2len(p) || utf_iscomposing(c))
+		return FALSE;
+	    next = dfa_step(prog, dfa, ds, c, p);
+	    if (next == NULL)
+	    {
+		dfa_flush(dfa);
+		return FALSE;
+	    }
+	    p += len;
+	}
+	ds = next;
+    }
+}
+
 /*
  * Main matching routine.
  *
@@ -7527,6 +8467,14 @@ nfa_regexec_both(
     if (rex.reg_maxcol > 0 && col >= rex.reg_maxcol)
 	goto theend;
 
+    // Without the text that every match contains there is no match.
+    if (prog->regmust != NULL && regmust_missing(prog, rex.line + col))
+	goto theend;
+
+    // When the DFA finds no match the NFA doesn't need to run.
+    if (!prog->has_backref && dfa_no_match(prog, rex.line, col))
+	goto theend;
+
     // Set the "nstate" used by nfa_regcomp() to zero to trigger an error when
     // it's accidentally used during execution.
     nstate = 0;
@@ -7631,6 +8579,7 @@ nfa_regcomp(char_u *expr, int re_flags)
 	goto fail;
     state_ptr = prog->state;
     prog->re_in_use = FALSE;
+    prog->re_pattern = NULL;
 
     /*
      * PASS 2
@@ -7652,6 +8601,19 @@ nfa_regcomp(char_u *expr, int re_flags)
     prog->reganch = nfa_get_reganch(prog->start, 0);
     prog->regstart = nfa_get_regstart(prog->start, 0);
     prog->match_text = nfa_get_match_text(prog->start);
+    prog->regmust = NULL;
+    prog->regmust_ascii = TRUE;
+    prog->dfa = NULL;
+    if (prog->match_text == NULL)
+    {
+	char_u *q;
+
+	prog->regmust = nfa_get_regmust(postfix, post_ptr);
+	if (prog->regmust != NULL)
+	    for (q = prog->regmust; *q != NUL; ++q)
+		if (*q >= 0x80)
+		    prog->regmust_ascii = FALSE;
+    }
 
 #ifdef ENABLE_LOG
     nfa_postfix_dump(expr, OK);
@@ -7693,6 +8655,8 @@ nfa_regfree(regprog_T *prog)
 	return;
 
     vim_free(((nfa_regprog_T *)prog)->match_text);
+    vim_free(((nfa_regprog_T *)prog)->regmust);
+    dfa_free(((nfa_regprog_T *)prog)->dfa);
     vim_free(((nfa_regprog_T *)prog)->pattern);
     vim_free(prog);
 }
@@ -2234,6 +2234,27 @@ do_put(
 		    i = 1;
 		}
 
+		if (!(flags & PUT_FIXINDENT) && i < y_size)
+		{
+		    // Append all the lines at once, much faster for a big
+		    // register.
+		    long    todo = (y_type == MCHAR ? y_size - 1 : y_size) - i;
+		    long    done = ml_append_multi(lnum, y_array + i, todo, 0);
+
+		    lnum += done;
+		    new_lnum += done;
+		    nr_lines += done;
+		    if (done < todo)
+			goto error;
+		    if (y_type == MCHAR)
+		    {
+			// the last line was inserted above
+			++lnum;
+			++nr_lines;
+		    }
+		    i = y_size;
+		}
+
 		for (; i < y_size; ++i)
 		{
 		    if (y_type != MCHAR || i < y_size - 1)
@@ -371,6 +371,92 @@ char_needs_redraw(int off_from, int off_to, int cols)
     return FALSE;
 }
 
+/*
+ * Number of screen cells compared at once by screen_cells_same() and
+ * screen_cells_changed().
+ */
+#define CELLS_BLOCK 32
+
+/*
+ * Return TRUE if the one screen cell at "off_from" and "off_to" is the same.
+ * Only for when "enc_dbcs" is zero.
+ */
+    static int
+screen_cell_same(unsigned off_from, unsigned off_to)
+{
+    return ScreenLines[off_from] == ScreenLines[off_to]
+	    && ScreenAttrs[off_from] == ScreenAttrs[off_to]
+	    && (!enc_utf8
+		|| (ScreenLinesUC[off_from] == ScreenLinesUC[off_to]
+		    && (ScreenLinesUC[off_from] == 0
+			|| !comp_char_differs(off_from, off_to))));
+}
+
+/*
+ * Return TRUE if "len" screen cells at "off_from" and "off_to" are the same.
+ * This uses memcmp(), which compares many bytes at once.  It may return FALSE
+ * for equal cells when unused composing characters differ.
+ */
+    static int
+screen_cells_block_same(unsigned off_from, unsigned off_to, int len)
+{
+    int	    i;
+
+    if (memcmp(ScreenLines + off_from, ScreenLines + off_to,
+						   len * sizeof(schar_T)) != 0
+	    || memcmp(ScreenAttrs + off_from, ScreenAttrs + off_to,
+						  len * sizeof(sattr_T)) != 0)
+	return FALSE;
+    if (enc_utf8)
+    {
+	if (memcmp(ScreenLinesUC + off_from, ScreenLinesUC + off_to,
+						len * sizeof(u8char_T)) != 0)
+	    return FALSE;
+	for (i = 0; i < Screen_mco; ++i)
+	    if (memcmp(ScreenLinesC[i] + off_from, ScreenLinesC[i] + off_to,
+						len * sizeof(u8char_T)) != 0)
+		return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Return the number of cells at the start of "cols" screen cells at
+ * "off_from" and "off_to" that are the same.
+ */
+    static int
+screen_cells_same(unsigned off_from, unsigned off_to, int cols)
+{
+    int	    col = 0;
+
+    while (col + CELLS_BLOCK <= cols
+	    && screen_cells_block_same(off_from + col, off_to + col,
+								 CELLS_BLOCK))
+	col += CELLS_BLOCK;
+    while (col < cols && screen_cell_same(off_from + col, off_to + col))
+	++col;
+    return col;
+}
+
+/*
+ * Return the number of cells up to and including the last cell that differs
+ * in "cols" screen cells at "off_from" and "off_to".  Zero when all the cells
+ * are the same.
+ */
+    static int
+screen_cells_changed(unsigned off_from, unsigned off_to, int cols)
+{
+    int	    col = cols;
+
+    while (col >= CELLS_BLOCK
+	    && screen_cells_block_same(off_from + col - CELLS_BLOCK,
+				     off_to + col - CELLS_BLOCK, CELLS_BLOCK))
+	col -= CELLS_BLOCK;
+    while (col > 0 && screen_cell_same(off_from + col - 1, off_to + col - 1))
+	--col;
+    return col;
+}
+
 #if defined(FEAT_TERMINAL)
 /*
  * Return the index in ScreenLines[] for the current screen line.
@@ -484,6 +570,7 @@ screen_line(
     int		    clear_next = FALSE;
     int		    char_cells;		// 1: normal char
 					// 2: occupies two display cells
+    int		    changed_end = INT_MAX; // column after last changed cell
 
     // Check for illegal row and col, just in case.
     if (row >= Rows)
@@ -545,6 +632,33 @@ screen_line(
     }
 #endif
 
+    // Skip over the cells at the start that did not change and find the last
+    // cell that changed.  Not when a cell that did not change may need to be
+    // redrawn because of the cells around it.
+    if (enc_dbcs == 0 && !p_wiv
+#ifdef FEAT_GUI
+	    && !gui.in_use
+#endif
+	    && col < endcol)
+    {
+	int	same = screen_cells_same(off_from, off_to, endcol - col);
+
+	// Don't start halfway a double-wide character.
+	if (enc_utf8 && same < endcol - col)
+	    while (same > 0 && ScreenLines[off_from + same] == 0)
+		--same;
+	if (same > 0)
+	{
+	    mch_memmove(ScreenCols + off_to, ScreenCols + off_from,
+						     same * sizeof(colnr_T));
+	    off_from += same;
+	    off_to += same;
+	    col += same;
+	}
+	changed_end = col + screen_cells_changed(off_from, off_to,
+								endcol - col);
+    }
+
     redraw_next = char_needs_redraw(off_from, off_to, endcol - col);
 #ifdef FEAT_GUI_MSWIN
     changed_next = redraw_next;
@@ -760,6 +874,16 @@ screen_line(
 	off_to += char_cells;
 	off_from += char_cells;
 	col += char_cells;
+
+	if (col >= changed_end && !redraw_next && col < endcol)
+	{
+	    // The rest of the line did not change.
+	    mch_memmove(ScreenCols + off_to, ScreenCols + off_from,
+					     (endcol - col) * sizeof(colnr_T));
+	    off_to += endcol - col;
+	    off_from += endcol - col;
+	    col = endcol;
+	}
     }
 
     if (clear_next && !skip_for_popup(row, col + coloff))
@@ -1951,6 +2075,138 @@ reset_cterm_colors(void)
     }
 }
 
+/*
+ * For screen_change_highlight(): get the color "which" (0: foreground,
+ * 1: background, 2: underline) that the terminal uses for "aep", which is
+ * NULL for attribute zero.  A color that is not set is the Normal color, that
+ * is what screen_stop_highlight() leaves behind.
+ * With 'termguicolors' the RGB color is returned in "rgbp".
+ * Returns FAIL when a cterm color is used with 'termguicolors'.
+ */
+    static int
+hl_effective_color(attrentry_T *aep, int which, int *colorp, guicolor_T *rgbp)
+{
+#ifdef FEAT_TERMGUICOLORS
+    if (p_tgc)
+    {
+	guicolor_T  rgb = INVALCOLOR;
+
+	if (aep != NULL)
+	    rgb = which == 0 ? aep->ae_u.cterm.fg_rgb
+		: which == 1 ? aep->ae_u.cterm.bg_rgb : aep->ae_u.cterm.ul_rgb;
+	if (rgb == CTERMCOLOR)
+	    return FAIL;
+	if (rgb == INVALCOLOR)
+	    rgb = which == 0 ? cterm_normal_fg_gui_color
+		: which == 1 ? cterm_normal_bg_gui_color
+						   : cterm_normal_ul_gui_color;
+	*rgbp = rgb;
+	*colorp = 0;
+	return OK;
+    }
+#endif
+    *colorp = 0;
+    if (aep != NULL)
+	*colorp = which == 0 ? aep->ae_u.cterm.fg_color
+		: which == 1 ? aep->ae_u.cterm.bg_color
+						    : aep->ae_u.cterm.ul_color;
+    if (*colorp == 0)
+	*colorp = which == 0 ? cterm_normal_fg_color
+		: which == 1 ? cterm_normal_bg_color : cterm_normal_ul_color;
+    return OK;
+}
+
+/*
+ * Change the highlighting from "screen_attr" to "attr" by only outputting the
+ * colors that differ, instead of stopping and starting the highlighting.
+ * Only possible in a color terminal, when both only set colors and "attr"
+ * doesn't go back to the default color of the terminal.
+ * Syntax highlighting mostly changes the color only, this avoids sending
+ * "t_me" and the Normal colors for every change.
+ * Returns FAIL when not possible.
+ */
+    static int
+screen_change_highlight(int attr)
+{
+    attrentry_T	*old_aep = NULL;
+    attrentry_T	*new_aep = NULL;
+    int		which;
+    int		old_color, new_color;
+    guicolor_T	old_rgb = INVALCOLOR, new_rgb = INVALCOLOR;
+
+    if (!full_screen || !IS_CTERM || cterm_normal_fg_bold
+	    || (screen_attr != 0 && screen_attr <= HL_ALL)
+	    || (attr != 0 && attr <= HL_ALL)
+#ifdef MSWIN
+	    || !termcap_active
+#endif
+#ifdef FEAT_GUI
+	    || gui.in_use
+#endif
+#if defined(FEAT_VTP) && defined(FEAT_TERMGUICOLORS)
+	    || use_vtp()
+#endif
+	    )
+	return FAIL;
+
+    if (screen_attr != 0)
+    {
+	old_aep = syn_cterm_attr2entry(screen_attr);
+	if (old_aep == NULL || old_aep->ae_attr != 0
+					       || old_aep->ae_u.cterm.font != 0)
+	    return FAIL;
+    }
+    if (attr != 0)
+    {
+	new_aep = syn_cterm_attr2entry(attr);
+	if (new_aep == NULL || new_aep->ae_attr != 0
+					       || new_aep->ae_u.cterm.font != 0)
+	    return FAIL;
+    }
+
+    // First check all colors, nothing must be output when failing.
+    for (which = 0; which < 3; ++which)
+    {
+	if (hl_effective_color(old_aep, which, &old_color, &old_rgb) == FAIL
+		|| hl_effective_color(new_aep, which, &new_color,
+							   &new_rgb) == FAIL)
+	    return FAIL;
+	// Going back to the default color requires "t_me".
+	if (new_color == 0 && new_rgb == INVALCOLOR
+				 && (old_color != 0 || old_rgb != INVALCOLOR))
+	    return FAIL;
+    }
+
+    for (which = 0; which < 3; ++which)
+    {
+	hl_effective_color(old_aep, which, &old_color, &old_rgb);
+	hl_effective_color(new_aep, which, &new_color, &new_rgb);
+	if (new_color == old_color && new_rgb == old_rgb)
+	    continue;
+#ifdef FEAT_TERMGUICOLORS
+	if (p_tgc)
+	{
+	    if (which == 0)
+		term_fg_rgb_color(new_rgb);
+	    else if (which == 1)
+		term_bg_rgb_color(new_rgb);
+	    else
+		term_ul_rgb_color(new_rgb);
+	}
+	else
+#endif
+	    if (which == 0)
+		term_fg_color(new_color - 1);
+	    else if (which == 1)
+		term_bg_color(new_color - 1);
+	    else
+		term_ul_color(new_color - 1);
+    }
+
+    screen_attr = attr;
+    return OK;
+}
+
 /*
  * Put character ScreenLines["off"] on the screen at position "row" and "col",
  * using the attributes from ScreenAttrs["off"].
@@ -1982,19 +2238,24 @@ screen_char(unsigned off, int row, int col)
     }
 
     /*
-     * Stop highlighting first, so it's easier to move the cursor.
+     * Stop highlighting first, so it's easier to move the cursor.  Not when
+     * the cursor can be moved while highlighting, perhaps only the color
+     * needs to change then.
      */
     if (screen_char_attr != 0)
 	attr = screen_char_attr;
     else
 	attr = ScreenAttrs[off];
-    if (screen_attr != attr)
+    if (screen_attr != attr && *T_MS == NUL)
 	screen_stop_highlight();
 
     windgoto(row, col);
 
-    if (screen_attr != attr)
+    if (screen_attr != attr && screen_change_highlight(attr) == FAIL)
+    {
+	screen_stop_highlight();
 	screen_start_highlight(attr);
+    }
 
     if (enc_utf8 && ScreenLinesUC[off] != 0)
     {
@@ -3028,7 +3289,6 @@ windgoto(int row, int col)
     int		    goto_cost;
     int		    attr;
 
-#define GOTO_COST   7	// assume a term_windgoto() takes about 7 chars
 #define HIGHL_COST  5	// assume unhighlight takes 5 chars
 
 #define PLAN_LE	    1
@@ -3054,7 +3314,14 @@ windgoto(int row, int col)
 	noinvcurs = HIGHL_COST;
     else
 	noinvcurs = 0;
-    goto_cost = GOTO_COST + noinvcurs;
+
+    // The number of bytes for moving the cursor with "RI" when going right in
+    // the same row or else with "cm", which depends on the row and column.
+    if (row == screen_cur_row && col > screen_cur_col && *T_CRI != NUL)
+	goto_cost = term_goto_len(0, col - screen_cur_col, TRUE);
+    else
+	goto_cost = term_goto_len(row, col, FALSE);
+    goto_cost += noinvcurs;
 
     /*
      * Plan how to do the positioning:
@@ -521,31 +521,38 @@ typedef struct memfile	    memfile_T;
 typedef long		    blocknr_T;
 
 /*
- * mf_hashtab_T is a chained hashtable with blocknr_T key and arbitrary
- * structures as items.  This is an intrusive data structure: we require
- * that items begin with mf_hashitem_T which contains the key and linked
- * list pointers.  List of items in each bucket is doubly-linked.
+ * mf_hashtab_T is an open addressing hashtable with blocknr_T key and
+ * arbitrary structures as items.  We require that items begin with
+ * mf_hashitem_T which contains the key.  The key is also stored in the slot
+ * of the table, so that looking up a key does not need to access the items.
+ * Collisions are resolved with linear probing.
  */
 
 typedef struct mf_hashitem_S mf_hashitem_T;
 
 struct mf_hashitem_S
 {
-    mf_hashitem_T   *mhi_next;
-    mf_hashitem_T   *mhi_prev;
     blocknr_T	    mhi_key;
 };
 
+typedef struct mf_hashslot_S
+{
+    blocknr_T	    mhs_key;	    // copy of mhs_item->mhi_key
+    mf_hashitem_T   *mhs_item;	    // NULL for an empty slot
+} mf_hashslot_T;
+
 #define MHT_INIT_SIZE   64
 
 typedef struct mf_hashtab_S
 {
-    long_u	    mht_mask;	    // mask used for hash value (nr of items
+    long_u	    mht_mask;	    // mask used for hash value (nr of slots
 				    // in array is "mht_mask" + 1)
     long_u	    mht_count;	    // nr of items inserted into hashtable
-    mf_hashitem_T   **mht_buckets;  // points to mht_small_buckets or
-				    //dynamically allocated array
-    mf_hashitem_T   *mht_small_buckets[MHT_INIT_SIZE];   // initial buckets
+    int		    mht_shift;	    // shift for the hash value, 32 minus
+				    // the nr of bits in "mht_mask"
+    mf_hashslot_T   *mht_slots;	    // points to mht_small_slots or
+				    // dynamically allocated array
+    mf_hashslot_T   mht_small_slots[MHT_INIT_SIZE];   // initial slots
     char	    mht_fixed;	    // non-zero value forbids growth
 } mf_hashtab_T;
 
@@ -553,12 +560,12 @@ typedef struct mf_hashtab_S
  * for each (previously) used block in the memfile there is one block header.
  *
  * The block may be linked in the used list OR in the free list.
- * The used blocks are also kept in hash lists.
+ * The used blocks are also kept in a hash table.
  *
  * The used list is a doubly linked list, most recently used block first.
  *	The blocks in the used list have a block of memory allocated.
  *	mf_used_count is the number of pages in the used list.
- * The hash lists are used to quickly find a block in the used list.
+ * The hash table is used to quickly find a block in the used list.
  * The free list is a single linked list, not sorted.
  *	The blocks in the free list have no block of memory allocated and
  *	the contents of the block in the file (if any) is irrelevant.
@@ -583,7 +590,7 @@ struct block_hdr
  * when a block with a negative number is flushed to the file, it gets
  * a positive number. Because the reference to the block is still the negative
  * number, we remember the translation to the new positive number in the
- * double linked trans lists. The structure is the same as the hash lists.
+ * trans hashtable. The structure is the same as the hash table of blocks.
  */
 typedef struct nr_trans NR_TRANS;
 
@@ -764,6 +771,25 @@ typedef enum {
 
 #define MF_SEED_LEN	8
 
+#ifdef USE_MMAP
+/*
+ * A file of which the lines are loaded when used, see 'mmapsize'.  Data
+ * block number "mfl_first - n" holds "mfl_lines[n]" lines, which start at
+ * byte "mfl_offset[n]" of the file.  These blocks are only read when used.
+ */
+typedef struct
+{
+    int		mfl_fd;			// file descriptor, used to read the text
+    dev_t	mfl_dev;		// device number of the file
+    ino_t	mfl_ino;		// inode number of the file
+    blocknr_T	mfl_first;		// block number of the first data block
+    long	mfl_count;		// number of data blocks
+    off_T	*mfl_offset;		// mfl_count + 1 byte offsets
+    int		*mfl_lines;		// number of lines in each data block
+    int		mfl_changed;		// file was changed, error was given
+} mf_lazy_T;
+#endif
+
 struct memfile
 {
     char_u	*mf_fname;		// name of the file
@@ -776,14 +802,17 @@ struct memfile
     bhdr_T	*mf_used_last;		// lru block_hdr in used list
     unsigned	mf_used_count;		// number of pages in used list
     unsigned	mf_used_count_max;	// maximum number of pages in memory
-    mf_hashtab_T mf_hash;		// hash lists
-    mf_hashtab_T mf_trans;		// trans lists
+    mf_hashtab_T mf_hash;		// hash table of used blocks
+    mf_hashtab_T mf_trans;		// hash table of translations
     blocknr_T	mf_blocknr_max;		// highest positive block number + 1
     blocknr_T	mf_blocknr_min;		// lowest negative block number - 1
     blocknr_T	mf_neg_count;		// number of negative blocks numbers
     blocknr_T	mf_infile_count;	// number of pages in the file
     unsigned	mf_page_size;		// number of bytes in a page
     mfdirty_T	mf_dirty;
+#ifdef USE_MMAP
+    mf_lazy_T	*mf_lazy;		// file lines are loaded from or NULL
+#endif
 #ifdef FEAT_CRYPT
     buf_T	*mf_buffer;		// buffer this memfile is for
     char_u	mf_seed[MF_SEED_LEN];	// seed for encryption
@@ -827,6 +856,24 @@ typedef struct ml_chunksize
 # define ML_CHNK_UPDLINE 3
 #endif
 
+/*
+ * Entry in the cache of recently used data blocks of a memline.  The block
+ * stays locked while it is in the cache, together with the path of pointer
+ * blocks that leads to it, so that it can become ml_locked again without
+ * walking the tree.
+ */
+#define ML_CACHE_SIZE	4	// number of cached data blocks
+#define ML_CACHE_DEPTH	6	// max depth of the tree for a cached block
+
+typedef struct ml_cache
+{
+    bhdr_T	*mc_hp;		// locked data block
+    linenr_T	mc_low;		// first line in mc_hp
+    linenr_T	mc_high;	// last line in mc_hp
+    int		mc_stack_top;	// number of entries in mc_stack
+    infoptr_T	mc_stack[ML_CACHE_DEPTH];   // pointer blocks leading to mc_hp
+} mlcache_T;
+
 /*
  * the memline structure holds all the information about a memline
  */
@@ -845,6 +892,8 @@ typedef struct memline
 #define ML_LOCKED_DIRTY	0x04	// ml_locked was changed
 #define ML_LOCKED_POS	0x08	// ml_locked needs positive block number
 #define ML_ALLOCATED	0x10	// ml_line_ptr is an allocated copy
+#define ML_ASCII_CHECKED 0x20	// ML_LINE_ASCII is valid for the cached line
+#define ML_LINE_ASCII	0x40	// cached line only has printable ASCII
     int		ml_flags;
 
     colnr_T	ml_line_len;	// length of the cached line + NUL + text properties
@@ -856,10 +905,17 @@ typedef struct memline
     linenr_T	ml_locked_low;	// first line in ml_locked
     linenr_T	ml_locked_high;	// last line in ml_locked
     int		ml_locked_lineadd;  // number of lines inserted in ml_locked
+
+    mlcache_T	ml_cache[ML_CACHE_SIZE];    // recently used data blocks,
+					    // most recently used first
+    int		ml_cache_len;	// number of valid entries in ml_cache
 #ifdef FEAT_BYTEOFF
     chunksize_T *ml_chunksize;
     int		ml_numchunks;
     int		ml_usedchunks;
+    chunksize_T *ml_chunkindex;	// Fenwick tree with sums of ml_chunksize
+    int		ml_chunkindex_size; // allocated entries in ml_chunkindex
+    int		ml_chunkindex_valid; // ml_chunkindex matches ml_chunksize
 #endif
 } memline_T;
 
@@ -904,6 +960,16 @@ typedef struct textprop_S
 					// text is truncated
 #define TP_FLAG_START_INCL	0x100	// "start_incl" copied from proptype
 
+/*
+ * Entry in the index of the text properties of a buffer, see
+ * get_prop_index().
+ */
+typedef struct
+{
+    linenr_T	pe_lnum;	// line of the property
+    textprop_T	pe_prop;	// copy of the property
+} propentry_T;
+
 #define PROP_TEXT_MIN_CELLS	4	// minimum number of cells to use for
 					// the text, even when truncating
 
@@ -1175,6 +1241,19 @@ struct keyentry
     char_u	keyword[1];	// actually longer
 };
 
+/*
+ * The keywords of one hashtable are compiled into a double-array trie, to
+ * find the keyword at a position in the text without isolating and hashing
+ * the word first.  This is one state of the trie.  From state "s" byte "c"
+ * leads to state "t" = states[s].ks_base + c when states[t].ks_check is "s".
+ */
+typedef struct
+{
+    int		ks_base;	// offset for the next state
+    int		ks_check;	// previous state, -1 when not used
+    keyentry_T	*ks_kp;		// keyword ending in this state or NULL
+} keywstate_T;
+
 /*
  * Struct used to store one state of the state stack.
  */
@@ -1189,6 +1268,21 @@ typedef struct buf_state
     reg_extmatch_T *bs_extmatch; // external matches from start pattern
 } bufstate_T;
 
+/*
+ * synstack_T is a state stack stored for the start of a line.  Identical
+ * stacks are shared by the entries in b_sst_array[].
+ */
+typedef struct syn_stack synstack_T;
+
+struct syn_stack
+{
+    synstack_T	*ss_next;	// next stack in the same hash list
+    long_u	ss_hash;	// hash of ss_states[]
+    int		ss_refcount;	// number of entries using this stack
+    int		ss_size;	// number of states in ss_states[]
+    bufstate_T	ss_states[1];	// the states, actually longer
+};
+
 /*
  * syn_state contains the syntax state stack for the start of one line.
  * Used by b_sst_array[].
@@ -1199,13 +1293,8 @@ struct syn_state
 {
     synstate_T	*sst_next;	// next entry in used or free list
     linenr_T	sst_lnum;	// line number for this state
-    union
-    {
-	bufstate_T	sst_stack[SST_FIX_STATES]; // short state stack
-	garray_T	sst_ga;	// growarray for long state stack
-    } sst_union;
+    synstack_T	*sst_stack;	// state stack, NULL when empty
     int		sst_next_flags;	// flags for sst_next_list
-    int		sst_stacksize;	// number of states on the stack
     short	*sst_next_list;	// "nextgroup" list in this state
 				// (this is a copy, don't free it!
     disptick_T	sst_tick;	// tick when last displayed
@@ -2632,6 +2721,9 @@ typedef struct {
 # if defined(UNIX) && !defined(HAVE_SELECT)
     int		ch_poll_idx;	// used by channel_poll_setup()
 # endif
+# ifdef USE_EPOLL
+    int		ch_epoll_registered; // ch_fd was added to the epoll set
+# endif
 
 #ifdef FEAT_GUI_X11
     XtInputId	ch_inputHandler; // Cookie for input
@@ -2713,6 +2805,9 @@ struct channel_S {
     int		ch_drop_never;
     int		ch_keep_open;	// do not close on read error
     int		ch_nonblock;
+# ifdef USE_EPOLL
+    int		ch_select_walk;	// counted in channel_select_count
+# endif
 
     job_T	*ch_job;	// Job that uses this channel; this does not
 				// count as a reference to avoid a circular
@@ -2966,6 +3061,8 @@ struct timer_S
     timer_T	*tr_next;
     timer_T	*tr_prev;
     proftime_T	tr_due;		    // when the callback is to be invoked
+    int		tr_heap_idx;	    // index in timer_heap, -1 if not in it
+    varnumber_T	tr_pass;	    // timer_pass when it was put in timer_heap
     char	tr_firing;	    // when TRUE callback is being called
     char	tr_paused;	    // when TRUE callback is not invoked
     char	tr_keep;	    // when TRUE keep timer after it fired
@@ -2973,6 +3070,9 @@ struct timer_S
     long	tr_interval;	    // msec
     callback_T	tr_callback;
     int		tr_emsg_count;
+    long	tr_fired;	    // number of times the callback was invoked
+    long	tr_late;	    // msec the last invocation was late
+    long	tr_maxlate;	    // maximum of tr_late
 #endif
 };
 
@@ -3034,6 +3134,51 @@ typedef enum {
 # define POPUPWIN_NOTIFICATION_ZINDEX   300
 #endif
 
+#ifdef FEAT_SYN_HL
+/*
+ * synrun_T is a run of byte columns with the same syntax attributes.
+ * Used by synline_T.
+ */
+typedef struct syn_run
+{
+    colnr_T	sr_col;		// first column of the run
+    int		sr_attr;	// attributes from get_syntax_attr()
+    int		sr_can_spell;	// "can_spell" from get_syntax_attr()
+# ifdef FEAT_CONCEAL
+    int		sr_flags;	// flags from get_syntax_info()
+    int		sr_seqnr;	// sequence number from get_syntax_info()
+    int		sr_cchar;	// from syn_get_sub_char()
+# endif
+} synrun_T;
+
+/*
+ * synline_T holds the syntax attributes of a line that was drawn, so that it
+ * can be drawn again without parsing it.
+ */
+typedef struct syn_line
+{
+    linenr_T	sl_lnum;	// line number, zero when not used
+    int		sl_spell;	// "sr_can_spell" was computed
+    colnr_T	sl_endcol;	// columns before this one are stored
+    int		sl_count;	// number of runs in sl_runs[]
+    synrun_T	*sl_runs;	// the runs, by increasing column
+} synline_T;
+
+#define SYN_LINES_SIZE	256	// number of lines in sls_lines[]
+
+/*
+ * synlines_T holds the syntax attributes of lines that were drawn, see
+ * syn_line_cache_find().  A line is stored at sls_lines[lnum % size].
+ */
+typedef struct syn_lines
+{
+    varnumber_T	sls_changedtick;	// b:changedtick of the lines
+    int		sls_tick;		// value of syn_lines_tick
+    long	sls_smc;		// value of 'synmaxcol'
+    synline_T	sls_lines[SYN_LINES_SIZE];
+} synlines_T;
+#endif
+
 /*
  * These are items normally related to a buffer.  But when using ":ownsyntax"
  * a window may have its own instance.
@@ -3042,9 +3187,13 @@ typedef struct {
 #ifdef FEAT_SYN_HL
     hashtab_T	b_keywtab;		// syntax keywords hash table
     hashtab_T	b_keywtab_ic;		// idem, ignore case
+    garray_T	b_keywtrie;		// b_keywtab compiled, keywstate_T
+					// items, empty when not done yet
+    garray_T	b_keywtrie_ic;		// idem, ignore case
     int		b_syn_error;		// TRUE when error occurred in HL
 # ifdef FEAT_RELTIME
     int		b_syn_slow;		// TRUE when 'redrawtime' reached
+    linenr_T	b_syn_idle_lnum;	// syntax parsed up to here when idle
 # endif
     int		b_syn_ic;		// ignore case for :syn cmds
     int		b_syn_foldlevel;	// how to compute foldlevel on a line
@@ -3087,6 +3236,11 @@ typedef struct {
      * b_sst_freecount	number of free entries in b_sst_array[]
      * b_sst_check_lnum	entries after this lnum need to be checked for
      *			validity (MAXLNUM means no check needed)
+     * The state stacks used by the entries are kept in a hash table, so that
+     * identical stacks are stored only once.
+     * b_sst_stacks	hash table with b_sst_stacks_len lists of synstack_T
+     * b_sst_stackcount	number of stacks in b_sst_stacks[]
+     * b_sst_stackmem	number of bytes used for the stacks
      */
     synstate_T	*b_sst_array;
     int		b_sst_len;
@@ -3095,6 +3249,16 @@ typedef struct {
     int		b_sst_freecount;
     linenr_T	b_sst_check_lnum;
     short_u	b_sst_lasttick;	// last display tick
+    synstack_T	**b_sst_stacks;
+    int		b_sst_stacks_len;
+    int		b_sst_stackcount;
+    long	b_sst_stackmem;
+# ifdef FEAT_PROFILE
+    long	b_sst_stored;	// number of states stored for ":syntime"
+    long	b_sst_shared;	// idem, stored with an existing stack
+    long	b_sst_dropped;	// idem, removed to make room
+# endif
+    synlines_T	*b_syn_lines;	// attributes of lines drawn, or NULL
 #endif // FEAT_SYN_HL
 
 #ifdef FEAT_SPELL
@@ -3539,6 +3703,10 @@ struct file_buffer
     hashtab_T	*b_proptypes;	// text property types local to buffer
     proptype_T	**b_proparray;	// entries of b_proptypes sorted on tp_id
     garray_T	b_textprop_text; // stores text for props, index by (-id - 1)
+    garray_T	b_prop_index;	// propentry_T for all text props, sorted on
+				// line number
+    int		b_prop_index_valid; // b_prop_index is up to date
+    int		b_prop_index_uses;  // uses since b_prop_index became invalid
 #endif
 
 #if defined(FEAT_BEVAL) && defined(FEAT_EVAL)
@@ -3799,6 +3967,35 @@ typedef struct w_line
 #endif
 } wline_T;
 
+/*
+ * Virtual column of a character in a long line, see getvcol().
+ */
+typedef struct
+{
+    colnr_T	vp_col;		// byte index of the character
+    colnr_T	vp_vcol;	// virtual column where the character starts
+} vcolpoint_T;
+
+/*
+ * Virtual columns of characters in one long line, used by getvcol() to avoid
+ * counting from the start of the line every time.  Only valid while the
+ * buffer line and the options that change the character widths are the same.
+ */
+typedef struct
+{
+    int		vc_fnum;	// b_fnum of the buffer
+    linenr_T	vc_lnum;	// line number
+    varnumber_T	vc_changedtick;	// b:changedtick of the buffer
+    int		vc_ts;		// 'tabstop'
+    int		vc_width1;	// width of the first screen line when
+				// double-wide characters may wrap, else 0
+    int		vc_width2;	// width of further screen lines or 0
+    int		vc_chartab_tick; // get_chartab_tick() value
+    garray_T	vc_points;	// vcolpoint_T items, item N is for the first
+				// character at or after byte
+				// (N + 1) * VCOL_CACHE_STEP
+} vcolcache_T;
+
 /*
  * Windows are kept in a tree of frames.  Each frame has a column (FR_COL)
  * or row (FR_ROW) layout or is a leaf, which has a window.
@@ -4191,6 +4388,8 @@ struct window_S
     int		w_lines_valid;	    // number of valid entries
     wline_T	*w_lines;
 
+    vcolcache_T	w_vcol_cache;	    // virtual columns in a long line
+
 #ifdef FEAT_FOLDING
     garray_T	w_folds;	    // array of nested folds
     char	w_fold_manual;	    // when TRUE: some folds are opened/closed
@@ -87,8 +87,6 @@ typedef struct syn_pattern
 #define SF_CCOMMENT	0x01	// sync on a C-style comment
 #define SF_MATCH	0x02	// sync by matching a pattern
 
-#define SYN_STATE_P(ssp)    ((bufstate_T *)((ssp)->ga_data))
-
 #define MAXKEYWLEN	80	    // maximum length of a keyword
 
 /*
@@ -284,6 +282,9 @@ static void syn_update_ends(int startofline);
 static void syn_stack_alloc(void);
 static int syn_stack_cleanup(void);
 static void syn_stack_free_entry(synblock_T *block, synstate_T *p);
+static synstack_T *syn_stack_get_current(synblock_T *block);
+static void syn_stack_unref(synblock_T *block, synstack_T *ssp);
+static void syn_lines_free(synblock_T *block);
 static synstate_T *syn_stack_find_entry(linenr_T lnum);
 static synstate_T *store_current_state(void);
 static void load_current_state(synstate_T *from);
@@ -313,6 +314,13 @@ static int syn_time_on = FALSE;
 typedef int syn_time_T;
 #endif
 
+#ifdef FEAT_RELTIME
+// Number of msec syn_idle_parse() may use before checking for typeahead.
+# define SYN_IDLE_MSEC	20
+static int syn_idle_active = FALSE;	// TRUE while in syn_idle_parse()
+static int syn_idle_timed_out;		// pattern timed out while idle
+#endif
+
 static void syn_stack_apply_changes_block(synblock_T *block, buf_T *buf);
 static void find_endpos(int idx, lpos_T *startpos, lpos_T *m_endpos, lpos_T *hl_endpos, long *flagsp, lpos_T *end_endpos, int *end_idx, reg_extmatch_T *start_ext);
 
@@ -323,6 +331,8 @@ static void syn_add_start_off(lpos_T *result, regmmatch_T *regmatch, synpat_T *s
 static char_u *syn_getcurline(void);
 static colnr_T syn_getcurline_len(void);
 static int syn_regexec(regmmatch_T *rmp, linenr_T lnum, colnr_T col, syn_time_T *st);
+static garray_T *keywtrie_get(hashtab_T *ht, garray_T *gap);
+static void keywtrie_clear(synblock_T *block);
 static int check_keyword_id(char_u *line, int startcol, int *endcol, long *flags, short **next_list, stateitem_T *cur_si, int *ccharp);
 static void syn_remove_pattern(synblock_T *block, int idx);
 static void syn_clear_pattern(synblock_T *block, int i);
@@ -528,28 +538,88 @@ syntax_start(win_T *wp, linenr_T lnum)
     syn_start_line();
 }
 
+#if defined(FEAT_RELTIME) || defined(PROTO)
 /*
- * We cannot simply discard growarrays full of state_items or buf_states; we
- * have to manually release their extmatch pointers first.
+ * Called while waiting for the user to type something: parse the syntax of
+ * the current window beyond what has been displayed and store states in
+ * b_sst_array[] every so many lines, so that jumping far down in a big file
+ * doesn't need to parse all the lines before it.  Only useful when syncing
+ * looks back further than the distance between stored states, e.g. for
+ * ":syn sync fromstart".
+ * Parses for about SYN_IDLE_MSEC msec.
+ * Returns TRUE when something was parsed and there is more to do.
  */
-    static void
-clear_syn_state(synstate_T *p)
+    int
+syn_idle_parse(void)
 {
-    int		i;
-    garray_T	*gap;
+    win_T	*wp = curwin;
+    synblock_T	*block = wp->w_s;
+    buf_T	*buf = wp->w_buffer;
+    linenr_T	line_count = buf->b_ml.ml_line_count;
+    linenr_T	lnum;
+    long	dist;
+    proftime_T	tm;
 
-    if (p->sst_stacksize > SST_FIX_STATES)
+    if (!syntax_present(wp)
+	    || block->b_syn_error
+	    || block->b_syn_slow
+	    || block->b_sst_array == NULL
+	    || block->b_sst_len <= Rows
+	    || block->b_syn_idle_lnum >= line_count
+	    || must_redraw != 0
+	    || got_int
+	    || buf->b_mod_set
+	    || buf->b_ml.ml_mfp == NULL)
+	return FALSE;
+
+    // The distance used by syntax_start() for storing states.
+    dist = line_count / (block->b_sst_len - Rows) + 1;
+    if (block->b_syn_sync_minlines < dist)
+	// A jump syncs near the target line, stored states won't be used.
+	return FALSE;
+
+    profile_setlimit(SYN_IDLE_MSEC, &tm);
+    syn_idle_active = TRUE;
+    syn_idle_timed_out = FALSE;
+    init_regexp_timeout(p_rdt);
+    do
     {
-	gap = &(p->sst_union.sst_ga);
-	for (i = 0; i < gap->ga_len; i++)
-	    unref_extmatch(SYN_STATE_P(gap)[i].bs_extmatch);
-	ga_clear(gap);
-    }
-    else
+	lnum = block->b_syn_idle_lnum + dist;
+	if (lnum > line_count)
+	    lnum = line_count;
+	syntax_start(wp, lnum);
+	if (got_int || syn_idle_timed_out)
+	    break;
+	block->b_syn_idle_lnum = lnum;
+    } while (lnum < line_count && !input_available()
+						&& !profile_passed_limit(&tm));
+    disable_regexp_timeout();
+    syn_idle_active = FALSE;
+
+    if (got_int || syn_idle_timed_out)
     {
-	for (i = 0; i < p->sst_stacksize; i++)
-	    unref_extmatch(p->sst_union.sst_stack[i].bs_extmatch);
+	// The states computed for the last lines may be wrong.
+	invalidate_current_state();
+	syn_stack_free_all(block);
+	// Don't try again, a redraw would time out as well, or the user
+	// doesn't want it.  Must be done after syn_stack_free_all().
+	block->b_syn_idle_lnum = MAXLNUM;
+	return FALSE;
     }
+    return block->b_syn_idle_lnum < line_count;
+}
+#endif
+
+/*
+ * Release the state stack of entry "p" in the b_sst_array[] of "block".
+ */
+    static void
+clear_syn_state(synblock_T *block, synstate_T *p)
+{
+    if (p->sst_stack == NULL)
+	return;
+    syn_stack_unref(block, p->sst_stack);
+    p->sst_stack = NULL;
 }
 
 /*
@@ -1018,8 +1088,11 @@ syn_update_ends(int startofline)
  * For not displayed lines, an entry is stored for every so many lines.  These
  * entries will be used e.g., when scrolling backwards.  The distance between
  * entries depends on the number of lines in the buffer.  For small buffers
- * the distance is fixed at SST_DIST, for large buffers there is a fixed
- * number of entries SST_MAX_ENTRIES, and the distance is computed.
+ * the distance is fixed at SST_DIST, for large buffers the number of entries
+ * is limited by 'synmaxmem', and the distance is computed.
+ *
+ * The state stacks are kept separately in b_sst_stacks[], with a reference
+ * count.  Many lines start with the same stack, it is stored only once.
  */
 
     static void
@@ -1027,14 +1100,21 @@ syn_stack_free_block(synblock_T *block)
 {
     synstate_T	*p;
 
+    syn_lines_free(block);
     if (block->b_sst_array == NULL)
 	return;
 
     FOR_ALL_SYNSTATES(block, p)
-	clear_syn_state(p);
+	clear_syn_state(block, p);
     VIM_CLEAR(block->b_sst_array);
     block->b_sst_first = NULL;
     block->b_sst_len = 0;
+    // All stacks were freed when the last entry using them was cleared.
+    VIM_CLEAR(block->b_sst_stacks);
+    block->b_sst_stacks_len = 0;
+#ifdef FEAT_RELTIME
+    block->b_syn_idle_lnum = 0;
+#endif
 }
 /*
  * Free b_sst_array[] for buffer "buf".
@@ -1069,14 +1149,30 @@ syn_stack_free_all(synblock_T *block)
 syn_stack_alloc(void)
 {
     long	len;
+    long	max_len;
+    size_t	mem;
     synstate_T	*to, *from;
     synstate_T	*sstp;
 
+    // The entries and the stacks together should not use more than
+    // 'synmaxmem' Kbyte.
+    if (p_smm <= 0
+	    || (size_t)p_smm * 1024 <= (size_t)syn_block->b_sst_stackmem)
+	max_len = SST_MIN_ENTRIES;
+    else
+    {
+	mem = ((size_t)p_smm * 1024 - syn_block->b_sst_stackmem)
+							  / sizeof(synstate_T);
+	max_len = mem > (size_t)MAXLNUM ? MAXLNUM : (long)mem;
+	if (max_len < SST_MIN_ENTRIES)
+	    max_len = SST_MIN_ENTRIES;
+    }
+
     len = syn_buf->b_ml.ml_line_count / SST_DIST + Rows * 2;
     if (len < SST_MIN_ENTRIES)
 	len = SST_MIN_ENTRIES;
-    else if (len > SST_MAX_ENTRIES)
-	len = SST_MAX_ENTRIES;
+    else if (len > max_len)
+	len = max_len;
     if (syn_block->b_sst_len > len * 2 || syn_block->b_sst_len < len)
     {
 	// Allocate 50% too much, to avoid reallocating too often.
@@ -1084,8 +1180,8 @@ syn_stack_alloc(void)
 	len = (len + len / 2) / SST_DIST + Rows * 2;
 	if (len < SST_MIN_ENTRIES)
 	    len = SST_MIN_ENTRIES;
-	else if (len > SST_MAX_ENTRIES)
-	    len = SST_MAX_ENTRIES;
+	else if (len > max_len)
+	    len = max_len;
 
 	if (syn_block->b_sst_array != NULL)
 	{
@@ -1163,7 +1259,30 @@ syn_stack_apply_changes_block(synblock_T *block, buf_T *buf)
 {
     synstate_T	*p, *prev, *np;
     linenr_T	n;
+    int		i;
 
+    // Drop the stored attributes of changed lines and the lines below them.
+    if (block->b_syn_lines != NULL)
+    {
+	synlines_T *sl = block->b_syn_lines;
+
+	for (i = 0; i < SYN_LINES_SIZE; ++i)
+	    if (sl->sls_lines[i].sl_lnum != 0 && sl->sls_lines[i].sl_lnum
+			    + block->b_syn_sync_linebreaks >= buf->b_mod_top)
+	    {
+		sl->sls_lines[i].sl_lnum = 0;
+		VIM_CLEAR(sl->sls_lines[i].sl_runs);
+	    }
+	sl->sls_changedtick = CHANGEDTICK(buf);
+    }
+
+#ifdef FEAT_RELTIME
+    // Parsing while idle has to continue from the change, unless it was
+    // stopped.
+    if (block->b_syn_idle_lnum != MAXLNUM
+				  && block->b_syn_idle_lnum > buf->b_mod_top - 1)
+	block->b_syn_idle_lnum = buf->b_mod_top - 1;
+#endif
     prev = NULL;
     for (p = block->b_sst_first; p != NULL; )
     {
@@ -1262,6 +1381,10 @@ syn_stack_cleanup(void)
 	    syn_stack_free_entry(syn_block, p);
 	    p = prev;
 	    retval = TRUE;
+#ifdef FEAT_PROFILE
+	    if (syn_time_on)
+		++syn_block->b_sst_dropped;
+#endif
 	}
     }
     return retval;
@@ -1274,7 +1397,7 @@ syn_stack_cleanup(void)
     static void
 syn_stack_free_entry(synblock_T *block, synstate_T *p)
 {
-    clear_syn_state(p);
+    clear_syn_state(block, p);
     p->sst_next = block->b_sst_firstfree;
     block->b_sst_firstfree = p;
     ++block->b_sst_freecount;
@@ -1300,6 +1423,174 @@ syn_stack_find_entry(linenr_T lnum)
     return prev;
 }
 
+#define SST_HASH_MIN	64	// initial size of b_sst_stacks[]
+
+/*
+ * Compute the hash of the current state stack.
+ */
+    static long_u
+syn_current_hash(void)
+{
+    long_u	hash = current_state.ga_len;
+    stateitem_T	*sip;
+    int		i;
+
+    for (i = 0; i < current_state.ga_len; ++i)
+    {
+	sip = &CUR_STATE(i);
+	hash = hash * 31 + (long_u)sip->si_idx;
+	hash = hash * 31 + (long_u)sip->si_flags;
+#ifdef FEAT_CONCEAL
+	hash = hash * 31 + (long_u)sip->si_seqnr;
+	hash = hash * 31 + (long_u)sip->si_cchar;
+#endif
+	hash = hash * 31 + (long_u)sip->si_extmatch;
+    }
+    return hash;
+}
+
+/*
+ * Return TRUE when "ssp" stores exactly the current state stack.
+ */
+    static int
+syn_stack_is_current(synstack_T *ssp)
+{
+    bufstate_T	*bp = ssp->ss_states;
+    stateitem_T	*sip;
+    int		i;
+
+    if (ssp->ss_size != current_state.ga_len)
+	return FALSE;
+    for (i = 0; i < ssp->ss_size; ++i)
+    {
+	sip = &CUR_STATE(i);
+	if (bp[i].bs_idx != sip->si_idx
+		|| bp[i].bs_flags != sip->si_flags
+#ifdef FEAT_CONCEAL
+		|| bp[i].bs_seqnr != sip->si_seqnr
+		|| bp[i].bs_cchar != sip->si_cchar
+#endif
+		|| bp[i].bs_extmatch != sip->si_extmatch)
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Make the hash table with stacks of "block" bigger when it gets full.
+ */
+    static void
+syn_stack_grow_hash(synblock_T *block)
+{
+    synstack_T	**stacks;
+    synstack_T	*ssp, *next;
+    int		len;
+    int		i;
+
+    if (block->b_sst_stackcount < block->b_sst_stacks_len * 2)
+	return;
+    len = block->b_sst_stacks_len == 0 ? SST_HASH_MIN
+						 : block->b_sst_stacks_len * 4;
+    stacks = ALLOC_CLEAR_MULT(synstack_T *, len);
+    if (stacks == NULL)
+	return;		// out of memory, keep the old table
+    for (i = 0; i < block->b_sst_stacks_len; ++i)
+	for (ssp = block->b_sst_stacks[i]; ssp != NULL; ssp = next)
+	{
+	    next = ssp->ss_next;
+	    ssp->ss_next = stacks[ssp->ss_hash & (len - 1)];
+	    stacks[ssp->ss_hash & (len - 1)] = ssp;
+	}
+    vim_free(block->b_sst_stacks);
+    block->b_sst_stacks = stacks;
+    block->b_sst_stacks_len = len;
+}
+
+/*
+ * Get a stack with the current state, to be stored in b_sst_array[] of
+ * "block".  An identical stack stored for another line is shared.
+ * Returns NULL when the current state stack is empty or out of memory.
+ */
+    static synstack_T *
+syn_stack_get_current(synblock_T *block)
+{
+    synstack_T	*ssp;
+    synstack_T	**head;
+    long_u	hash;
+    size_t	len;
+    int		i;
+
+    if (current_state.ga_len == 0)
+	return NULL;
+    syn_stack_grow_hash(block);
+    if (block->b_sst_stacks == NULL)
+	return NULL;
+
+    hash = syn_current_hash();
+    head = &block->b_sst_stacks[hash & (block->b_sst_stacks_len - 1)];
+    for (ssp = *head; ssp != NULL; ssp = ssp->ss_next)
+	if (ssp->ss_hash == hash && syn_stack_is_current(ssp))
+	{
+	    ++ssp->ss_refcount;
+#ifdef FEAT_PROFILE
+	    if (syn_time_on)
+		++block->b_sst_shared;
+#endif
+	    return ssp;
+	}
+
+    len = offsetof(synstack_T, ss_states)
+				 + current_state.ga_len * sizeof(bufstate_T);
+    ssp = alloc(len);
+    if (ssp == NULL)
+	return NULL;
+    ssp->ss_hash = hash;
+    ssp->ss_refcount = 1;
+    ssp->ss_size = current_state.ga_len;
+    for (i = 0; i < ssp->ss_size; ++i)
+    {
+	ssp->ss_states[i].bs_idx = CUR_STATE(i).si_idx;
+	ssp->ss_states[i].bs_flags = CUR_STATE(i).si_flags;
+#ifdef FEAT_CONCEAL
+	ssp->ss_states[i].bs_seqnr = CUR_STATE(i).si_seqnr;
+	ssp->ss_states[i].bs_cchar = CUR_STATE(i).si_cchar;
+#endif
+	ssp->ss_states[i].bs_extmatch = ref_extmatch(CUR_STATE(i).si_extmatch);
+    }
+    ssp->ss_next = *head;
+    *head = ssp;
+    ++block->b_sst_stackcount;
+    block->b_sst_stackmem += (long)len;
+    return ssp;
+}
+
+/*
+ * Stop using stack "ssp" of "block".  Free it when no other entry uses it.
+ */
+    static void
+syn_stack_unref(synblock_T *block, synstack_T *ssp)
+{
+    synstack_T	**pp;
+    int		i;
+
+    if (--ssp->ss_refcount > 0)
+	return;
+
+    pp = &block->b_sst_stacks[ssp->ss_hash & (block->b_sst_stacks_len - 1)];
+    for ( ; *pp != NULL; pp = &(*pp)->ss_next)
+	if (*pp == ssp)
+	{
+	    *pp = ssp->ss_next;
+	    break;
+	}
+    for (i = 0; i < ssp->ss_size; ++i)
+	unref_extmatch(ssp->ss_states[i].bs_extmatch);
+    --block->b_sst_stackcount;
+    block->b_sst_stackmem -= (long)(offsetof(synstack_T, ss_states)
+					     + ssp->ss_size * sizeof(bufstate_T));
+    vim_free(ssp);
+}
+
 /*
  * Try saving the current state in b_sst_array[].
  * The current state must be valid for the start of the current_lnum line!
@@ -1309,7 +1600,6 @@ store_current_state(void)
 {
     int		i;
     synstate_T	*p;
-    bufstate_T	*bp;
     stateitem_T	*cur_si;
     synstate_T	*sp = syn_stack_find_entry(current_lnum);
 
@@ -1383,38 +1673,19 @@ store_current_state(void)
 		sp->sst_next = p;
 	    }
 	    sp = p;
-	    sp->sst_stacksize = 0;
+	    sp->sst_stack = NULL;
 	    sp->sst_lnum = current_lnum;
 	}
     }
     if (sp != NULL)
     {
 	// When overwriting an existing state stack, clear it first
-	clear_syn_state(sp);
-	sp->sst_stacksize = current_state.ga_len;
-	if (current_state.ga_len > SST_FIX_STATES)
-	{
-	    // Need to clear it, might be something remaining from when the
-	    // length was less than SST_FIX_STATES.
-	    ga_init2(&sp->sst_union.sst_ga, sizeof(bufstate_T), 1);
-	    if (ga_grow(&sp->sst_union.sst_ga, current_state.ga_len) == FAIL)
-		sp->sst_stacksize = 0;
-	    else
-		sp->sst_union.sst_ga.ga_len = current_state.ga_len;
-	    bp = SYN_STATE_P(&(sp->sst_union.sst_ga));
-	}
-	else
-	    bp = sp->sst_union.sst_stack;
-	for (i = 0; i < sp->sst_stacksize; ++i)
-	{
-	    bp[i].bs_idx = CUR_STATE(i).si_idx;
-	    bp[i].bs_flags = CUR_STATE(i).si_flags;
-#ifdef FEAT_CONCEAL
-	    bp[i].bs_seqnr = CUR_STATE(i).si_seqnr;
-	    bp[i].bs_cchar = CUR_STATE(i).si_cchar;
+	clear_syn_state(syn_block, sp);
+	sp->sst_stack = syn_stack_get_current(syn_block);
+#ifdef FEAT_PROFILE
+	if (syn_time_on)
+	    ++syn_block->b_sst_stored;
 #endif
-	    bp[i].bs_extmatch = ref_extmatch(CUR_STATE(i).si_extmatch);
-	}
 	sp->sst_next_flags = current_next_flags;
 	sp->sst_next_list = current_next_list;
 	sp->sst_tick = display_tick;
@@ -1436,14 +1707,11 @@ load_current_state(synstate_T *from)
     clear_current_state();
     validate_current_state();
     keepend_level = -1;
-    if (from->sst_stacksize
-	    && ga_grow(&current_state, from->sst_stacksize) == OK)
+    if (from->sst_stack != NULL
+	    && ga_grow(&current_state, from->sst_stack->ss_size) == OK)
     {
-	if (from->sst_stacksize > SST_FIX_STATES)
-	    bp = SYN_STATE_P(&(from->sst_union.sst_ga));
-	else
-	    bp = from->sst_union.sst_stack;
-	for (i = 0; i < from->sst_stacksize; ++i)
+	bp = from->sst_stack->ss_states;
+	for (i = 0; i < from->sst_stack->ss_size; ++i)
 	{
 	    CUR_STATE(i).si_idx = bp[i].bs_idx;
 	    CUR_STATE(i).si_flags = bp[i].bs_flags;
@@ -1463,7 +1731,7 @@ load_current_state(synstate_T *from)
 		CUR_STATE(i).si_next_list = NULL;
 	    update_si_attr(i);
 	}
-	current_state.ga_len = from->sst_stacksize;
+	current_state.ga_len = from->sst_stack->ss_size;
     }
     current_next_list = from->sst_next_list;
     current_next_flags = from->sst_next_flags;
@@ -1482,15 +1750,15 @@ syn_stack_equal(synstate_T *sp)
     reg_extmatch_T	*six, *bsx;
 
     // First a quick check if the stacks have the same size end nextlist.
-    if (sp->sst_stacksize != current_state.ga_len
+    if ((sp->sst_stack == NULL ? 0 : sp->sst_stack->ss_size)
+						       != current_state.ga_len
 	    || sp->sst_next_list != current_next_list)
 	return FALSE;
+    if (current_state.ga_len == 0)
+	return TRUE;
 
     // Need to compare all states on both stacks.
-    if (sp->sst_stacksize > SST_FIX_STATES)
-	bp = SYN_STATE_P(&(sp->sst_union.sst_ga));
-    else
-	bp = sp->sst_union.sst_stack;
+    bp = sp->sst_stack->ss_states;
 
     for (i = current_state.ga_len; --i >= 0; )
     {
@@ -1724,6 +1992,244 @@ get_syntax_attr(
     return attr;
 }
 
+/*
+ * The syntax attributes of lines that were drawn are kept in b_syn_lines, so
+ * that drawing such a line again, e.g. when moving the cursor with
+ * 'cursorline' set or when scrolling back, does not require parsing it.
+ * For each line the columns with the same attributes are stored as a run.
+ * Only the columns that were drawn are stored, starting at column zero.
+ * The stored lines are dropped when the text changes (see
+ * syn_stack_apply_changes_block()), when the syntax items change (see
+ * syn_stack_free_block()) and when syn_lines_tick or 'synmaxcol' changes.
+ */
+static synline_T *slc_hit = NULL;	// line used by syn_line_cache_attr()
+static int	slc_hit_idx = 0;	// index of the run last used
+static synline_T slc_rec;		// line being recorded
+static int	slc_rec_active = FALSE;	// TRUE while adding columns
+static win_T	*slc_rec_win = NULL;	// window of the line being recorded
+static garray_T slc_rec_runs = {0, 0, sizeof(synrun_T), 50, NULL};
+
+/*
+ * Drop the stored lines in "sl".
+ */
+    static void
+syn_lines_clear(synlines_T *sl)
+{
+    int		i;
+
+    for (i = 0; i < SYN_LINES_SIZE; ++i)
+    {
+	sl->sls_lines[i].sl_lnum = 0;
+	VIM_CLEAR(sl->sls_lines[i].sl_runs);
+    }
+    slc_hit = NULL;
+}
+
+/*
+ * Free the stored lines of "block".
+ */
+    static void
+syn_lines_free(synblock_T *block)
+{
+    if (block->b_syn_lines == NULL)
+	return;
+    syn_lines_clear(block->b_syn_lines);
+    VIM_CLEAR(block->b_syn_lines);
+}
+
+/*
+ * Make sure the stored lines in "sl" can be used for buffer "buf", drop them
+ * when something changed that affects all lines.
+ */
+    static void
+syn_lines_validate(synlines_T *sl, buf_T *buf)
+{
+    if (sl->sls_changedtick == CHANGEDTICK(buf)
+	    && sl->sls_tick == syn_lines_tick
+	    && sl->sls_smc == buf->b_p_smc)
+	return;
+    syn_lines_clear(sl);
+    sl->sls_changedtick = CHANGEDTICK(buf);
+    sl->sls_tick = syn_lines_tick;
+    sl->sls_smc = buf->b_p_smc;
+}
+
+/*
+ * Check if the syntax attributes of line "lnum" in window "wp" were stored
+ * when it was drawn before.  "need_spell" is TRUE when "can_spell" must be
+ * available.
+ * Returns TRUE when syn_line_cache_attr() can be used instead of
+ * syntax_start() and get_syntax_attr().
+ */
+    int
+syn_line_cache_find(win_T *wp, linenr_T lnum, int need_spell)
+{
+    synlines_T	*sl = wp->w_s->b_syn_lines;
+    synline_T	*line;
+
+    slc_hit = NULL;
+    slc_rec.sl_lnum = 0;
+    if (sl == NULL)
+	return FALSE;
+    syn_lines_validate(sl, wp->w_buffer);
+    line = &sl->sls_lines[lnum % SYN_LINES_SIZE];
+    if (line->sl_lnum != lnum || (need_spell && !line->sl_spell))
+	return FALSE;
+    slc_hit = line;
+    slc_hit_idx = 0;
+    return TRUE;
+}
+
+/*
+ * Get the stored syntax attributes for column "col" of the line found with
+ * syn_line_cache_find().  Like get_syntax_attr(), also sets "can_spell" when
+ * not NULL and what get_syntax_info() and syn_get_sub_char() return.
+ * Returns -1 when "col" was not stored, the line needs to be parsed.
+ */
+    int
+syn_line_cache_attr(colnr_T col, int *can_spell)
+{
+    synrun_T	*runs;
+    int		i = slc_hit_idx;
+
+    if (slc_hit == NULL || col >= slc_hit->sl_endcol)
+	return -1;
+
+    // Usually the columns are used in sequence, start at the run used last.
+    runs = slc_hit->sl_runs;
+    if (runs[i].sr_col > col)
+	i = 0;
+    while (i + 1 < slc_hit->sl_count && runs[i + 1].sr_col <= col)
+	++i;
+    slc_hit_idx = i;
+
+    if (can_spell != NULL)
+	*can_spell = runs[i].sr_can_spell;
+#ifdef FEAT_CONCEAL
+    current_flags = runs[i].sr_flags;
+    current_seqnr = runs[i].sr_seqnr;
+    current_sub_char = runs[i].sr_cchar;
+#endif
+    return runs[i].sr_attr;
+}
+
+/*
+ * Start storing the syntax attributes of line "lnum" in window "wp", to be
+ * called after syntax_start().  "need_spell" is as for syn_line_cache_find().
+ */
+    void
+syn_line_cache_start(win_T *wp, linenr_T lnum, int need_spell)
+{
+    slc_hit = NULL;
+    slc_rec.sl_lnum = lnum;
+    slc_rec.sl_spell = need_spell;
+    slc_rec.sl_endcol = 0;
+    slc_rec_active = TRUE;
+    slc_rec_win = wp;
+    slc_rec_runs.ga_len = 0;
+}
+
+/*
+ * Store the syntax attributes "attr" and "can_spell" that get_syntax_attr()
+ * returned for column "col".  "ptr" points to the character at "col".
+ * Columns must be added in sequence, when one is skipped the remaining
+ * columns are not stored.
+ */
+    void
+syn_line_cache_add(colnr_T col, char_u *ptr, int attr, int *can_spell)
+{
+    synrun_T	*run = NULL;
+    int		spell = can_spell == NULL || *can_spell;
+
+    if (!slc_rec_active || col < slc_rec.sl_endcol)
+	return;
+    if (col > slc_rec.sl_endcol)
+    {
+	slc_rec_active = FALSE;
+	return;
+    }
+
+    if (slc_rec_runs.ga_len > 0)
+	run = (synrun_T *)slc_rec_runs.ga_data + slc_rec_runs.ga_len - 1;
+    if (run == NULL || run->sr_attr != attr || run->sr_can_spell != spell
+#ifdef FEAT_CONCEAL
+	    || run->sr_flags != current_flags
+	    || run->sr_seqnr != current_seqnr
+	    || run->sr_cchar != current_sub_char
+#endif
+	    )
+    {
+	if (ga_grow(&slc_rec_runs, 1) == FAIL)
+	{
+	    slc_rec_active = FALSE;
+	    return;
+	}
+	run = (synrun_T *)slc_rec_runs.ga_data + slc_rec_runs.ga_len++;
+	run->sr_col = col;
+	run->sr_attr = attr;
+	run->sr_can_spell = spell;
+#ifdef FEAT_CONCEAL
+	run->sr_flags = current_flags;
+	run->sr_seqnr = current_seqnr;
+	run->sr_cchar = current_sub_char;
+#endif
+    }
+    slc_rec.sl_endcol = col + (*ptr == NUL ? 1 : (*mb_ptr2len)(ptr));
+}
+
+/*
+ * Done drawing a line.  When "keep" is TRUE store the syntax attributes added
+ * with syn_line_cache_add(), when it is FALSE they may be invalid.
+ */
+    void
+syn_line_cache_end(int keep)
+{
+    synblock_T	*block;
+    synlines_T	*sl;
+    synline_T	*line;
+    synrun_T	*runs;
+
+    slc_hit = NULL;
+    slc_rec_active = FALSE;
+    if (slc_rec.sl_lnum == 0 || !keep || slc_rec_runs.ga_len == 0)
+    {
+	slc_rec.sl_lnum = 0;
+	return;
+    }
+
+    block = slc_rec_win->w_s;
+    sl = block->b_syn_lines;
+
+    if (sl == NULL)
+    {
+	sl = ALLOC_CLEAR_ONE(synlines_T);
+	if (sl == NULL)
+	{
+	    slc_rec.sl_lnum = 0;
+	    return;
+	}
+	block->b_syn_lines = sl;
+    }
+    syn_lines_validate(sl, slc_rec_win->w_buffer);
+
+    runs = ALLOC_MULT(synrun_T, slc_rec_runs.ga_len);
+    if (runs != NULL)
+    {
+	mch_memmove(runs, slc_rec_runs.ga_data,
+				    sizeof(synrun_T) * slc_rec_runs.ga_len);
+	line = &sl->sls_lines[slc_rec.sl_lnum % SYN_LINES_SIZE];
+	vim_free(line->sl_runs);
+	*line = slc_rec;
+	line->sl_count = slc_rec_runs.ga_len;
+	line->sl_runs = runs;
+    }
+    slc_rec.sl_lnum = 0;
+
+    // Don't keep a lot of memory around after drawing a very long line.
+    if (slc_rec_runs.ga_maxlen > 1000)
+	ga_clear(&slc_rec_runs);
+}
+
 /*
  * Get syntax attributes for current_lnum, current_col.
  */
@@ -3179,7 +3685,9 @@ syn_regexec(
     }
 #endif
 #ifdef FEAT_RELTIME
-    if (timed_out && redrawtime_limit_set && !syn_win->w_s->b_syn_slow)
+    if (timed_out && syn_idle_active)
+	syn_idle_timed_out = TRUE;
+    else if (timed_out && redrawtime_limit_set && !syn_win->w_s->b_syn_slow)
     {
 	syn_win->w_s->b_syn_slow = TRUE;
 	msg(_("'redrawtime' exceeded, syntax highlighting disabled"));
@@ -3195,6 +3703,260 @@ syn_regexec(
     return FALSE;
 }
 
+/*
+ * Compare two keywords for qsort().
+ */
+    static int
+keywtrie_compare(const void *s1, const void *s2)
+{
+    return STRCMP(*(char_u **)s1, *(char_u **)s2);
+}
+
+#define KEYWSTATE(gap, i) (((keywstate_T *)(gap)->ga_data)[i])
+
+/*
+ * Make sure trie "gap" has at least "len" states, the new ones not used.
+ */
+    static int
+keywtrie_grow(garray_T *gap, int len)
+{
+    if (len <= gap->ga_len)
+	return OK;
+    if (ga_grow(gap, len - gap->ga_len) == FAIL)
+	return FAIL;
+    for ( ; gap->ga_len < len; ++gap->ga_len)
+    {
+	KEYWSTATE(gap, gap->ga_len).ks_base = 0;
+	KEYWSTATE(gap, gap->ga_len).ks_check = -1;
+	KEYWSTATE(gap, gap->ga_len).ks_kp = NULL;
+    }
+    return OK;
+}
+
+/*
+ * Fill in "state" of trie "gap" for the sorted keywords "keys[lo]" to
+ * "keys[hi - 1]", which all have the same first "depth" bytes, and add the
+ * states that follow it.  "*searchp" is where searching for unused states
+ * starts, it moves forward when the states before it are mostly used.
+ */
+    static int
+keywtrie_add_state(
+    garray_T	*gap,
+    int		state,
+    int		*searchp,
+    char_u	**keys,
+    int		lo,
+    int		hi,
+    int		depth)
+{
+    char_u	bytes[256];
+    int		count = 0;
+    int		base;
+    int		pos;
+    int		used = 0;
+    int		first_free = -1;
+    int		i;
+    int		next;
+
+    // Keys are unique and sorted, a key ending here can only be the first.
+    if (lo < hi && keys[lo][depth] == NUL)
+	KEYWSTATE(gap, state).ks_kp = HIKEY2KE(keys[lo++]);
+    if (lo == hi)
+	return OK;
+
+    for (i = lo; i < hi; ++i)
+	if (i == lo || keys[i][depth] != keys[i - 1][depth])
+	    bytes[count++] = keys[i][depth];
+
+    // Find a base for which the states for all bytes are not used.  Only
+    // positions where the state for the first byte is not used can be it.
+    for (pos = *searchp > bytes[0] ? *searchp : bytes[0] + 1; ; ++pos)
+    {
+	if (keywtrie_grow(gap, pos + 256) == FAIL)
+	    return FAIL;
+	if (KEYWSTATE(gap, pos).ks_check != -1)
+	{
+	    ++used;
+	    continue;
+	}
+	if (first_free < 0)
+	    first_free = pos;
+	base = pos - bytes[0];
+	for (i = 1; i < count; ++i)
+	    if (KEYWSTATE(gap, base + bytes[i]).ks_check != -1)
+		break;
+	if (i == count)
+	    break;
+    }
+    // Searching through mostly used states again and again is slow, skip
+    // them next time.  This leaves a few states unused.
+    if (used * 20 >= (pos - *searchp + 1) * 19)
+	*searchp = pos;
+    else if (first_free > *searchp)
+	*searchp = first_free;
+
+    KEYWSTATE(gap, state).ks_base = base;
+    for (i = 0; i < count; ++i)
+	KEYWSTATE(gap, base + bytes[i]).ks_check = state;
+
+    for (i = 0; lo < hi; lo = next, ++i)
+    {
+	for (next = lo + 1; next < hi && keys[next][depth] == keys[lo][depth];
+									++next)
+	    ;
+	if (keywtrie_add_state(gap, base + bytes[i], searchp,
+					  keys, lo, next, depth + 1) == FAIL)
+	    return FAIL;
+    }
+    return OK;
+}
+
+/*
+ * Return trie "gap" for the keywords in "ht", building it when it is empty.
+ * Returns NULL when out of memory.
+ */
+    static garray_T *
+keywtrie_get(hashtab_T *ht, garray_T *gap)
+{
+    char_u	**keys;
+    hashitem_T	*hi;
+    int		todo;
+    int		count = 0;
+    int		search = 1;
+    int		ret;
+
+    if (gap->ga_len > 0)
+	return gap;
+
+    keys = ALLOC_MULT(char_u *, ht->ht_used + 1);
+    if (keys == NULL)
+	return NULL;
+    todo = (int)ht->ht_used;
+    FOR_ALL_HASHTAB_ITEMS(ht, hi, todo)
+    {
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    --todo;
+	    // A longer keyword never matches, see keywtrie_find().
+	    if (STRLEN(hi->hi_key) <= MAXKEYWLEN)
+		keys[count++] = hi->hi_key;
+	}
+    }
+    qsort(keys, (size_t)count, sizeof(char_u *), keywtrie_compare);
+
+    // The root is state zero, it is used but has no previous state.
+    ga_init2(gap, sizeof(keywstate_T), 1000);
+    ret = keywtrie_grow(gap, 1);
+    if (ret == OK)
+    {
+	KEYWSTATE(gap, 0).ks_check = -2;
+	ret = keywtrie_add_state(gap, 0, &search, keys, 0, count, 0);
+    }
+    vim_free(keys);
+    if (ret == FAIL)
+    {
+	ga_clear(gap);
+	return NULL;
+    }
+    return gap;
+}
+
+/*
+ * Free the compiled keywords of "block", they are built again when needed.
+ * Must be called whenever the keywords change.
+ */
+    static void
+keywtrie_clear(synblock_T *block)
+{
+    ga_clear(&block->b_keywtrie);
+    ga_clear(&block->b_keywtrie_ic);
+}
+
+/*
+ * Follow byte "c" from "state" in trie "gap".
+ * Returns the next state, -1 when there is none.
+ */
+    static inline int
+keywtrie_next(garray_T *gap, int state, int c)
+{
+    int		next = KEYWSTATE(gap, state).ks_base + c;
+
+    if (next < gap->ga_len && KEYWSTATE(gap, next).ks_check == state)
+	return next;
+    return -1;
+}
+
+/*
+ * Find the keyword at "kwp" in trie "kt", matching case, and in trie "kt_ic",
+ * ignoring case.  Either trie may be NULL.  The keyword must be followed by a
+ * non-keyword character.  Both tries are walked at the same time, so that
+ * each character of the text is only looked at once.
+ * Sets "*kpp" and "*kp_icp" to the first keyentry for the keyword, NULL when
+ * there is none, and "*kwlenp" to the byte length of the keyword.
+ */
+    static void
+keywtrie_find(
+    garray_T	*kt,
+    garray_T	*kt_ic,
+    char_u	*kwp,
+    keyentry_T	**kpp,
+    keyentry_T	**kp_icp,
+    int		*kwlenp)
+{
+    int		state = kt == NULL ? -1 : 0;
+    int		state_ic = kt_ic == NULL ? -1 : 0;
+    int		kwlen = 0;
+    int		len;
+    char_u	folded[MAXKEYWLEN + 1];
+    char_u	*p;
+    int		i;
+
+    *kpp = NULL;
+    *kp_icp = NULL;
+
+    // The first character was already checked to be a keyword character.
+    do
+    {
+	p = kwp + kwlen;
+	// An ASCII character is one byte, unless a composing character
+	// follows.
+	if (!has_mbyte || (*p < 0x80 && p[1] < 0x80))
+	    len = 1;
+	else
+	    len = (*mb_ptr2len)(p);
+	if (kwlen + len > MAXKEYWLEN)
+	    return;
+
+	for (i = 0; i < len && state >= 0; ++i)
+	    state = keywtrie_next(kt, state, p[i]);
+
+	if (state_ic >= 0)
+	{
+	    // Fold case in the same way as str_foldcase() does.
+	    if (len == 1 && *p < 0x80)
+		state_ic = keywtrie_next(kt_ic, state_ic,
+				  enc_utf8 ? utf_tolower(*p) : TOLOWER_LOC(*p));
+	    else
+	    {
+		(void)str_foldcase(p, len, folded, MAXKEYWLEN + 1);
+		for (i = 0; folded[i] != NUL && state_ic >= 0; ++i)
+		    state_ic = keywtrie_next(kt_ic, state_ic, folded[i]);
+	    }
+	}
+
+	if (state < 0 && state_ic < 0)
+	    return;
+	kwlen += len;
+    }
+    while (vim_iswordp_buf(kwp + kwlen, syn_buf));
+
+    if (state >= 0)
+	*kpp = KEYWSTATE(kt, state).ks_kp;
+    if (state_ic >= 0)
+	*kp_icp = KEYWSTATE(kt_ic, state_ic).ks_kp;
+    *kwlenp = kwlen;
+}
+
 /*
  * Check one position in a line for a matching keyword.
  * The caller must check if a keyword can start at startcol.
@@ -3211,48 +3973,28 @@ check_keyword_id(
     int		*ccharp UNUSED)	// conceal substitution char
 {
     keyentry_T	*kp;
-    char_u	*kwp;
+    keyentry_T	*found[2];
     int		round;
-    int		kwlen;
-    char_u	keyword[MAXKEYWLEN + 1]; // assume max. keyword len is 80
-    hashtab_T	*ht;
-    hashitem_T	*hi;
-
-    // Find first character after the keyword.  First character was already
-    // checked.
-    kwp = line + startcol;
-    kwlen = 0;
-    do
-    {
-	if (has_mbyte)
-	    kwlen += (*mb_ptr2len)(kwp + kwlen);
-	else
-	    ++kwlen;
-    }
-    while (vim_iswordp_buf(kwp + kwlen, syn_buf));
-
-    if (kwlen > MAXKEYWLEN)
-	return 0;
-
-    /*
-     * Must make a copy of the keyword, so we can add a NUL and make it
-     * lowercase.
-     */
-    vim_strncpy(keyword, kwp, kwlen);
+    int		kwlen = 0;
+    garray_T	*kt = NULL;
+    garray_T	*kt_ic = NULL;
+
+    // The keywords are looked up in a trie, which stops at the first byte
+    // that no keyword continues with.
+    if (syn_block->b_keywtab.ht_used > 0)
+	kt = keywtrie_get(&syn_block->b_keywtab, &syn_block->b_keywtrie);
+    if (syn_block->b_keywtab_ic.ht_used > 0)
+	kt_ic = keywtrie_get(&syn_block->b_keywtab_ic,
+						    &syn_block->b_keywtrie_ic);
+    keywtrie_find(kt, kt_ic, line + startcol, &found[0], &found[1], &kwlen);
 
     /*
      * Try twice:
      * 1. matching case
      * 2. ignoring case
      */
-    for (round = 1; round <= 2; ++round)
+    for (round = 0; round < 2; ++round)
     {
-	ht = round == 1 ? &syn_block->b_keywtab : &syn_block->b_keywtab_ic;
-	if (ht->ht_used == 0)
-	    continue;
-	if (round == 2)	// ignore case
-	    (void)str_foldcase(kwp, kwlen, keyword, MAXKEYWLEN + 1);
-
 	/*
 	 * Find keywords that match.  There can be several with different
 	 * attributes.
@@ -3260,26 +4002,24 @@ check_keyword_id(
 	 *  Accept a not-contained keyword at toplevel.
 	 *  Accept a keyword at other levels only if it is in the contains list.
 	 */
-	hi = hash_find(ht, keyword);
-	if (!HASHITEM_EMPTY(hi))
-	    for (kp = HI2KE(hi); kp != NULL; kp = kp->ke_next)
+	for (kp = found[round]; kp != NULL; kp = kp->ke_next)
+	{
+	    if (current_next_list != 0
+		    ? in_id_list(NULL, current_next_list, &kp->k_syn, 0)
+		    : (cur_si == NULL
+			? !(kp->flags & HL_CONTAINED)
+			: in_id_list(cur_si, cur_si->si_cont_list,
+				  &kp->k_syn, kp->flags)))
 	    {
-		if (current_next_list != 0
-			? in_id_list(NULL, current_next_list, &kp->k_syn, 0)
-			: (cur_si == NULL
-			    ? !(kp->flags & HL_CONTAINED)
-			    : in_id_list(cur_si, cur_si->si_cont_list,
-				      &kp->k_syn, kp->flags)))
-		{
-		    *endcolp = startcol + kwlen;
-		    *flagsp = kp->flags;
-		    *next_listp = kp->next_list;
+		*endcolp = startcol + kwlen;
+		*flagsp = kp->flags;
+		*next_listp = kp->next_list;
 #ifdef FEAT_CONCEAL
-		    *ccharp = kp->k_char;
+		*ccharp = kp->k_char;
 #endif
-		    return kp->k_syn.id;
-		}
+		return kp->k_syn.id;
 	    }
+	}
     }
     return 0;
 }
@@ -3499,6 +4239,7 @@ syntax_clear(synblock_T *block)
     // free the keywords
     clear_keywtab(&block->b_keywtab);
     clear_keywtab(&block->b_keywtab_ic);
+    keywtrie_clear(block);
 
     // free the syntax patterns
     for (i = block->b_syn_patterns.ga_len; --i >= 0; )
@@ -3721,6 +4462,7 @@ syn_clear_one(int id, int syncing)
     {
 	(void)syn_clear_keyword(id, &curwin->w_s->b_keywtab);
 	(void)syn_clear_keyword(id, &curwin->w_s->b_keywtab_ic);
+	keywtrie_clear(curwin->w_s);
     }
 
     // clear the patterns for "id"
@@ -4452,6 +5194,7 @@ add_keyword(
 	kp->ke_next = HI2KE(hi);
 	hi->hi_key = KE2HIKEY(kp);
     }
+    keywtrie_clear(curwin->w_s);
 }
 
 /*
@@ -6288,6 +7031,9 @@ ex_syntax(exarg_T *eap)
 
     if (i == (int)ARRAY_LENGTH(subcommands))
 	semsg(_(e_invalid_syntax_subcommand_str), subcmd_name);
+    else if (!eap->skip)
+	// Most subcommands change the attributes of displayed lines.
+	++syn_lines_tick;
 
     vim_free(subcmd_name);
     if (eap->skip)
@@ -6666,6 +7412,9 @@ syntime_clear(void)
 	spp = &(SYN_ITEMS(curwin->w_s)[idx]);
 	syn_clear_time(&spp->sp_time);
     }
+    curwin->w_s->b_sst_stored = 0;
+    curwin->w_s->b_sst_shared = 0;
+    curwin->w_s->b_sst_dropped = 0;
 }
 
 /*
@@ -6722,6 +7471,7 @@ syntime_report(void)
     int		total_count = 0;
     garray_T    ga;
     time_entry_T *p;
+    synblock_T	*block;
 
     if (!syntax_present(curwin))
     {
@@ -6804,6 +7554,26 @@ syntime_report(void)
 	msg_outnum(total_count);
 	msg_puts("\n");
     }
+
+    // Report on the stored states, if any were stored since ":syntime on".
+    block = curwin->w_s;
+    if (!got_int && block->b_sst_stored > 0)
+    {
+	msg_puts("\n");
+	vim_snprintf((char *)IObuff, IOSIZE,
+		_("States stored: %ld, with a shared stack: %ld, dropped: %ld"),
+		block->b_sst_stored, block->b_sst_shared, block->b_sst_dropped);
+	msg_puts((char *)IObuff);
+	msg_puts("\n");
+	vim_snprintf((char *)IObuff, IOSIZE,
+		_("Now %d states using %d stacks, %ld Kbyte"),
+		block->b_sst_len - block->b_sst_freecount,
+		block->b_sst_stackcount,
+		(long)((block->b_sst_len * sizeof(synstate_T)
+				    + block->b_sst_stackmem + 1023) / 1024));
+	msg_puts((char *)IObuff);
+	msg_puts("\n");
+    }
 }
 #endif
 
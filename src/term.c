@@ -2758,13 +2758,22 @@ termcapinit(char_u *name)
 
 /*
  * The number of calls to ui_write is reduced by using "out_buf".
+ * While the screen is being updated "out_buf" may grow up to OUT_MAX_SIZE,
+ * so that a whole screen update can be written in one go.
  */
 #define OUT_SIZE	2047
+#define OUT_MAX_SIZE	(256 * 1024 - 1)
 
 // add one to allow mch_write() in os_win32.c to append a NUL
-static char_u		out_buf[OUT_SIZE + 1];
+static char_u		out_buf_static[OUT_SIZE + 1];
+static char_u		*out_buf = out_buf_static;
 
+static int		out_size = OUT_SIZE; // usable size of out_buf
 static int		out_pos = 0;	// number of chars in out_buf
+static long		out_flushed = 0; // number of chars flushed from out_buf
+static long		out_writes = 0;	// number of times out_buf was written
+static int		out_growing = 0; // grow out_buf instead of flushing
+static int		out_busy = FALSE; // busy writing out_buf
 
 // Since the maximum number of SGR parameters shown as a normal value range is
 // 16, the escape sequence length can be 4 * 16 + lead + tail.
@@ -2784,7 +2793,11 @@ out_flush(void)
     // set out_pos to 0 before ui_write, to avoid recursiveness
     len = out_pos;
     out_pos = 0;
+    out_flushed += len;
+    ++out_writes;
+    out_busy = TRUE;
     ui_write(out_buf, len, FALSE);
+    out_busy = FALSE;
 #ifdef FEAT_EVAL
     if (ch_log_output != FALSE)
     {
@@ -2801,6 +2814,94 @@ out_flush(void)
 #endif
 }
 
+/*
+ * Return the total number of bytes written to the terminal so far, including
+ * what is still in the output buffer.  Used to find out how many bytes a
+ * redraw takes.
+ */
+    long
+out_bytes_written(void)
+{
+    return out_flushed + out_pos;
+}
+
+/*
+ * Return the number of times the output buffer was written.  Used to find out
+ * how many system calls a redraw takes.
+ */
+    long
+out_write_count(void)
+{
+    return out_writes;
+}
+
+/*
+ * Make sure there is room for "room" more bytes in the output buffer.  While
+ * updating the screen the buffer is made bigger, otherwise it is flushed.
+ */
+    static void
+out_make_room(int room)
+{
+    if (out_pos <= out_size - room)
+	return;
+
+    if (out_growing > 0 && !out_busy && out_size < OUT_MAX_SIZE)
+    {
+	int	new_size = out_size * 2 + 1;
+	char_u	*p;
+
+	if (new_size > OUT_MAX_SIZE)
+	    new_size = OUT_MAX_SIZE;
+	p = alloc(new_size + 1);
+	if (p != NULL)
+	{
+	    mch_memmove(p, out_buf, (size_t)out_pos);
+	    if (out_buf != out_buf_static)
+		vim_free(out_buf);
+	    out_buf = p;
+	    out_size = new_size;
+	    return;
+	}
+    }
+    out_flush();
+}
+
+/*
+ * Called when starting to update the screen: from now on the output is
+ * collected in the output buffer, which grows when needed.  When the
+ * terminal supports it the update is started with 't_BS', so that the
+ * terminal shows the result all at once.
+ */
+    void
+out_redraw_start(void)
+{
+    if (out_growing++ > 0)
+	return;
+#ifdef FEAT_GUI
+    if (gui.in_use)
+	return;
+#endif
+    if (*T_BSU != NUL && termcap_active)
+	out_str_nf(T_BSU);
+}
+
+/*
+ * Called when done updating the screen: end the synchronized update and
+ * write the output buffer.
+ */
+    void
+out_redraw_end(void)
+{
+    if (out_growing == 0 || --out_growing > 0)
+	return;
+#ifdef FEAT_GUI
+    if (!gui.in_use)
+#endif
+	if (*T_ESU != NUL && termcap_active)
+	    out_str_nf(T_ESU);
+    out_flush();
+}
+
 /*
  * out_flush_cursor(): flush the output buffer and redraw the cursor.
  * Does not flush recursively in the GUI to avoid slow drawing.
@@ -2830,8 +2931,8 @@ out_flush_cursor(
     void
 out_flush_check(void)
 {
-    if (enc_dbcs != 0 && out_pos >= OUT_SIZE - MB_MAXBYTES)
-	out_flush();
+    if (enc_dbcs != 0)
+	out_make_room(MB_MAXBYTES + 1);
 }
 
 #ifdef FEAT_GUI
@@ -2845,6 +2946,21 @@ out_trash(void)
 }
 #endif
 
+#if defined(EXITFREE)
+/*
+ * Free the output buffer if it was made bigger.
+ */
+    void
+free_out_buf(void)
+{
+    out_flush();
+    if (out_buf != out_buf_static)
+	vim_free(out_buf);
+    out_buf = out_buf_static;
+    out_size = OUT_SIZE;
+}
+#endif
+
 /*
  * out_char(c): put a byte into the output buffer.
  *		Flush it if it becomes full.
@@ -2862,8 +2978,10 @@ out_char(unsigned c)
     out_buf[out_pos++] = c;
 
     // For testing we flush each time.
-    if (out_pos >= OUT_SIZE || p_wd)
+    if (p_wd)
 	out_flush();
+    else
+	out_make_room(1);
 }
 
 /*
@@ -2873,9 +2991,7 @@ out_char(unsigned c)
 out_char_nf(int c)
 {
     out_buf[out_pos++] = (unsigned)c;
-
-    if (out_pos >= OUT_SIZE)
-	out_flush();
+    out_make_room(1);
     return (unsigned)c;
 }
 
@@ -2892,8 +3008,7 @@ out_char_nf(int c)
 out_str_nf(char_u *s)
 {
     // avoid terminal strings being split up
-    if (out_pos > OUT_SIZE - MAX_ESC_SEQ_LEN)
-	out_flush();
+    out_make_room(MAX_ESC_SEQ_LEN);
 
     for (char_u *p = s; *p != NUL; ++p)
 	out_char_nf(*p);
@@ -2927,8 +3042,7 @@ out_str_cf(char_u *s)
 	return;
     }
 #endif
-    if (out_pos > OUT_SIZE - MAX_ESC_SEQ_LEN)
-	out_flush();
+    out_make_room(MAX_ESC_SEQ_LEN);
 #ifdef HAVE_TGETENT
     for (p = s; *s; ++s)
     {
@@ -2995,8 +3109,7 @@ out_str(char_u *s)
     }
 #endif
     // avoid terminal strings being split up
-    if (out_pos > OUT_SIZE - MAX_ESC_SEQ_LEN)
-	out_flush();
+    out_make_room(MAX_ESC_SEQ_LEN);
 #ifdef HAVE_TGETENT
     tputs((char *)s, 1, TPUTSFUNCAST out_char_nf);
 #else
@@ -3024,6 +3137,18 @@ term_cursor_right(int i)
     OUT_STR(tgoto((char *)T_CRI, 0, i));
 }
 
+/*
+ * Return the number of bytes that term_windgoto() or, when "right" is TRUE,
+ * term_cursor_right() would output for the same arguments.
+ */
+    int
+term_goto_len(int row, int col, int right)
+{
+    if (right)
+	return (int)STRLEN(tgoto((char *)T_CRI, 0, col));
+    return (int)STRLEN(tgoto((char *)T_CM, col, row));
+}
+
     void
 term_append_lines(int line_count)
 {
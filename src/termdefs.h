@@ -116,6 +116,8 @@ enum SpecialKey
     KS_FD,	// disable focus event tracking
     KS_FE,	// enable focus event tracking
     KS_CF,	// set terminal alternate font
+    KS_BSU,	// begin synchronized update
+    KS_ESU,	// end synchronized update
     KS_XON	// terminal uses xon/xoff handshaking
 };
 
@@ -225,6 +227,8 @@ extern char_u *(term_strings[]);    // current terminal strings
 #define T_SRI	(TERM_STR(KS_SRI))	// restore icon text
 #define T_FD	(TERM_STR(KS_FD))	// disable focus event tracking
 #define T_FE	(TERM_STR(KS_FE))	// enable focus event tracking
+#define T_BSU	(TERM_STR(KS_BSU))	// begin synchronized update
+#define T_ESU	(TERM_STR(KS_ESU))	// end synchronized update
 #define T_XON	(TERM_STR(KS_XON))	// terminal uses xon/xoff handshaking
 
 typedef enum {
@@ -164,6 +164,8 @@ opt_test.vim: util/gen_opt_test.vim ../optiondefs.h \
 	@ if exist gen_opt_test.log ( type gen_opt_test.log & exit /b 1 )
 
 test_bench_regexp.res: test_bench_regexp.vim
+test_bench_vim9.res: test_bench_vim9.vim
+$(SCRIPTS_BENCH):
 	- if exist benchmark.out $(RM) benchmark.out
 	@ echo $(VIMPROG) > vimcmd
 	$(VIMPROG) -u NONE $(COMMON_ARGS) -S runtest.vim $*.vim
@@ -0,0 +1,67 @@
+" Test for benchmarking the Vim9 script execution
+
+CheckFeature reltime
+
+func Measure(name, Func)
+  let sstart = reltime()
+  call a:Func()
+  let s = 'vim9: ' .. a:name .. ', time: ' .. reltimestr(reltime(sstart))
+  call writefile([s], 'benchmark.out', "a")
+endfunc
+
+def s:NumberLoop()
+  var total = 0
+  var i = 0
+  while i < 2000000
+    total += i % 7
+    i += 1
+  endwhile
+  assert_equal(5999995, total)
+enddef
+
+def s:StringBuild()
+  var parts: list<string> = []
+  var s = ''
+  for i in range(200000)
+    s ..= 'x'
+    if i % 1000 == 999
+      parts->add(s)
+      s = ''
+    endif
+  endfor
+  assert_equal(200000, len(join(parts, '')))
+enddef
+
+def s:ListSort()
+  var l: list<number> = []
+  for i in range(100000)
+    l->add(i * 7919 % 100003)
+  endfor
+  sort(l, 'n')
+  assert_equal(l[0], min(l))
+  sort(l, (a, b) => b - a)
+  assert_equal(l[0], max(l))
+enddef
+
+def s:DictIterate()
+  var d: dict<number> = {}
+  for i in range(100000)
+    d['key' .. i] = i
+  endfor
+  var total = 0
+  for round in range(10)
+    for [key, val] in items(d)
+      total += val
+    endfor
+  endfor
+  assert_equal(10 * 4999950000, total)
+enddef
+
+func Test_Vim9_Benchmark()
+  call Measure('number loop', function('s:NumberLoop'))
+  call Measure('string building', function('s:StringBuild'))
+  call Measure('list sort', function('s:ListSort'))
+  call Measure('dict iteration', function('s:DictIterate'))
+endfunc
+
+" vim: shiftwidth=2 sts=2 expandtab
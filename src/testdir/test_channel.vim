@@ -2802,4 +2802,24 @@ func Test_error_callback_terminal()
   unlet! g:out g:error
 endfunc
 
+" Output of many jobs at the same time is all received.
+func Test_many_jobs_output()
+  CheckUnix
+  let g:Ch_many_out = []
+  let jobs = []
+  for i in range(15)
+    call add(jobs, job_start(['sh', '-c', 'echo out' .. i .. '; echo err' .. i .. ' >&2'],
+          \ #{out_cb: {_, msg -> add(g:Ch_many_out, msg)},
+          \   err_io: i % 2 ? 'out' : 'pipe',
+          \   err_cb: {_, msg -> add(g:Ch_many_out, msg)}}))
+  endfor
+  call WaitForAssert({-> assert_equal(30, len(g:Ch_many_out))})
+  call assert_equal(range(15)->map({_, v -> ['out' .. v, 'err' .. v]})
+        \ ->flatten()->sort(), sort(g:Ch_many_out))
+  for job in jobs
+    call WaitForAssert({-> assert_equal('dead', job_status(job))})
+  endfor
+  unlet g:Ch_many_out
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -692,4 +692,35 @@ func Test_change_wrapped_line_cpo_dollar()
   call StopVimInTerminal(buf)
 endfunc
 
+" A screen update is written to the terminal at once.
+func Test_display_redraw_writes()
+  CheckRunVimInTerminal
+
+  let lines =<< trim END
+      call setline(1, range(1, 100)->map({_, v -> repeat('line ' .. v .. ' ', 20)}))
+      let &t_BS = "\<Esc>[?2026h"
+      let &t_ES = "\<Esc>[?2026l"
+      func Redraw()
+        redraw!
+        call writefile([test_getvalue('redraw_bytes'),
+              \ test_getvalue('redraw_writes')], 'XRedrawWrites')
+      endfunc
+  END
+  call writefile(lines, 'XTestRedrawWrites', 'D')
+  let buf = RunVimInTerminal('-S XTestRedrawWrites', #{rows: 30, cols: 100})
+  call term_sendkeys(buf, ":call Redraw()\<CR>")
+  call WaitForAssert({-> assert_true(filereadable('XRedrawWrites')
+        \ && len(readfile('XRedrawWrites')) == 2)})
+  call WaitForAssert({-> assert_match('^line 1 line 1 ', term_getline(buf, 1))})
+  call WaitForAssert({-> assert_match('^line 2 line 2 ', term_getline(buf, 3))})
+
+  " more than one buffer full was written with one call
+  let [bytes, writes] = readfile('XRedrawWrites')
+  call assert_true(str2nr(bytes) > 2047, bytes)
+  call assert_equal('1', writes)
+
+  call StopVimInTerminal(buf)
+  call delete('XRedrawWrites')
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -56,4 +56,142 @@ func Test_File_Read_Write()
   call delete("Xtest")
 endfunc
 
+" Test for editing a file of which lines are loaded lazily with 'mmapsize'
+func Test_mmapsize_edit()
+  CheckOption mmapsize
+
+  let lines = map(range(1, 30000), '"line " .. v:val')
+  call writefile(lines, 'Xmmap', 'D')
+  set mmapsize=1
+  edit Xmmap
+  call assert_equal(30000, line('$'))
+  call assert_equal('line 1', getline(1))
+  call assert_equal('line 12345', getline(12345))
+  call assert_equal('line 30000', getline('$'))
+  call assert_equal('unix', &fileformat)
+  call assert_equal(1, &endofline)
+  call assert_equal(strlen(join(lines[: 19998], "\n")) + 2, line2byte(20000))
+  call assert_equal(20000, byte2line(line2byte(20000)))
+
+  " changes are kept when lines are loaded again
+  20000delete
+  call setline(1, 'changed')
+  let &undolevels = &undolevels
+  call append(25000, 'new')
+  call assert_equal('line 20001', getline(20000))
+  call assert_equal(30000, line('$'))
+  undo
+  call assert_equal('line 25002', getline(25001))
+
+  " writing over the loaded file first loads all the lines
+  write
+  call remove(lines, 19999)
+  let lines[0] = 'changed'
+  call assert_equal(lines, readfile('Xmmap'))
+  edit!
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+
+  " the file becoming shorter is detected when loading lines
+  edit Xmmap
+  call writefile(['short'], 'Xmmap')
+  call assert_fails('call getline(20000)', 'E1572:')
+  call assert_equal('', getline(20001))
+  call assert_equal(29999, line('$'))
+
+  bwipe!
+  set mmapsize&
+endfunc
+
+" A line and a character continuing in the next chunk of the file
+func Test_mmapsize_chunk_boundary()
+  CheckOption mmapsize
+  CheckFeature byte_offset
+
+  let lines = [repeat('a', 65535) .. "é" .. repeat('b', 70000), 'two',
+	\ repeat('c', 200000), 'last']
+  call writefile(lines, 'Xmmap', 'bD')
+  set mmapsize=1
+  edit Xmmap
+  call assert_equal(lines, getline(1, '$'))
+  call assert_equal(0, &endofline)
+  if &encoding == 'utf-8'
+    call assert_equal('utf-8', &fileencoding)
+  endif
+  call assert_equal(strlen(lines[0]) + strlen(lines[1]) + 3, line2byte(3))
+  call assert_equal(4, byte2line(line2byte(4)))
+
+  bwipe!
+  set mmapsize&
+endfunc
+
+" A file that can't be used as-is is read as usual
+func Test_mmapsize_fallback()
+  CheckOption mmapsize
+
+  set mmapsize=1
+  " NUL and a missing end-of-line
+  let lines = ['a', "b\nc"] + map(range(1, 500), '"pad " .. v:val')
+  call writefile(lines, 'Xmmap', 'bD')
+  edit Xmmap
+  call assert_equal(lines, getline(1, '$'))
+  call assert_equal(0, &endofline)
+  bwipe!
+
+  " DOS line endings
+  call writefile(lines, 'Xmmap')
+  edit ++ff=dos Xmmap
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+  call writefile(map(copy(lines), 'v:val .. "\r"'), 'Xmmap')
+  edit Xmmap
+  call assert_equal('dos', &fileformat)
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+
+  " invalid UTF-8
+  if &encoding == 'utf-8'
+    call writefile(lines + ["\xff"], 'Xmmap')
+    edit Xmmap
+    call assert_equal(503, line('$'))
+    call assert_equal('latin1', &fileencoding)
+    bwipe!
+  endif
+
+  set mmapsize&
+endfunc
+
+
+" Test that looking up lines in recently used blocks gives the right text,
+" also after lines were inserted and deleted
+func Test_line_block_cache()
+  new
+  call setline(1, map(range(1, 20000), '"line " .. v:val'))
+  let hits = test_getvalue('ml_cache_hits')
+  let misses = test_getvalue('ml_cache_misses')
+  for i in range(10)
+    call assert_equal('line 10', getline(10))
+    call assert_equal('line 10000', getline(10000))
+    call assert_equal('line 19990', getline(19990))
+  endfor
+  call assert_true(test_getvalue('ml_cache_hits') >= hits + 25)
+  call assert_true(test_getvalue('ml_cache_misses') <= misses + 5)
+
+  5delete
+  call assert_equal('line 11', getline(10))
+  call assert_equal('line 10001', getline(10000))
+  call append(9000, ['a', 'b'])
+  call assert_equal('line 11', getline(10))
+  call assert_equal('line 9999', getline(10000))
+  call assert_equal('line 19989', getline(19990))
+  call setline(10000, repeat('x', 3000))
+  call assert_equal('line 11', getline(10))
+  call assert_equal(repeat('x', 3000), getline(10000))
+  call assert_equal('line 10000', getline(10001))
+  call assert_equal('line 19989', getline(19990))
+  call assert_equal(20001, line('$'))
+
+  bwipe!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -1456,6 +1456,43 @@ func Test_byte2line_line2byte()
   bw!
 endfunc
 
+" Check line2byte() and byte2line() in a big buffer after inserting and
+" deleting lines in many places, which splits and joins the byte count chunks.
+func Test_byte2line_line2byte_edits()
+  new
+  call setline(1, map(range(1, 5000), 'repeat("a", v:val % 37)'))
+  let seed = srand(42)
+  for i in range(120)
+    let lnum = rand(seed) % line('$') + 1
+    let r = i % 3
+    if r == 0
+      call append(lnum, map(range(rand(seed) % 300), 'repeat("b", v:val % 13)'))
+    elseif r == 1
+      exe 'silent ' .. lnum .. ',' .. min([line('$'), lnum + rand(seed) % 200]) .. 'd'
+    else
+      call setline(lnum, repeat('c', rand(seed) % 100))
+    endif
+  endfor
+
+  for ff in ['unix', 'dos']
+    let &fileformat = ff
+    let eol = ff == 'dos' ? 2 : 1
+    let offset = 1
+    for lnum in range(1, line('$'))
+      if lnum % 7 == 0
+        call assert_equal(offset, line2byte(lnum))
+        call assert_equal(lnum, byte2line(offset))
+        call assert_equal(lnum, byte2line(offset + len(getline(lnum))))
+      endif
+      let offset += len(getline(lnum)) + eol
+    endfor
+    call assert_equal(offset, line2byte(line('$') + 1))
+  endfor
+
+  set fileformat&
+  bw!
+endfunc
+
 " Test for byteidx() using a character index
 func Test_byteidx()
   let a = '.é.' " one char of two bytes
@@ -4221,6 +4258,41 @@ func Test_virtcol()
   bwipe!
 endfunc
 
+" Whether a line only has ASCII is remembered, check virtcol() and the
+" displayed text after the line was changed in place.
+func Test_virtcol_ascii_line_changed()
+  new
+  call setline(1, repeat('abcdefghij', 10))
+  call assert_equal(4, virtcol([1, 4]))
+  exe "normal! 0r\<Tab>"
+  call assert_equal(11, virtcol([1, 4]))
+  normal! 0rx
+  call assert_equal(4, virtcol([1, 4]))
+  exe "normal! 0r\<C-V>\<C-A>"
+  call assert_equal(5, virtcol([1, 4]))
+  normal! 0x
+  call assert_equal(4, virtcol([1, 4]))
+  exe "normal! 0ié\<Esc>"
+  call assert_equal(4, virtcol([1, 5]))
+  call assert_equal(100, virtcol([1, '$']) - 1)
+
+  setlocal nowrap
+  call setline(1, repeat('abcdefghij', 10))
+  normal! 0
+  normal! 65|
+  normal! 25zl
+  redraw
+  call assert_equal('fghij', screenstring(1, 1) .. screenstring(1, 2)
+        \ .. screenstring(1, 3) .. screenstring(1, 4) .. screenstring(1, 5))
+  exe "normal! 0r\<Tab>"
+  call winrestview({'col': 64, 'leftcol': 25})
+  redraw
+  call assert_equal('ijabc', screenstring(1, 1) .. screenstring(1, 2)
+        \ .. screenstring(1, 3) .. screenstring(1, 4) .. screenstring(1, 5))
+
+  bwipe!
+endfunc
+
 func Test_delfunc_while_listing()
   CheckRunVimInTerminal
 
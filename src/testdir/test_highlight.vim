@@ -555,6 +555,58 @@ func Test_cursorline_after_yank()
   call StopVimInTerminal(buf)
 endfunc
 
+" When only the colors change between adjacent text, only the colors that
+" differ are output.  Check that the result is still right.
+func Test_highlight_adjacent_colors()
+  CheckScreendump
+
+  let lines =<< trim END
+    call setline(1, ['aaabbbcccaaa', 'dddeeefff', 'aaagggaaa', 'aaa bbb ccc'])
+    syn match Red /a\+/
+    syn match Green /b\+/
+    syn match Blue /c\+/
+    syn match RedOnGrey /d\+/
+    syn match GreenOnGrey /e\+/
+    syn match Green2 /f\+/
+    syn match BoldRed /g\+/
+    hi Red ctermfg=red
+    hi Green ctermfg=green
+    hi Blue ctermfg=blue ctermbg=yellow
+    hi RedOnGrey ctermfg=red ctermbg=grey
+    hi GreenOnGrey ctermfg=green ctermbg=grey
+    hi Green2 ctermfg=green
+    hi BoldRed cterm=bold ctermfg=red
+  END
+  call writefile(lines, 'XtestAdjacentColors', 'D')
+  let buf = RunVimInTerminal('-S XtestAdjacentColors', {'rows': 6})
+  call VerifyScreenDump(buf, 'Test_highlight_adjacent_colors_01', {})
+
+  call term_sendkeys(buf, ":hi Green ctermbg=grey\<CR>")
+  call VerifyScreenDump(buf, 'Test_highlight_adjacent_colors_02', {})
+
+  call term_sendkeys(buf, ":hi Normal ctermfg=darkblue ctermbg=lightgrey\<CR>")
+  call VerifyScreenDump(buf, 'Test_highlight_adjacent_colors_03', {})
+
+  call StopVimInTerminal(buf)
+endfunc
+
+func Test_highlight_redraw_bytes()
+  call setline(1, ['one', 'two', 'three'])
+  redraw!
+  let bytes = test_getvalue('redraw_bytes')
+  call assert_true(bytes > 0)
+
+  " Nothing changed, nothing needs to be drawn.
+  redraw
+  call assert_true(test_getvalue('redraw_bytes') < bytes)
+
+  call setline(2, 'TWO')
+  redraw
+  call assert_true(test_getvalue('redraw_bytes') > 0)
+  call assert_true(test_getvalue('redraw_bytes') < bytes)
+  bwipe!
+endfunc
+
 " Test for issue #4862: pasting above 'cursorline' redraws properly.
 func Test_put_before_cursorline()
   new
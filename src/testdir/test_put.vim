@@ -442,4 +442,36 @@ func Test_put_tuple()
   bw!
 endfunc
 
+" Putting a big register appends many lines at once, check the text, the byte
+" offsets and undo.
+func Test_put_many_lines()
+  new
+  call setline(1, map(range(1, 3000), '"line " .. v:val'))
+  let &undolevels = &undolevels
+  let lines = map(range(1, 5000), 'repeat("x", v:val % 90) .. v:val')
+  call setreg('a', lines, 'l')
+  1500put a
+  let &undolevels = &undolevels
+  call assert_equal(8000, line('$'))
+  call assert_equal('line 1500', getline(1500))
+  call assert_equal(lines, getline(1501, 6500))
+  call assert_equal('line 1501', getline(6501))
+  let expected = join(getline(1, '$'), "\n")->len() + 2
+  call assert_equal(expected, line2byte(line('$') + 1))
+  call assert_equal(len(getline(1501)) + 1, line2byte(1502) - line2byte(1501))
+
+  " characterwise register with many lines
+  call setreg('b', ['first'] + lines + ['last'], 'c')
+  call cursor(2, 3)
+  normal! "bp
+  call assert_equal('linfirst', getline(2))
+  call assert_equal(lines, getline(3, 5002))
+  call assert_equal('laste 2', getline(5003))
+
+  undo
+  undo
+  call assert_equal(map(range(1, 3000), '"line " .. v:val'), getline(1, '$'))
+  bwipe!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
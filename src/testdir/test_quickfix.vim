@@ -6138,6 +6138,54 @@ func Test_vimgrep_fuzzy_match()
   call Xvimgrep_fuzzy_match('l')
 endfunc
 
+" Test for :vimgrep with many files, most of them can't match and are not
+" loaded.
+func Test_vimgrep_many_files()
+  let files = []
+  for i in range(1, 30)
+    let fname = 'Xvgrmany' .. i
+    call writefile(['one', i % 3 == 0 ? 'a Needle here' : 'hay', 'end'],
+          \ fname, 'D')
+    call add(files, fname)
+  endfor
+  let matching = filter(copy(files), 'v:key % 3 == 2')
+
+  exe 'vimgrep /Needle/j ' .. join(files)
+  call assert_equal(matching, map(getqflist(), 'bufname(v:val.bufnr)'))
+  call assert_equal(2, getqflist()[0].lnum)
+  call assert_equal(3, getqflist()[0].col)
+  exe '1vimgrep /Needle/j ' .. join(files)
+  call assert_equal(1, len(getqflist()))
+  exe 'vimgrep /N\%(x\|e\)*dle/j ' .. join(files)
+  call assert_equal(10, len(getqflist()))
+  call assert_fails('vimgrep /Needles/j ' .. join(files), 'E480:')
+
+  " ignoring case, a character may fold to an ASCII letter
+  exe 'vimgrep /\cNEEDLE/j ' .. join(files)
+  call assert_equal(10, len(getqflist()))
+  call writefile(["hay \u017f"], 'Xvgrmany31', 'D')
+  set ignorecase
+  exe 'vimgrep /y s/j ' .. join(files) .. ' Xvgrmany31'
+  call assert_equal(['Xvgrmany31'], map(getqflist(), 'bufname(v:val.bufnr)'))
+  set ignorecase&
+
+  " autocommands may change the text and must be triggered
+  let g:wiped = 0
+  augroup VgrMany
+    au BufReadPost Xvgrmany1 call setline(1, 'Needle')
+    au BufWipeout Xvgrmany2 let g:wiped += 1
+  augroup END
+  exe 'vimgrep /Needle/j ' .. join(files)
+  call assert_equal(['Xvgrmany1'] + matching,
+        \ map(getqflist(), 'bufname(v:val.bufnr)'))
+  call assert_equal(1, g:wiped)
+  au! VgrMany
+  augroup! VgrMany
+  unlet g:wiped
+
+  %bwipe!
+endfunc
+
 func Test_locationlist_open_in_newtab()
   call s:create_test_file('Xqftestfile1')
   call s:create_test_file('Xqftestfile2')
@@ -76,6 +76,38 @@ func Test_swap_file()
   enew! | only
 endfunc
 
+" Blocks that are synced while typing are written by a separate thread.  Check
+" that they end up in the swap file in the right order with blocks written
+" later.
+func Test_swap_file_sync_while_typing()
+  set fileformat=unix undolevels=-1
+  edit! Xtest
+  call setline(1, map(range(1, 20000), '"line " .. v:val'))
+  set updatecount=1
+  call feedkeys("ggx10000GxGx", 'xt')
+  call setline(15000, 'changed')
+  call feedkeys("5000Gx", 'xt')
+
+  let swname = CopySwapfile()
+
+  new
+  only!
+  bwipe! Xtest
+  call rename('Xswap', swname)
+  recover Xtest
+  call delete(swname)
+  call assert_equal(20000, line('$'))
+  call assert_equal('ine 1', getline(1))
+  call assert_equal('line 2', getline(2))
+  call assert_equal('ine 5000', getline(5000))
+  call assert_equal('ine 10000', getline(10000))
+  call assert_equal('changed', getline(15000))
+  call assert_equal('ine 20000', getline(20000))
+
+  set updatecount& undolevels&
+  enew! | only
+endfunc
+
 func Test_nocatch_process_still_running()
   " sysinfo.uptime probably only works on Linux
   if !has('linux')
@@ -125,7 +125,7 @@ endfunc
 
 func Test_out_of_memory()
   new
-  s/^/,n
+  s/^/,n;
   " This will be slow...
   call assert_fails('call search("\\v((n||<)+);")', 'E363:')
 endfunc
@@ -1171,5 +1171,42 @@ def Test_compare_column_matchstr()
   set re=0
 enddef
 
+func Test_regexp_cache()
+  let info = regexpcacheinfo()
+  for i in range(5)
+    call assert_equal('bc', matchstr('abcd', 'b\(c\)'))
+  endfor
+  let newinfo = regexpcacheinfo()
+  call assert_true(newinfo.hits >= info.hits + 4)
+  call assert_inrange(1, newinfo.size, newinfo.count)
+
+  " 'regexpengine' is part of the key
+  for i in range(2)
+    call assert_equal(1, match('ab', 'b'))
+    set re=1
+    call assert_equal(1, match('ab', 'b'))
+    set re=0
+  endfor
+
+  " the backtracking engine uses 'iskeyword' when compiling [:keyword:]
+  new
+  for i in range(2)
+    setlocal iskeyword=a-z
+    call assert_equal(0, match('aB', '\%#=1[[:keyword:]]'))
+    setlocal iskeyword=A-Z
+    call assert_equal(1, match('aB', '\%#=1[[:keyword:]]'))
+  endfor
+  bwipe!
+
+  " "~" uses the previous substitute string
+  new
+  call setline(1, ['one', 'two'])
+  s/one/xyz/
+  call assert_equal(1, match('axyz', '~'))
+  2s/two/abc/
+  call assert_equal(1, match('aabc', '~'))
+  bwipe!
+endfunc
+
 
 " vim: shiftwidth=2 sts=2 expandtab
@@ -633,4 +633,61 @@ func Test_replace_multibyte_match_in_multi_lines()
   set ignorecase&vim re&vim
 endfun
 
+func s:SearchFromStart(pat)
+  call cursor(1, 1)
+  return searchpos(a:pat, 'cW')
+endfunc
+
+" Lines without the text that every match contains are skipped, check that
+" matches are still found when that text is in an unusual place.
+func Test_pattern_with_required_text()
+  new
+  call setline(1, ['one foo', 'bar two', 'xfoox', 'ab_zqx', 'FOO', 'ſtop'])
+  for i in range(0, 2)
+    exe 'set re=' .. i
+    call assert_equal([4, 1], s:SearchFromStart('\w\+zqx'))
+    call assert_equal([1, 5], s:SearchFromStart('foo\nbar'))
+    call assert_equal([2, 1], s:SearchFromStart('\(foo\n\)\@<=bar'))
+    call assert_equal([3, 2], s:SearchFromStart('x\zsfoo\zex'))
+    call assert_equal([1, 5], s:SearchFromStart('\cf\(O\|x\)o$'))
+    call assert_equal([1, 5], s:SearchFromStart('\v(f|g)+oo$'))
+    call assert_equal(['ab_zqx'],
+          \ getline(1, '$')->filter({_, v -> v =~ '[a-z_]\+q'}))
+    set ignorecase
+    call assert_equal([1, 5], s:SearchFromStart('\w\+OO$'))
+    call assert_equal([6, 1], s:SearchFromStart('\<.top'))
+    set ignorecase&
+  endfor
+  set re&
+  bw!
+endfunc
+
+" Lines without a match are rejected early, the result must be the same as
+" with the backtracking engine.
+func Test_pattern_line_without_match()
+  let lines = ['2023-10-04', 'abc 12-34', 'Fooing bar', 'xéy', "ét",
+        \ "hay ſtop", 'end$', '', 'a-b#c', "tab\there", 'ABC', 'abc']
+  let pats = ['\d\{4}-\d\d-\d\d', '^\d\+-', '\a\+ing\>', '[A-Z][a-z]\+ing',
+        \ 'x[à-ÿ]y', 'e\%Ct', '\cHAY', '\cy \stop', 'd\$$',
+        \ '^$', 'r\nb', '\(b\)\@<=c', 'a\(-\)\@=', '\k\{5}', '\s\S\+e$',
+        \ '\%[ab]c$', '\cabc\_$', '[[:upper:]]\{3}', '\v^(a|b)+c$']
+  for pat in pats
+    for line in lines
+      call assert_equal(match(line, '\%#=1' .. pat),
+            \ match(line, '\%#=2' .. pat), pat .. ' in ' .. line)
+      call assert_equal(match(line, '\%#=1' .. pat, 2),
+            \ match(line, '\%#=2' .. pat, 2), pat .. ' in ' .. line)
+    endfor
+  endfor
+
+  " 'iskeyword' matters for \k
+  new
+  call setline(1, ['a-b#c', 'abcde'])
+  call assert_equal([2, 1], searchpos('\%#=2\k\{5}', 'cw'))
+  setlocal iskeyword+=-,#
+  call cursor(1, 1)
+  call assert_equal([1, 1], searchpos('\%#=2\k\{5}', 'cw'))
+  bw!
+endfunc
+
 " vim: shiftwidth=2 sts=2 expandtab
@@ -119,6 +119,8 @@ func Test_syntime()
   call assert_match('^  TOTAL *COUNT *MATCH *SLOWEST *AVERAGE *NAME *PATTERN', a)
   call assert_match(' \d*\.\d* \+[^0]\d* .* cppRawString ', a)
   call assert_match(' \d*\.\d* \+[^0]\d* .* cppNumber ', a)
+  call assert_match('States stored: [1-9]\d*, with a shared stack: \d\+, dropped: \d\+', a)
+  call assert_match('Now [1-9]\d* states using [1-9]\d* stacks, \d\+ Kbyte', a)
 
   syntime off
   syntime clear
@@ -137,6 +139,38 @@ func Test_syntime()
   bd
 endfunc
 
+" With a small 'synmaxmem' states are dropped, the highlighting must still be
+" correct.
+func Test_synmaxmem()
+  new
+  " The nesting depth goes up and down: 1 to 5 and back every ten lines.
+  call setline(1, map(range(5000), 'v:val % 10 < 5 ? "(" : ")"'))
+  syn region TestParen start=/(/ end=/)/ contains=TestParen
+  syn sync fromstart
+  if has('profile')
+    syntime on
+  endif
+  " Store states for the whole buffer, then make the array smaller.
+  call synstack(5000, 1)
+  set synmaxmem=1
+
+  for lnum in [4999, 10, 2501, 4000, 1, 3333, 1234, 5000, 2]
+    let n = (lnum - 1) % 10
+    call assert_equal(n < 5 ? n + 1 : 10 - n, len(synstack(lnum, 1)),
+          \ 'line ' .. lnum)
+  endfor
+
+  if has('profile')
+    let a = execute('syntime report')
+    call assert_match('States stored: \d\+, with a shared stack: \d\+, dropped: [1-9]\d*', a)
+    syntime off
+    syntime clear
+  endif
+
+  set synmaxmem&
+  bwipe!
+endfunc
+
 func Test_syntime_completion()
   CheckFeature profile
 
@@ -441,6 +475,99 @@ func Test_syn_clear()
   call assert_fails('syntax clear invalid_syngroup', 'E28:')
 endfunc
 
+" Keywords are found when they are added or cleared after being used.
+func Test_syn_keyword_changes()
+  new
+  call setline(1, ['if ifdef ifd Select SELECTED'])
+  syntax keyword Foo if ifdef
+  syntax case ignore
+  syntax keyword Bar select
+  syntax case match
+  let Name = {col -> synIDattr(synID(1, col, 1), 'name')}
+  call assert_equal(['Foo', 'Foo', '', 'Bar', ''],
+        \ [Name(1), Name(4), Name(10), Name(14), Name(21)])
+
+  syntax keyword FooBar ifd
+  call assert_equal(['Foo', 'Foo', 'FooBar'], [Name(1), Name(4), Name(10)])
+
+  syntax clear Foo
+  call assert_equal(['', '', 'FooBar', 'Bar'],
+        \ [Name(1), Name(4), Name(10), Name(14)])
+
+  syntax clear
+  call assert_equal(['', ''], [Name(10), Name(14)])
+  bwipe!
+endfunc
+
+" The syntax attributes of lines that were drawn are reused, check that they
+" are not used when something changed.
+func Test_syn_redraw_stored_lines()
+  CheckFeature profile
+  new
+  call setline(1, ['one foo bar', 'two bar', '/* x', 'y */ bar'])
+  syntax match Foo /bar/
+  syntax region Bar start=+/\*+ end=+\*/+
+  syntax keyword FooBar foo
+  hi Foo ctermfg=red
+  hi Bar ctermfg=blue
+  hi FooBar ctermfg=green
+  redraw
+  let foo_attr = screenattr(1, 9)
+  let bar_attr = screenattr(3, 1)
+  let foobar_attr = screenattr(1, 5)
+  call assert_notequal(foo_attr, bar_attr)
+  call assert_equal(foo_attr, screenattr(4, 6))
+
+  " drawing the lines again does not need to parse them
+  syntime on
+  syntime clear
+  redraw!
+  call assert_notmatch(' Foo ', execute('syntime report'))
+  call assert_equal([foo_attr, bar_attr, foo_attr],
+        \ [screenattr(1, 9), screenattr(4, 1), screenattr(4, 6)])
+
+  " a change in the first line starts a comment in the lines below
+  call setline(1, 'one foo bar /*')
+  redraw
+  call assert_equal([foo_attr, bar_attr, bar_attr, foo_attr],
+        \ [screenattr(1, 9), screenattr(2, 5), screenattr(4, 1),
+        \ screenattr(4, 6)])
+  syntime off
+
+  hi Foo ctermfg=yellow
+  redraw
+  call assert_notequal(foo_attr, screenattr(1, 9))
+  let foo_attr = screenattr(1, 9)
+
+  setlocal iskeyword+=-
+  call setline(3, 'foo-x */')
+  redraw
+  call assert_equal(foobar_attr, screenattr(1, 5))
+  call assert_equal(bar_attr, screenattr(3, 1))
+  call setline(1, 'one foo- bar')
+  redraw
+  call assert_notequal(foobar_attr, screenattr(1, 5))
+  setlocal iskeyword&
+  redraw!
+  call assert_equal(foobar_attr, screenattr(1, 5))
+
+  setlocal synmaxcol=8
+  redraw!
+  call assert_notequal(foo_attr, screenattr(1, 10))
+  setlocal synmaxcol&
+  redraw!
+  call assert_equal(foo_attr, screenattr(1, 10))
+
+  syntax clear FooBar
+  redraw!
+  call assert_notequal(foobar_attr, screenattr(1, 5))
+
+  bwipe!
+  hi clear Foo
+  hi clear Bar
+  hi clear FooBar
+endfunc
+
 func Test_invalid_name()
   syn clear
   syn keyword Nop yes
@@ -988,5 +1115,61 @@ func Test_WinEnter_synstack_synID()
   bw!
 endfunc
 
+" Return the number of syntax states stored in the Vim running in terminal
+" buffer "buf", zero when it is not known yet.
+func s:IdleStates(buf)
+  call delete('XidleStates')
+  call term_sendkeys(a:buf, ":call States()\<CR>")
+  call WaitFor({-> filereadable('XidleStates')})
+  let states = filereadable('XidleStates') ? readfile('XidleStates') : []
+  call delete('XidleStates')
+  return empty(states) ? 0 : str2nr(states[0])
+endfunc
+
+" Syntax is parsed ahead while waiting for a character, the result must be the
+" same as when parsing for displaying.
+func Test_syntax_parse_when_idle()
+  CheckFeature reltime
+  CheckFeature profile
+  CheckRunVimInTerminal
+
+  let lines =<< trim END
+    call setline(1, ['/*'] + repeat(['text'], 20000) + ['*/', 'after'])
+    syn region TestComment start='/\*' end='\*/'
+    syn sync fromstart
+    syntime on
+    func States()
+      let report = execute('syntime report')
+      call writefile([matchstr(report, 'Now \zs\d\+\ze states')], 'XidleStates')
+    endfunc
+    func Check()
+      call writefile([synID(20001, 1, 0)->synIDattr('name'),
+            \ synID(20003, 1, 0)->synIDattr('name')], 'XidleResult')
+    endfunc
+  END
+  call writefile(lines, 'XidleParse', 'D')
+  let buf = RunVimInTerminal('-S XidleParse', {})
+
+  " States for the whole file are stored while waiting for a key, before
+  " anything asks for the syntax far down.
+  call WaitForAssert({-> assert_inrange(500, 100000,
+        \ s:IdleStates(buf))})
+
+  call term_sendkeys(buf, ":call Check()\<CR>")
+  call WaitForAssert({-> assert_equal(['TestComment', ''],
+        \ filereadable('XidleResult') ? readfile('XidleResult') : [])})
+  call delete('XidleResult')
+
+  " A change at the start must be noticed.
+  call term_sendkeys(buf, ":call setline(1, 'no comment')\<CR>")
+  call TermWait(buf, 200)
+  call term_sendkeys(buf, ":call Check()\<CR>")
+  call WaitForAssert({-> assert_equal(['', ''],
+        \ filereadable('XidleResult') ? readfile('XidleResult') : [])})
+
+  call StopVimInTerminal(buf)
+  call delete('XidleResult')
+endfunc
+
 
 " vim: shiftwidth=2 sts=2 expandtab
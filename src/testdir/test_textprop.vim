@@ -2336,6 +2336,55 @@ func Test_prop_find_prev_on_same_line()
   bwipe!
 endfunc
 
+" When looking for text properties more than once an index is used, check it
+" is updated after a change.
+func Test_prop_find_after_change()
+  new
+  call setline(1, range(1, 20))
+  call prop_type_add('one', {})
+  call prop_type_add('two', {})
+  for lnum in [5, 10, 15]
+    call prop_add(lnum, 1, #{type: 'one', id: lnum})
+  endfor
+  call prop_add(10, 2, #{type: 'two', id: 22})
+
+  func s:Check(lnum, col, found, props)
+    for i in range(2)
+      let p = prop_find(#{type: 'one', lnum: 1})
+      call assert_equal([a:lnum, a:col], [get(p, 'lnum'), get(p, 'col')])
+      let p = prop_find(#{id: 22, lnum: line('$')}, 'b')
+      call assert_equal(a:found, get(p, 'lnum'))
+      call assert_equal(a:props, prop_list(1, #{end_lnum: -1})
+            \ ->map({_, v -> v.lnum * 100 + v.id}))
+    endfor
+  endfunc
+
+  call s:Check(5, 1, 10, [505, 1010, 1022, 1515])
+  call append(0, 'added')
+  call s:Check(6, 1, 11, [605, 1110, 1122, 1615])
+  call prop_add(2, 1, #{type: 'one', id: 2})
+  call s:Check(2, 1, 11, [202, 605, 1110, 1122, 1615])
+  " start a new undo block
+  let &g:undolevels = &g:undolevels
+  normal! 2Gix
+  call s:Check(2, 2, 11, [202, 605, 1110, 1122, 1615])
+  undo
+  call s:Check(2, 1, 11, [202, 605, 1110, 1122, 1615])
+  2,6delete
+  call s:Check(6, 1, 6, [610, 622, 1115])
+  call assert_equal(1, prop_remove(#{id: 22}))
+  call s:Check(6, 1, 0, [610, 1115])
+  call assert_equal(1, prop_remove(#{id: 10}))
+  call s:Check(11, 1, 0, [1115])
+  call prop_clear(1, line('$'))
+  call s:Check(0, 0, 0, [])
+
+  delfunc s:Check
+  call prop_type_delete('one')
+  call prop_type_delete('two')
+  bwipe!
+endfunc
+
 func Test_prop_spell()
   new
   set spell
@@ -127,6 +127,41 @@ func Test_timer_info()
   unlet g:timer_repeat
 endfunc
 
+func Test_timer_info_late()
+  let g:val = 0
+  let id = timer_start(20, 'MyHandler', #{repeat: 2})
+  let info = timer_info(id)[0]
+  call assert_equal(0, info.fired)
+  call assert_equal(0, info.late)
+  call assert_equal(0, info.maxlate)
+
+  " being busy makes the timer late
+  let start = reltime()
+  while reltimefloat(reltime(start)) < 0.2
+  endwhile
+  call WaitForAssert({-> assert_equal(1, g:val)})
+  let info = timer_info(id)[0]
+  call assert_equal(1, info.fired)
+  call assert_inrange(100, 10000, info.late)
+  call assert_equal(info.late, info.maxlate)
+  call timer_stop(id)
+endfunc
+
+func AddTimerOrder(n, timer)
+  call add(g:timer_order, a:n)
+endfunc
+
+func Test_timer_order()
+  let g:timer_order = []
+  let delays = range(60)->map({i, _ -> i * 37 % 60 * 10})
+  for n in delays
+    call timer_start(n, function('AddTimerOrder', [n]))
+  endfor
+  call WaitForAssert({-> assert_equal(60, len(g:timer_order))})
+  call assert_equal(sort(delays, 'n'), g:timer_order)
+  unlet g:timer_order
+endfunc
+
 func Test_timer_stopall()
   let id1 = timer_start(1000, 'MyHandler')
   let id2 = timer_start(2000, 'MyHandler')
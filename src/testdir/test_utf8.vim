@@ -76,6 +76,43 @@ func Test_getvcol()
   call assert_equal(2, virtcol("']"))
 endfunc
 
+" The virtual columns in a long line are remembered, check that they are
+" still right after the text or an option changed.
+func Test_getvcol_long_line()
+  new
+  setlocal nowrap
+  let line = repeat("ab\tc\u2500\x01d", 1000)
+
+  func s:CheckVcols(line)
+    for idx in [0, 1000, 2500, 4000, strchars(a:line) - 1]
+      let col = byteidx(a:line, idx) + 1
+      call assert_equal(strdisplaywidth(strpart(a:line, 0, col - 1)) + 1,
+            \ virtcol([1, col], v:true)[0], 'col ' .. col)
+    endfor
+  endfunc
+
+  call setline(1, line)
+  call s:CheckVcols(line)
+  setlocal ts=3
+  call s:CheckVcols(line)
+  set ambiwidth=double
+  call s:CheckVcols(line)
+  set ambiwidth&
+  call s:CheckVcols(line)
+  call setcellwidths([[0x2500, 0x2500, 2]])
+  call s:CheckVcols(line)
+  call setcellwidths([])
+  set display=uhex
+  call s:CheckVcols(line)
+  set display&
+  let line = "\t" .. line
+  call setline(1, line)
+  call s:CheckVcols(line)
+
+  delfunc s:CheckVcols
+  bwipe!
+endfunc
+
 func Test_list2str_str2list_utf8()
   " One Unicode codepoint
   let s = "\u3042\u3044"
@@ -271,6 +308,36 @@ func Test_setcellwidths()
   bwipe!
 endfunc
 
+" The cell width of characters is remembered, check that it changes with
+" 'ambiwidth' and setcellwidths() and is restored after a failure.
+func Test_strwidth_after_width_change()
+  let s = repeat("─xé日", 100)
+  call assert_equal(500, strwidth(s))
+  call assert_equal(500, strdisplaywidth(s))
+  set ambiwidth=double
+  call assert_equal(700, strwidth(s))
+  set ambiwidth&
+  call assert_equal(500, strwidth(s))
+  set listchars=tab:--\\u2500
+  call assert_fails('set ambiwidth=double', 'E834:')
+  call assert_equal(500, strwidth(s))
+  set listchars&
+
+  call setcellwidths([[0x2500, 0x2500, 2]])
+  call assert_equal(600, strwidth(s))
+  set listchars=tab:--\\u00e9
+  call assert_fails('call setcellwidths([[0xe9, 0xe9, 2]])', 'E834:')
+  call assert_equal(600, strwidth(s))
+  set listchars&
+  call setcellwidths([])
+  call assert_equal(500, strwidth(s))
+
+  " composing characters do not take a cell
+  let s = repeat("á日̈", 100)
+  call assert_equal(300, strwidth(s))
+  call assert_equal(200, strchars(s, 1))
+endfunc
+
 func Test_getcellwidths()
   call setcellwidths([])
   call assert_equal([], getcellwidths())
@@ -330,6 +397,33 @@ func Test_setcellwidths_with_non_ambiwidth_character_dump()
   call StopVimInTerminal(buf)
 endfunc
 
+" Only the changed part of a line is redrawn, check that the line is correct
+" when the change is next to double-wide and composing characters.
+func Test_redraw_change_after_wide_chars_dump()
+  CheckScreendump
+  CheckRunVimInTerminal
+
+  let lines =<< trim END
+      call setline(1, [repeat('x', 40) .. "\u3042\u3044\u3046abc",
+            \ repeat('y', 40) .. "e\u3042e"])
+  END
+  call writefile(lines, 'XRedrawAfterWide', 'D')
+  let buf = RunVimInTerminal('-S XRedrawAfterWide', {'rows': 6, 'cols': 60})
+  call VerifyScreenDump(buf, 'Test_redraw_change_after_wide_chars_1', {})
+
+  " replace a double-wide character with two single-wide characters and a
+  " character after the double-wide characters
+  call term_sendkeys(buf, ":call setline(1, repeat('x', 40) .. "
+        \ .. "'\u3042ii\u3046aBc')\<CR>")
+  " add a composing character after the double-wide character
+  call term_sendkeys(buf, ":call setline(2, repeat('y', 40) .. "
+        \ .. "'e\u3042e\u0301')\<CR>")
+  call term_sendkeys(buf, ":echo\<CR>")
+  call VerifyScreenDump(buf, 'Test_redraw_change_after_wide_chars_2', {})
+
+  call StopVimInTerminal(buf)
+endfunc
+
 " For some reason this test causes Test_customlist_completion() to fail on CI,
 " so run it as the last test.
 func Test_zz_ambiwidth_hl_dump()
@@ -11662,6 +11662,29 @@ def Test_object_any_type()
     type PatternSteps = list<any>
     type Directive = tuple<DirectiveType, PatternSteps>
 
+    def Test(): void
+        var directive: Directive = (DirectiveType.Unknown, ["eq", 1, "hello"])
+        var idx = 0
+
+        if directive[idx] == "test"
+        endif
+    enddef
+
+    Test()
+  END
+  v9.CheckSourceFailure(lines, 'E1437: Can only compare Object with Object', 4)
+
+  # With a constant index the item type is known when compiling
+  lines =<< trim END
+    vim9script
+
+    enum DirectiveType
+        Unknown,
+        Set
+    endenum
+
+    type Directive = tuple<DirectiveType, list<any>>
+
     def Test(): void
         var directive: Directive = (DirectiveType.Unknown, ["eq", 1, "hello"])
 
@@ -11671,7 +11694,7 @@ def Test_object_any_type()
 
     Test()
   END
-  v9.CheckSourceFailure(lines, 'E1437: Can only compare Object with Object', 3)
+  v9.CheckSourceFailure(lines, 'E1072: Cannot compare object with string', 3)
 enddef
 
 " Test for object<{class}> type
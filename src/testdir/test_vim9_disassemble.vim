@@ -1075,7 +1075,7 @@ def Test_disassemble_closure_in_loop()
         '\d\+ STORE $3\_s*' ..
 
         'continue\_s*' ..
-        '\d\+ JUMP -> \d\+\_s*' ..
+        '\d\+ JUMP_FOR -> \d\+\_s*' ..
 
         'break\_s*' ..
         '\d\+ JUMP -> \d\+\_s*' ..
@@ -1096,7 +1096,7 @@ def Test_disassemble_closure_in_loop()
 
         'continue\_s*' ..
         '\d\+ ENDLOOP ref $1 save $3-$3 depth 0\_s*' ..
-        '\d\+ JUMP -> \d\+\_s*' ..
+        '\d\+ JUMP_FOR -> \d\+\_s*' ..
 
         'break\_s*' ..
         '\d\+ ENDLOOP ref $1 save $3-$3 depth 0\_s*' ..
@@ -1115,7 +1115,7 @@ def Test_disassemble_closure_in_loop()
         'endif\_s*' ..
         'endfor\_s*' ..
         '\d\+ ENDLOOP ref $1 save $3-$3 depth 0\_s*' ..
-        '\d\+ JUMP -> \d\+\_s*' ..
+        '\d\+ JUMP_FOR -> \d\+\_s*' ..
         '\d\+ DROP\_s*' ..
         '\d\+ RETURN void',
         res)
@@ -1626,7 +1626,7 @@ def Test_disassemble_for_loop()
         '\d\+ DROP\_s*' ..
 
         'endfor\_s*' ..
-        '\d\+ JUMP -> \d\+\_s*' ..
+        '\d\+ JUMP_FOR -> \d\+\_s*' ..
         '\d\+ DROP',
         instr)
 enddef
@@ -1662,7 +1662,7 @@ def Test_disassemble_for_loop_eval()
         '\d\+ STORE $0\_s*' ..
 
         'endfor\_s*' ..
-        '\d\+ JUMP -> 5\_s*' ..
+        '\d\+ JUMP_FOR -> 5\_s*' ..
         '\d\+ DROP\_s*' ..
 
         'return res\_s*' ..
@@ -1700,7 +1700,7 @@ def Test_disassemble_for_loop_unpack()
         '\d\+ ECHO 2\_s*' ..
 
         'endfor\_s*' ..
-        '\d\+ JUMP -> 8\_s*' ..
+        '\d\+ JUMP_FOR -> 8\_s*' ..
         '\d\+ DROP\_s*' ..
         '\d\+ RETURN void',
         instr)
@@ -1768,7 +1768,7 @@ def Test_disassemble_for_loop_continue()
         '20 ENDTRY\_s*' ..
 
         'endfor\_s*' ..
-        '21 JUMP -> 4\_s*' ..
+        '21 JUMP_FOR -> 4\_s*' ..
         '\d\+ DROP\_s*' ..
         '\d\+ RETURN void',
         instr)
@@ -1889,7 +1889,7 @@ def Test_disassemble_computing()
         'var nr = 3.*' ..
         '\d STORE 3 in $0.*' ..
         'var nrres = nr + 7.*' ..
-        '\d LOAD $0.*' ..
+        '\d LOAD_PUSHNR_OPNR $0.*' ..
         '\d PUSHNR 7.*' ..
         '\d OPNR +.*' ..
         '\d STORE $1.*' ..
@@ -2711,7 +2711,7 @@ def Test_silent_for()
         '\d STORE $2\_s*' ..
 
         'endfor\_s*' ..
-        '\d JUMP -> 5\_s*' ..
+        '\d JUMP_FOR -> 5\_s*' ..
         '8 DROP\_s*' ..
         '\d RETURN void\_s*',
         res)
@@ -3094,7 +3094,7 @@ def Test_disassemble_string_interp()
         '1 LOAD arg\[-1\]\_s*' ..
         '2 2STRING stack\[-1\]\_s*' ..
         '3 PUSHS " x^2="\_s*' ..
-        '4 LOAD arg\[-1\]\_s*' ..
+        '4 LOAD_LOAD_OPNR arg\[-1\]\_s*' ..
         '5 LOAD arg\[-1\]\_s*' ..
         '6 OPNR \*\_s*' ..
         '7 2STRING stack\[-1\]\_s*' ..
@@ -3118,18 +3118,145 @@ def Test_disassemble_bitshift()
                'var b = 8 >> 1\_s*' ..
                '1 STORE 4 in $1\_s*' ..
                'var c = a << b\_s*' ..
-               '2 LOAD $0\_s*' ..
+               '2 LOAD_LOAD_OPNR $0\_s*' ..
                '3 LOAD $1\_s*' ..
                '4 OPNR <<\_s*' ..
                '5 STORE $2\_s*' ..
                'var d = b >> a\_s*' ..
-               '6 LOAD $1\_s*' ..
+               '6 LOAD_LOAD_OPNR $1\_s*' ..
                '7 LOAD $0\_s*' ..
                '8 OPNR >>\_s*' ..
                '9 STORE $3\_s*' ..
                '10 RETURN void', instr)
 enddef
 
+def s:SuperInstr(n: number, d = 3): list<any>
+  var res = []
+  var i = 0
+  while i < n
+    res->add(i * 10 / d)
+    i += 1
+  endwhile
+  for j in [1, 0]
+    try
+      res->add(n / j)
+    catch /E1154:/
+      res->add('div')
+    endtry
+  endfor
+  res->add((n > 2 ? n : d) + 1)
+  return res
+enddef
+
+def Test_disassemble_superinstructions()
+  # the plain instructions are used for division by zero and for a jump into
+  # the middle of the sequence
+  assert_equal([0, 3, 6, 3, 'div', 4], SuperInstr(3))
+  assert_equal([0, 2, 2, 'div', 6], SuperInstr(2, 5))
+
+  var instr = execute('disassemble s:SuperInstr')
+  assert_match('SuperInstr\_s*' ..
+        '.*' ..
+        'while i < n\_s*' ..
+        '5 LOAD_LOAD_OPNR $1\_s*' ..
+        '6 LOAD arg\[-2\]\_s*' ..
+        '7 COMPARENR <\_s*' ..
+        '8 WHILE $2 -> 22\_s*' ..
+        'res->add(i \* 10 / d)\_s*' ..
+        '9 LOAD $0\_s*' ..
+        '10 LOAD_PUSHNR_OPNR $1\_s*' ..
+        '11 PUSHNR 10\_s*' ..
+        '12 OPNR \*\_s*' ..
+        '13 LOAD arg\[-1\]\_s*' ..
+        '14 OPNR /\_s*' ..
+        '.*' ..
+        'res->add(n / j)\_s*' ..
+        '29 LOAD $0\_s*' ..
+        '30 LOAD_LOAD_OPNR arg\[-2\]\_s*' ..
+        '31 LOAD $5\_s*' ..
+        '32 OPNR /\_s*' ..
+        '.*' ..
+        'endfor\_s*' ..
+        '46 JUMP_FOR -> 26\_s*' ..
+        '47 DROP\_s*' ..
+        'res->add((n > 2 ? n : d) + 1)\_s*' ..
+        '.*' ..
+        '54 JUMP -> 56\_s*' ..
+        '55 LOAD_PUSHNR_OPNR arg\[-1\]\_s*' ..
+        '56 PUSHNR 1\_s*' ..
+        '57 OPNR +\_s*',
+        instr)
+enddef
+
+def s:InferredTypes(a: any): float
+  var n = 1
+  n += a
+  var fl: float = 1.5
+  var r = fl * 2
+  var tup = (1, 'x')
+  var m = tup[0] + 1
+  var f: float = a
+  return f * 2.0
+enddef
+
+def s:TupleIndexTernary(n: bool): number
+  var tup: tuple<string, number> = ('x', 2)
+  return tup[n ? 0 : 1] + 1
+enddef
+
+def Test_disassemble_inferred_types()
+  assert_equal(6.0, InferredTypes(3))
+  assert_fails('InferredTypes(1.5)', 'E1012: Type mismatch; expected number but got float')
+
+  var instr = execute('disassemble s:InferredTypes')
+  assert_match('InferredTypes\_s*' ..
+        '.*' ..
+        'n += a\_s*' ..
+        '1 LOAD $0\_s*' ..
+        '2 LOAD arg\[-1\]\_s*' ..
+        '3 CHECKTYPE number stack\[-1\]\_s*' ..
+        '4 OPNR + (type check elided)\_s*' ..
+        '.*' ..
+        'var r = fl \* 2\_s*' ..
+        '8 LOAD $1\_s*' ..
+        '9 PUSHNR 2\_s*' ..
+        '10 OPFLOAT \* (type check elided)\_s*' ..
+        '.*' ..
+        'var m = tup\[0\] + 1\_s*' ..
+        '17 LOAD $3\_s*' ..
+        '18 PUSHNR 0\_s*' ..
+        '19 TUPLEINDEX\_s*' ..
+        '20 PUSHNR 1\_s*' ..
+        '21 OPNR +\_s*' ..
+        '.*' ..
+        'return f \* 2.0\_s*' ..
+        '26 LOAD $5\_s*' ..
+        '27 PUSHF 2.0\_s*' ..
+        '28 OPFLOAT \*\_s*' ..
+        '29 RETURN',
+        instr)
+
+  # An index with jumps is not a constant, the item type is not known.
+  assert_equal(3, TupleIndexTernary(false))
+  assert_fails('TupleIndexTernary(true)', 'E1030: Using a String as a Number: "x"')
+  instr = execute('disassemble s:TupleIndexTernary')
+  assert_match('TupleIndexTernary\_s*' ..
+        '.*' ..
+        'return tup\[n ? 0 : 1\] + 1\_s*' ..
+        '5 LOAD $0\_s*' ..
+        '6 LOAD arg\[-1\]\_s*' ..
+        '7 JUMP_IF_FALSE -> 10\_s*' ..
+        '8 PUSHNR 0\_s*' ..
+        '9 JUMP -> 11\_s*' ..
+        '10 PUSHNR 1\_s*' ..
+        '11 TUPLEINDEX\_s*' ..
+        '12 PUSHNR 1\_s*' ..
+        '13 OPANY +\_s*' ..
+        '14 CHECKTYPE number stack\[-1\]\_s*' ..
+        '15 RETURN',
+        instr)
+enddef
+
 def s:OneDefer()
   defer delete("file")
 enddef
@@ -3369,7 +3496,7 @@ def Test_checktype_float()
     '2 LOAD $0\_s*' ..
     '3 LOAD $1\_s*' ..
     '4 CHECKTYPE float|number stack\[-1\]\_s*' ..
-    '5 OPANY +\_s*' ..
+    '5 OPFLOAT + (type check elided)\_s*' ..
     '6 STORE $0\_s*' ..
     '7 RETURN void', g:instr)
   unlet g:instr
@@ -4032,17 +4159,17 @@ def Test_disassemble_loop_with_closure_after_loop()
     'var v1 = 0\_s*' ..
     '4 STORE 0 in $3\_s*' ..
     'endfor\_s*' ..
-    '5 JUMP -> 2\_s*' ..
+    '5 JUMP_FOR -> 2\_s*' ..
     '6 DROP\_s*' ..
     'var idx = 1\_s*' ..
     '7 STORE 1 in $4\_s*' ..
     'while idx > 0\_s*' ..
-    '8 LOAD $4\_s*' ..
+    '8 LOAD_PUSHNR_OPNR $4\_s*' ..
     '9 PUSHNR 0\_s*' ..
     '10 COMPARENR >\_s*' ..
     '11 WHILE $5 -> 17\_s*' ..
     'idx -= 1\_s*' ..
-    '12 LOAD $4\_s*' ..
+    '12 LOAD_PUSHNR_OPNR $4\_s*' ..
     '13 PUSHNR 1\_s*' ..
     '14 OPNR -\_s*' ..
     '15 STORE $4\_s*' ..
@@ -4064,7 +4191,7 @@ def Test_disassemble_loop_with_closure_after_loop()
     '26 STOREG g:Ref\_s*' ..
     'endfor\_s*' ..
     '27 ENDLOOP ref $8 save $10-$10 depth 0\_s*' ..
-    '28 JUMP -> 22\_s*' ..
+    '28 JUMP_FOR -> 22\_s*' ..
     '29 DROP\_s*' ..
     '30 RETURN void', g:instr)
 enddef
@@ -977,6 +977,14 @@ f_test_getvalue(typval_T *argvars, typval_T *rettv)
 
     if (STRCMP(name, (char_u *)"need_fileinfo") == 0)
 	rettv->vval.v_number = need_fileinfo;
+    else if (STRCMP(name, (char_u *)"ml_cache_hits") == 0)
+	rettv->vval.v_number = ml_cache_hits;
+    else if (STRCMP(name, (char_u *)"ml_cache_misses") == 0)
+	rettv->vval.v_number = ml_cache_misses;
+    else if (STRCMP(name, (char_u *)"redraw_bytes") == 0)
+	rettv->vval.v_number = redraw_bytes;
+    else if (STRCMP(name, (char_u *)"redraw_writes") == 0)
+	rettv->vval.v_number = redraw_writes;
     else
 	semsg(_(e_invalid_argument_str), name);
 }
@@ -324,6 +324,7 @@ prop_add_one(
 	buf->b_ml.ml_flags |= ML_LINE_DIRTY;
     }
 
+    prop_index_invalidate(buf);
     changed_line_display_buf(buf);
     changed_lines_buf(buf, start_lnum, end_lnum + 1, 0);
     res = OK;
@@ -668,6 +669,87 @@ get_text_props(buf_T *buf, linenr_T lnum, char_u **props, int will_change)
     return (int)(proplen / sizeof(textprop_T));
 }
 
+/*
+ * Called when lines or text properties in "buf" may change: the index of the
+ * text properties is no longer valid.
+ */
+    void
+prop_index_invalidate(buf_T *buf)
+{
+    buf->b_prop_index_valid = FALSE;
+    buf->b_prop_index_uses = 0;
+}
+
+/*
+ * Return the index of all the text properties in "buf", ordered like they are
+ * found when going over the lines.  Finding a property with it only takes
+ * looking at the lines that have properties.
+ * Building the index means going over all the lines, that is only done when
+ * it is asked for a second time without a change in between.  Returns NULL
+ * when it is not available.
+ */
+    static garray_T *
+get_prop_index(buf_T *buf)
+{
+    garray_T	*gap = &buf->b_prop_index;
+    linenr_T	lnum;
+
+    if (buf->b_prop_index_valid)
+	return gap;
+    if (!buf->b_has_textprop || buf->b_ml.ml_mfp == NULL
+					       || ++buf->b_prop_index_uses < 2)
+	return NULL;
+
+    if (gap->ga_itemsize == 0)
+	ga_init2(gap, sizeof(propentry_T), 100);
+    gap->ga_len = 0;
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+    {
+	char_u	*props;
+	int	count = get_text_props(buf, lnum, &props, FALSE);
+	int	i;
+
+	if (count > 0 && ga_grow(gap, count) == FAIL)
+	{
+	    ga_clear(gap);
+	    return NULL;
+	}
+	for (i = 0; i < count; ++i)
+	{
+	    propentry_T *pe = (propentry_T *)gap->ga_data + gap->ga_len++;
+
+	    pe->pe_lnum = lnum;
+	    mch_memmove(&pe->pe_prop, props + i * sizeof(textprop_T),
+							   sizeof(textprop_T));
+	}
+    }
+    buf->b_prop_index_valid = TRUE;
+    return gap;
+}
+
+/*
+ * Return the index of the first entry in "gap" for line "lnum" or a later
+ * line.  Returns gap->ga_len when there is none.
+ */
+    static int
+prop_index_find(garray_T *gap, linenr_T lnum)
+{
+    propentry_T	*entries = (propentry_T *)gap->ga_data;
+    int		lo = 0;
+    int		hi = gap->ga_len;
+
+    while (lo < hi)
+    {
+	int mid = (lo + hi) / 2;
+
+	if (entries[mid].pe_lnum < lnum)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
 /*
  * Return the number of text properties with "above" or "below" alignment in
  * line "lnum".  A "right" aligned property also goes below after a "below" or
@@ -888,6 +970,7 @@ set_text_props(linenr_T lnum, char_u *props, int len)
     curbuf->b_ml.ml_line_ptr = newtext;
     curbuf->b_ml.ml_line_len = textlen + len;
     curbuf->b_ml.ml_flags |= ML_LINE_DIRTY;
+    prop_index_invalidate(curbuf);
 }
 
 /*
@@ -911,6 +994,7 @@ add_text_props(linenr_T lnum, textprop_T *text_props, int text_prop_count)
     curbuf->b_ml.ml_line_ptr = newtext;
     curbuf->b_ml.ml_line_len += proplen;
     curbuf->b_ml.ml_flags |= ML_LINE_DIRTY;
+    prop_index_invalidate(curbuf);
 }
 
 /*
@@ -1123,7 +1207,10 @@ f_prop_clear(typval_T *argvars, typval_T *rettv UNUSED)
 	}
     }
     if (did_clear)
+    {
+	prop_index_invalidate(buf);
 	redraw_buf_later(buf, UPD_NOT_VALID);
+    }
 }
 
 /*
@@ -1147,6 +1234,9 @@ f_prop_find(typval_T *argvars, typval_T *rettv)
     int		col = -1;
     int		dir = FORWARD;    // FORWARD == 1, BACKWARD == -1
     int		both;
+    garray_T	*index;
+    int		index_first = -1;  // first entry of "lnum" in "index"
+    int		count = 0;
 
     if (in_vim9script()
 	    && (check_for_dict_arg(argvars, 0) == FAIL
@@ -1230,21 +1320,67 @@ f_prop_find(typval_T *argvars, typval_T *rettv)
     if (rettv_dict_alloc(rettv) == FAIL)
 	return;
 
+    index = get_prop_index(buf);
     while (1)
     {
-	char_u	*text = ml_get_buf(buf, lnum, FALSE);
-	size_t	textlen = ml_get_buf_len(buf, lnum) + 1;
-	int	count = (int)((buf->b_ml.ml_line_len - textlen)
-							 / sizeof(textprop_T));
+	char_u	*props;
+	size_t	propsize;
 	int	    i;
 	textprop_T  prop;
 	int	    prop_start;
 	int	    prop_end;
 
+	if (index != NULL)
+	{
+	    propentry_T	*entries = (propentry_T *)index->ga_data;
+
+	    // Go to the next line with text properties.  The entries of the
+	    // line before or after the previous one are next to its entries.
+	    if (dir == BACKWARD)
+	    {
+		int last = index_first < 0
+			    ? prop_index_find(index, lnum + 1) - 1
+			    : index_first - 1;
+
+		if (last < 0)
+		    break;
+		lnum = entries[last].pe_lnum;
+		for (index_first = last; index_first > 0
+			&& entries[index_first - 1].pe_lnum == lnum;
+								--index_first)
+		    ;
+		count = last - index_first + 1;
+	    }
+	    else
+	    {
+		index_first = index_first < 0
+				    ? prop_index_find(index, lnum)
+				    : index_first + count;
+		if (index_first == index->ga_len)
+		    break;
+		lnum = entries[index_first].pe_lnum;
+		for (count = 1; index_first + count < index->ga_len
+			&& entries[index_first + count].pe_lnum == lnum;
+									++count)
+		    ;
+	    }
+	    props = (char_u *)&entries[index_first].pe_prop;
+	    propsize = sizeof(propentry_T);
+	}
+	else
+	{
+	    char_u	*text = ml_get_buf(buf, lnum, FALSE);
+	    size_t	textlen = ml_get_buf_len(buf, lnum) + 1;
+
+	    count = (int)((buf->b_ml.ml_line_len - textlen)
+							 / sizeof(textprop_T));
+	    props = text + textlen;
+	    propsize = sizeof(textprop_T);
+	}
+
 	for (i = dir == BACKWARD ? count - 1 : 0; i >= 0 && i < count; i += dir)
 	{
-	    mch_memmove(&prop, text + textlen + i * sizeof(textprop_T),
-							   sizeof(textprop_T));
+	    mch_memmove(&prop, props + i * propsize, sizeof(textprop_T));
 
 	    // For the very first line try to find the first property before or
 	    // after `col`, depending on the search direction.
@@ -1333,6 +1469,44 @@ prop_type_or_id_in_list(int *types_or_ids, int len, int type_or_id)
     return FALSE;
 }
 
+/*
+ * When text property "prop" in line "lnum" has a type in 'prop_types' and an
+ * identifier in 'prop_ids' add a dictionary for it to 'retlist'.  When
+ * 'prop_types' or 'prop_ids' is NULL it is not checked.
+ * Returns FAIL when out of memory.
+ */
+    static int
+add_prop_to_list(
+	buf_T		*buf,
+	linenr_T	lnum,
+	textprop_T	*prop,
+	int		*prop_types,
+	int		prop_types_len,
+	int		*prop_ids,
+	int		prop_ids_len,
+	list_T		*retlist,
+	int		add_lnum)
+{
+    dict_T *d;
+
+    if ((prop_types != NULL
+		&& !prop_type_or_id_in_list(prop_types, prop_types_len,
+							       prop->tp_type))
+	    || (prop_ids != NULL
+		&& !prop_type_or_id_in_list(prop_ids, prop_ids_len,
+								 prop->tp_id)))
+	return OK;
+
+    d = dict_alloc();
+    if (d == NULL)
+	return FAIL;
+    prop_fill_dict(d, prop, buf);
+    if (add_lnum)
+	dict_add_number(d, "lnum", lnum);
+    list_append_dict(retlist, d);
+    return OK;
+}
+
 /*
  * Return all the text properties in line 'lnum' in buffer 'buf' in 'retlist'.
  * If 'prop_types' is not NULL, then return only the text properties with
@@ -1364,25 +1538,40 @@ get_props_in_line(
     {
 	mch_memmove(&prop, text + textlen + i * sizeof(textprop_T),
 		sizeof(textprop_T));
-	if ((prop_types == NULL
-		    || prop_type_or_id_in_list(prop_types, prop_types_len,
-			prop.tp_type))
-		&& (prop_ids == NULL
-		    || prop_type_or_id_in_list(prop_ids, prop_ids_len,
-								 prop.tp_id)))
-	{
-	    dict_T *d = dict_alloc();
-
-	    if (d == NULL)
-		break;
-	    prop_fill_dict(d, &prop, buf);
-	    if (add_lnum)
-		dict_add_number(d, "lnum", lnum);
-	    list_append_dict(retlist, d);
-	}
+	if (add_prop_to_list(buf, lnum, &prop, prop_types, prop_types_len,
+			       prop_ids, prop_ids_len, retlist, add_lnum) == FAIL)
+	    break;
     }
 }
 
+/*
+ * Like get_props_in_line() for lines "start_lnum" to "end_lnum", using the
+ * entries in "index".
+ */
+    static void
+get_props_in_index(
+	buf_T		*buf,
+	garray_T	*index,
+	linenr_T	start_lnum,
+	linenr_T	end_lnum,
+	int		*prop_types,
+	int		prop_types_len,
+	int		*prop_ids,
+	int		prop_ids_len,
+	list_T		*retlist,
+	int		add_lnum)
+{
+    propentry_T	*entries = (propentry_T *)index->ga_data;
+    int		i;
+
+    for (i = prop_index_find(index, start_lnum);
+			   i < index->ga_len && entries[i].pe_lnum <= end_lnum; ++i)
+	if (add_prop_to_list(buf, entries[i].pe_lnum, &entries[i].pe_prop,
+			    prop_types, prop_types_len, prop_ids, prop_ids_len,
+					      retlist, add_lnum) == FAIL)
+	    break;
+}
+
 /*
  * Convert a List of property type names into an array of property type
  * identifiers. Returns a pointer to the allocated array. Returns NULL on
@@ -1485,6 +1674,7 @@ f_prop_list(typval_T *argvars, typval_T *rettv)
     int		prop_ids_len = 0;
     list_T	*l;
     dictitem_T	*di;
+    garray_T	*index;
 
     if (in_vim9script()
 	    && (check_for_number_arg(argvars, 0) == FAIL
@@ -1560,6 +1750,10 @@ f_prop_list(typval_T *argvars, typval_T *rettv)
     if (start_lnum < 1 || start_lnum > buf->b_ml.ml_line_count
 		|| end_lnum < 1 || end_lnum < start_lnum)
 	emsg(_(e_invalid_range));
+    else if (end_lnum > start_lnum && (index = get_prop_index(buf)) != NULL)
+	get_props_in_index(buf, index, start_lnum, end_lnum,
+		prop_types, prop_types_len, prop_ids, prop_ids_len,
+		rettv->vval.v_list, add_lnum);
     else
 	for (lnum = start_lnum; lnum <= end_lnum; lnum++)
 	    get_props_in_line(buf, lnum, prop_types, prop_types_len,
@@ -1571,6 +1765,36 @@ errret:
     VIM_CLEAR(prop_ids);
 }
 
+/*
+ * Return TRUE if text property "prop" matches "id" and the type: "type_id"
+ * when "num_type_ids" is zero, otherwise one of "type_ids".  When "both" is
+ * TRUE the identifier and the type must match, otherwise one of them.
+ */
+    static int
+prop_matches(
+	textprop_T  *prop,
+	int	    id,
+	int	    type_id,
+	int	    *type_ids,
+	int	    num_type_ids,
+	int	    both)
+{
+    int matches_id = prop->tp_id == id;
+    int matches_type = FALSE;
+
+    if (num_type_ids > 0)
+    {
+	int idx;
+
+	for (idx = 0; !matches_type && idx < num_type_ids; ++idx)
+	    matches_type = prop->tp_type == type_ids[idx];
+    }
+    else
+	matches_type = prop->tp_type == type_id;
+
+    return both ? matches_id && matches_type : matches_id || matches_type;
+}
+
 /*
  * prop_remove({props} [, {lnum} [, {lnum_end}]])
  */
@@ -1591,6 +1815,8 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
     int		num_type_ids = 0;   // number of elements in "type_ids"
     int		both;
     int		did_remove_text = FALSE;
+    garray_T	*index;
+    int		index_idx = 0;
 
     rettv->vval.v_number = 0;
 
@@ -1685,10 +1911,30 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 
     if (end == 0)
 	end = buf->b_ml.ml_line_count;
+    // Removing text properties changes the lines but not the index, it
+    // remains usable to find the next line with a matching property.
+    index = get_prop_index(buf);
+    if (index != NULL)
+	index_idx = prop_index_find(index, start);
     for (lnum = start; lnum <= end; ++lnum)
     {
 	size_t len;
 
+	if (index != NULL)
+	{
+	    propentry_T *entries = (propentry_T *)index->ga_data;
+
+	    while (index_idx < index->ga_len
+		    && (entries[index_idx].pe_lnum < lnum
+			|| !prop_matches(&entries[index_idx].pe_prop, id,
+				       type_id, type_ids, num_type_ids, both)))
+		++index_idx;
+	    if (index_idx == index->ga_len)
+		break;
+	    lnum = entries[index_idx].pe_lnum;
+	    if (lnum > end)
+		break;
+	}
 	if (lnum > buf->b_ml.ml_line_count)
 	    break;
 	len = ml_get_buf_len(buf, lnum) + 1;
@@ -1703,26 +1949,11 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 		char_u *cur_prop = buf->b_ml.ml_line_ptr + len
 						    + idx * sizeof(textprop_T);
 		size_t	taillen;
-		int matches_id = 0;
-		int matches_type = 0;
 
 		mch_memmove(&textprop, cur_prop, sizeof(textprop_T));
 
-		matches_id = textprop.tp_id == id;
-		if (num_type_ids > 0)
-		{
-		    int idx2;
-
-		    for (idx2 = 0; !matches_type && idx2 < num_type_ids; ++idx2)
-			matches_type = textprop.tp_type == type_ids[idx2];
-		}
-		else
-		{
-		    matches_type = textprop.tp_type == type_id;
-		}
-
-		if (both ? matches_id && matches_type
-			 : matches_id || matches_type)
+		if (prop_matches(&textprop, id, type_id, type_ids,
+							   num_type_ids, both))
 		{
 		    if (!(buf->b_ml.ml_flags & ML_LINE_DIRTY))
 		    {
@@ -1777,6 +2008,7 @@ f_prop_remove(typval_T *argvars, typval_T *rettv)
 
     if (first_changed > 0)
     {
+	prop_index_invalidate(buf);
 	changed_line_display_buf(buf);
 	changed_lines_buf(buf, first_changed, last_changed + 1, 0);
 	redraw_buf_later(buf, UPD_VALID);
@@ -2314,6 +2546,7 @@ adjust_prop_columns(
 	}
 	curbuf->b_ml.ml_flags |= ML_LINE_DIRTY;
 	curbuf->b_ml.ml_line_len = newlen;
+	prop_index_invalidate(curbuf);
     }
     return dirty;
 }
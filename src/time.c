@@ -397,6 +397,16 @@ f_strptime(typval_T *argvars, typval_T *rettv)
 static timer_T	*first_timer = NULL;
 static long	last_timer_id = 0;
 
+// The timers that are waiting to be invoked, in a binary heap ordered on
+// "tr_due", so that the next one to be invoked is always the first item.
+// Paused timers and timers whose callback is being invoked are not in it.
+static garray_T	timer_heap = {0, 0, sizeof(timer_T *), 20, NULL};
+#define TIMER_HEAP(idx)	(((timer_T **)timer_heap.ga_data)[idx])
+
+// Incremented for every call to check_due_timer(), timers put in the heap in
+// the same call are not invoked yet.
+static varnumber_T timer_pass = 0;
+
 /*
  * Return time left, in "msec", until "due".  Negative if past "due".
  */
@@ -419,6 +429,104 @@ proftime_time_left(proftime_T *due, proftime_T *now)
 #  endif
 }
 
+/*
+ * Return TRUE if "t1" is to be invoked before "t2".  Timers with the same due
+ * time are invoked in the order they were created.
+ */
+    static int
+timer_before(timer_T *t1, timer_T *t2)
+{
+#  ifdef MSWIN
+    if (t1->tr_due.QuadPart != t2->tr_due.QuadPart)
+	return t1->tr_due.QuadPart < t2->tr_due.QuadPart;
+#  else
+    if (t1->tr_due.tv_sec != t2->tr_due.tv_sec)
+	return t1->tr_due.tv_sec < t2->tr_due.tv_sec;
+    if (t1->tr_due.tv_fsec != t2->tr_due.tv_fsec)
+	return t1->tr_due.tv_fsec < t2->tr_due.tv_fsec;
+#  endif
+    return t1->tr_id < t2->tr_id;
+}
+
+/*
+ * Put "timer" at "idx" in the heap.
+ */
+    static void
+timer_heap_set(int idx, timer_T *timer)
+{
+    TIMER_HEAP(idx) = timer;
+    timer->tr_heap_idx = idx;
+}
+
+/*
+ * Move the timer at "idx" up or down in the heap until it is in the right
+ * position.
+ */
+    static void
+timer_heap_fix(int idx)
+{
+    timer_T	*timer = TIMER_HEAP(idx);
+    int		parent;
+    int		child;
+
+    while (idx > 0)
+    {
+	parent = (idx - 1) / 2;
+	if (!timer_before(timer, TIMER_HEAP(parent)))
+	    break;
+	timer_heap_set(idx, TIMER_HEAP(parent));
+	idx = parent;
+    }
+    for (;;)
+    {
+	child = idx * 2 + 1;
+	if (child >= timer_heap.ga_len)
+	    break;
+	if (child + 1 < timer_heap.ga_len
+		&& timer_before(TIMER_HEAP(child + 1), TIMER_HEAP(child)))
+	    ++child;
+	if (!timer_before(TIMER_HEAP(child), timer))
+	    break;
+	timer_heap_set(idx, TIMER_HEAP(child));
+	idx = child;
+    }
+    timer_heap_set(idx, timer);
+}
+
+/*
+ * Add "timer" to the heap of timers waiting to be invoked, or move it to the
+ * right position when "tr_due" was changed.
+ */
+    static void
+timer_heap_add(timer_T *timer)
+{
+    timer->tr_pass = timer_pass;
+    if (timer->tr_heap_idx < 0)
+    {
+	if (ga_grow(&timer_heap, 1) == FAIL)
+	    return;
+	timer_heap_set(timer_heap.ga_len++, timer);
+    }
+    timer_heap_fix(timer->tr_heap_idx);
+}
+
+/*
+ * Take "timer" out of the heap of timers waiting to be invoked.
+ */
+    static void
+timer_heap_remove(timer_T *timer)
+{
+    int		idx = timer->tr_heap_idx;
+
+    if (idx < 0)
+	return;
+    timer->tr_heap_idx = -1;
+    if (idx == --timer_heap.ga_len)
+	return;
+    timer_heap_set(idx, TIMER_HEAP(timer_heap.ga_len));
+    timer_heap_fix(idx);
+}
+
 /*
  * Insert a timer in the list of timers.
  */
@@ -439,6 +547,7 @@ insert_timer(timer_T *timer)
     static void
 remove_timer(timer_T *timer)
 {
+    timer_heap_remove(timer);
     if (timer->tr_prev == NULL)
 	first_timer = timer->tr_next;
     else
@@ -470,6 +579,7 @@ create_timer(long msec, int repeat)
 	// Overflow!  Might cause duplicates...
 	last_timer_id = 0;
     timer->tr_id = last_timer_id;
+    timer->tr_heap_idx = -1;
     insert_timer(timer);
     if (repeat != 0)
 	timer->tr_repeat = repeat - 1;
@@ -487,6 +597,27 @@ timer_start(timer_T *timer)
 {
     profile_setlimit(timer->tr_interval, &timer->tr_due);
     timer->tr_paused = FALSE;
+    if (!timer->tr_firing)
+	timer_heap_add(timer);
+}
+
+/*
+ * Remember how late "timer" is invoked, for timer_info().
+ */
+    static void
+timer_update_late(timer_T *timer)
+{
+    proftime_T	late;
+
+    profile_start(&late);
+    profile_sub(&late, &timer->tr_due);
+    timer->tr_late = (long)(profile_float(&late) * 1000);
+    // may be invoked up to one msec early
+    if (timer->tr_late < 0)
+	timer->tr_late = 0;
+    if (timer->tr_late > timer->tr_maxlate)
+	timer->tr_maxlate = timer->tr_late;
+    ++timer->tr_fired;
 }
 
 /*
@@ -530,13 +661,13 @@ timer_callback(timer_T *timer)
 check_due_timer(void)
 {
     timer_T	*timer;
-    timer_T	*timer_next;
     long	this_due;
     long	next_due = -1;
     proftime_T	now;
     int		did_one = FALSE;
     int		need_update_screen = FALSE;
     long	current_id = last_timer_id;
+    varnumber_T	pass;
 
     // Don't run any timers while exiting, dealing with an error or at the
     // debug prompt.
@@ -544,90 +675,100 @@ check_due_timer(void)
 	return next_due;
 
     profile_start(&now);
-    for (timer = first_timer; timer != NULL && !got_int; timer = timer_next)
-    {
-	timer_next = timer->tr_next;
+    pass = ++timer_pass;
 
-	if (timer->tr_id == -1 || timer->tr_firing || timer->tr_paused)
-	    continue;
+    // Invoke the timers that are due, the first one due first.  Timers that
+    // are due within the same msec are all invoked now.  A timer that is
+    // (re)started by a callback is not invoked until the next time.
+    while (timer_heap.ga_len > 0 && !got_int)
+    {
+	timer = TIMER_HEAP(0);
+	if (timer->tr_pass >= pass)
+	    break;
 	this_due = proftime_time_left(&timer->tr_due, &now);
-	if (this_due <= 1)
+	if (this_due > 1)
+	    break;
+
+	timer_heap_remove(timer);
+
+	// Save and restore a lot of flags, because the timer fires while
+	// waiting for a character, which might be halfway a command.
+	int save_timer_busy = timer_busy;
+	int save_vgetc_busy = vgetc_busy;
+	int save_did_emsg = did_emsg;
+	int prev_uncaught_emsg = uncaught_emsg;
+	int save_called_emsg = called_emsg;
+	int save_must_redraw = must_redraw;
+	int save_ex_pressedreturn = get_pressedreturn();
+	int save_may_garbage_collect = may_garbage_collect;
+	vimvars_save_T	vvsave;
+	exception_state_T	estate;
+
+	exception_state_save(&estate);
+
+	// Create a scope for running the timer callback, ignoring most of
+	// the current scope, such as being inside a try/catch.
+	timer_busy = timer_busy > 0 || vgetc_busy > 0;
+	vgetc_busy = 0;
+	called_emsg = 0;
+	did_emsg = FALSE;
+	must_redraw = 0;
+	may_garbage_collect = FALSE;
+	exception_state_clear();
+	save_vimvars(&vvsave);
+
+	timer_update_late(timer);
+
+	// Invoke the callback.
+	timer->tr_firing = TRUE;
+	timer_callback(timer);
+	timer->tr_firing = FALSE;
+
+	// Restore stuff.
+	did_one = TRUE;
+	timer_busy = save_timer_busy;
+	vgetc_busy = save_vgetc_busy;
+	if (uncaught_emsg > prev_uncaught_emsg)
+	    ++timer->tr_emsg_count;
+	did_emsg = save_did_emsg;
+	called_emsg = save_called_emsg;
+	exception_state_restore(&estate);
+	restore_vimvars(&vvsave);
+	if (must_redraw != 0)
+	    need_update_screen = TRUE;
+	must_redraw = must_redraw > save_must_redraw
+					  ? must_redraw : save_must_redraw;
+	set_pressedreturn(save_ex_pressedreturn);
+	may_garbage_collect = save_may_garbage_collect;
+
+	// Only fire the timer again if it repeats and stop_timer() wasn't
+	// called while inside the callback (tr_id == -1).
+	if (timer->tr_repeat != 0 && timer->tr_id != -1
+		&& timer->tr_emsg_count < 3)
 	{
-	    // Save and restore a lot of flags, because the timer fires while
-	    // waiting for a character, which might be halfway a command.
-	    int save_timer_busy = timer_busy;
-	    int save_vgetc_busy = vgetc_busy;
-	    int save_did_emsg = did_emsg;
-	    int prev_uncaught_emsg = uncaught_emsg;
-	    int save_called_emsg = called_emsg;
-	    int save_must_redraw = must_redraw;
-	    int save_ex_pressedreturn = get_pressedreturn();
-	    int save_may_garbage_collect = may_garbage_collect;
-	    vimvars_save_T	vvsave;
-	    exception_state_T	estate;
-
-	    exception_state_save(&estate);
-
-	    // Create a scope for running the timer callback, ignoring most of
-	    // the current scope, such as being inside a try/catch.
-	    timer_busy = timer_busy > 0 || vgetc_busy > 0;
-	    vgetc_busy = 0;
-	    called_emsg = 0;
-	    did_emsg = FALSE;
-	    must_redraw = 0;
-	    may_garbage_collect = FALSE;
-	    exception_state_clear();
-	    save_vimvars(&vvsave);
-
-	    // Invoke the callback.
-	    timer->tr_firing = TRUE;
-	    timer_callback(timer);
-	    timer->tr_firing = FALSE;
-
-	    // Restore stuff.
-	    timer_next = timer->tr_next;
-	    did_one = TRUE;
-	    timer_busy = save_timer_busy;
-	    vgetc_busy = save_vgetc_busy;
-	    if (uncaught_emsg > prev_uncaught_emsg)
-		++timer->tr_emsg_count;
-	    did_emsg = save_did_emsg;
-	    called_emsg = save_called_emsg;
-	    exception_state_restore(&estate);
-	    restore_vimvars(&vvsave);
-	    if (must_redraw != 0)
-		need_update_screen = TRUE;
-	    must_redraw = must_redraw > save_must_redraw
-					      ? must_redraw : save_must_redraw;
-	    set_pressedreturn(save_ex_pressedreturn);
-	    may_garbage_collect = save_may_garbage_collect;
-
-	    // Only fire the timer again if it repeats and stop_timer() wasn't
-	    // called while inside the callback (tr_id == -1).
-	    if (timer->tr_repeat != 0 && timer->tr_id != -1
-		    && timer->tr_emsg_count < 3)
-	    {
-		profile_setlimit(timer->tr_interval, &timer->tr_due);
-		this_due = proftime_time_left(&timer->tr_due, &now);
-		if (this_due < 1)
-		    this_due = 1;
-		if (timer->tr_repeat > 0)
-		    --timer->tr_repeat;
-	    }
+	    profile_setlimit(timer->tr_interval, &timer->tr_due);
+	    if (!timer->tr_paused)
+		timer_heap_add(timer);
+	    if (timer->tr_repeat > 0)
+		--timer->tr_repeat;
+	}
+	else
+	{
+	    if (timer->tr_keep)
+		timer->tr_paused = TRUE;
 	    else
 	    {
-		this_due = -1;
-		if (timer->tr_keep)
-		    timer->tr_paused = TRUE;
-		else
-		{
-		    remove_timer(timer);
-		    free_timer(timer);
-		}
+		remove_timer(timer);
+		free_timer(timer);
 	    }
 	}
-	if (this_due > 0 && (next_due == -1 || next_due > this_due))
-	    next_due = this_due;
+    }
+
+    if (timer_heap.ga_len > 0)
+    {
+	next_due = proftime_time_left(&TIMER_HEAP(0)->tr_due, &now);
+	if (next_due < 1)
+	    next_due = 1;
     }
 
     if (did_one)
@@ -735,6 +876,9 @@ add_timer_info(typval_T *rettv, timer_T *timer)
 	    (long)(timer->tr_repeat < 0 ? -1
 			     : timer->tr_repeat + (timer->tr_firing ? 0 : 1)));
     dict_add_number(dict, "paused", (long)(timer->tr_paused));
+    dict_add_number(dict, "fired", timer->tr_fired);
+    dict_add_number(dict, "late", timer->tr_late);
+    dict_add_number(dict, "maxlate", timer->tr_maxlate);
 
     di = dictitem_alloc((char_u *)"callback");
     if (di != NULL)
@@ -809,6 +953,7 @@ timer_free_all(void)
 	remove_timer(timer);
 	free_timer(timer);
     }
+    ga_clear(&timer_heap);
 }
 # endif
 
@@ -858,8 +1003,13 @@ f_timer_pause(typval_T *argvars, typval_T *rettv UNUSED)
     int	paused = (int)tv_get_bool(&argvars[1]);
 
     timer = find_timer((int)tv_get_number(&argvars[0]));
-    if (timer != NULL)
-	timer->tr_paused = paused;
+    if (timer == NULL)
+	return;
+    timer->tr_paused = paused;
+    if (paused)
+	timer_heap_remove(timer);
+    else if (!timer->tr_firing)
+	timer_heap_add(timer);
 }
 
 /*
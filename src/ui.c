@@ -275,6 +275,9 @@ inchar_loop(
     int		interrupted = FALSE;
     int		did_call_wait_func = FALSE;
     int		did_start_blocking = FALSE;
+#if defined(FEAT_SYN_HL) && defined(FEAT_RELTIME)
+    int		did_idle_work = FALSE;
+#endif
     long	wait_time;
     long	elapsed_time = 0;
 #ifdef ELAPSED_FUNC
@@ -378,6 +381,23 @@ inchar_loop(
 	    wait_time = 100L;
 #endif
 
+#if defined(FEAT_SYN_HL) && defined(FEAT_RELTIME)
+	// While waiting for the user to type parse syntax ahead of what is
+	// displayed.  Only check for a character then, come back here if there
+	// is none.
+	did_idle_work = wtime < 0 && wait_time != 0 && syn_idle_parse();
+	if (did_idle_work)
+	{
+	    wait_time = 0;
+# ifdef FEAT_TIMERS
+	    // Timers should not wait for the parsing to be done.
+	    check_due_timer();
+	    if (typebuf_changed(tb_change_cnt))
+		return 0;
+# endif
+	}
+#endif
+
 	// Wait for a character to be typed or another event, such as the winch
 	// signal or an event on the monitored file descriptors.
 	did_call_wait_func = TRUE;
@@ -425,6 +445,9 @@ inchar_loop(
 		|| interrupted
 #endif
 		|| wait_time > 0
+#if defined(FEAT_SYN_HL) && defined(FEAT_RELTIME)
+		|| did_idle_work
+#endif
 		|| (wtime < 0 && !did_start_blocking))
 	    // no character available, but something to be done, keep going
 	    continue;
@@ -562,6 +562,14 @@ typedef long long vimlong_T;
 # endif
 #endif
 
+// When select() is used, channels are watched with epoll where available, so
+// that only one file descriptor is passed to select() for all of them.
+#if defined(HAVE_SELECT) && defined(HAVE_SYS_EPOLL_H) \
+	&& defined(FEAT_JOB_CHANNEL) && !defined(MSWIN)
+# include <sys/epoll.h>
+# define USE_EPOLL
+#endif
+
 #ifdef HAVE_SODIUM
 # include <sodium.h>
 #endif
@@ -978,8 +986,6 @@ extern int (*dyn_libintl_wputenv)(const wchar_t *envstring);
 
 #ifdef FEAT_SYN_HL
 # define SST_MIN_ENTRIES 150	// minimal size for state stack array
-# define SST_MAX_ENTRIES 1000	// maximal size for state stack array
-# define SST_FIX_STATES	 7	// size of sst_stack[].
 # define SST_DIST	 16	// normal distance between entries
 # define SST_INVALID	((synstate_T *)-1)	// invalid syn_state pointer
 
@@ -228,6 +228,12 @@ typedef enum {
 
     ISN_SCRIPTCTX_SET, // set script context for expression evaluation
 
+    // Superinstructions, replacing the first instruction of a sequence.  The
+    // other instructions are kept, they are skipped when executing.
+    ISN_LOAD_LOAD_OPNR,	    // ISN_LOAD, ISN_LOAD, ISN_OPNR or ISN_COMPARENR
+    ISN_LOAD_PUSHNR_OPNR,   // ISN_LOAD, ISN_PUSHNR, ISN_OPNR or ISN_COMPARENR
+    ISN_JUMP_FOR,	    // ISN_JUMP to an ISN_FOR, uses isn_arg.jump
+
     ISN_FINISH	    // end marker in list of instructions
 } isntype_T;
 
@@ -340,6 +346,9 @@ typedef struct {
 typedef struct {
     exprtype_T	op_type;
     int		op_ic;	    // TRUE with '#', FALSE with '?', else MAYBE
+    int		op_inferred;  // TRUE when the instruction is type-specific
+			      // because of an earlier type check or a number
+			      // used as a float
 } opexpr_T;
 
 // arguments to ISN_CHECKTYPE
@@ -569,6 +569,14 @@ need_type_where(
     {
 	generate_TYPECHECK(cctx, expected, number_ok, offset,
 		where.wt_kind == WT_VARIABLE, where.wt_index);
+
+	// After the check the value has the expected type, a type-specific
+	// instruction can be used for it.  Not when a number is accepted for
+	// a float, it is not converted.
+	if (offset < 0 && (expected->tt_type == VAR_NUMBER
+		    || expected->tt_type == VAR_STRING
+		    || (expected->tt_type == VAR_FLOAT && !number_ok)))
+	    set_type_on_stack(cctx, expected, -1 - offset);
 	return OK;
     }
 
@@ -2621,7 +2629,7 @@ compile_load_lhs_with_index(lhs_T *lhs, char_u *var_start, cctx_T *cctx)
 	}
 
 	// Get the member.
-	if (compile_member(FALSE, NULL, cctx) == FAIL)
+	if (compile_member(FALSE, NULL, NULL, cctx) == FAIL)
 	    return FAIL;
     }
     return OK;
@@ -3514,6 +3522,8 @@ compile_assign_compound_op(cctx_T *cctx, cac_T *cac)
 		&& need_type(stacktype, expected, TRUE, -1, 0, cctx,
 					FALSE, FALSE) == FAIL)
 	    return FAIL;
+	// the type may have been set by a runtime type check
+	stacktype = get_type_on_stack(cctx, 0);
     }
 
     if (*cac->cac_op == '.')
@@ -4910,6 +4920,8 @@ compile_dfunc_epilogue(
 {
     dfunc_T	*dfunc;
 
+    generate_superinstructions(cctx);
+
     dfunc = ((dfunc_T *)def_functions.ga_data) + ufunc->uf_dfunc_idx;
     dfunc->df_deleted = FALSE;
     dfunc->df_script_seq = current_sctx.sc_seq;
@@ -3556,6 +3556,93 @@ exec_unpack_tuple(ectx_T *ectx, isn_T *iptr, typval_T *tv)
     return EXEC_OK;
 }
 
+/*
+ * Compute "arg1 op arg2" for ISN_OPNR and ISN_COMPARENR.
+ * Division by zero must have been checked for.
+ */
+    static varnumber_T
+opnr_result(exprtype_T op, varnumber_T arg1, varnumber_T arg2)
+{
+    switch (op)
+    {
+	case EXPR_MULT: return arg1 * arg2;
+	case EXPR_DIV: return arg1 / arg2;
+	case EXPR_REM: return arg1 % arg2;
+	case EXPR_SUB: return arg1 - arg2;
+	case EXPR_ADD: return arg1 + arg2;
+
+	case EXPR_EQUAL: return arg1 == arg2;
+	case EXPR_NEQUAL: return arg1 != arg2;
+	case EXPR_GREATER: return arg1 > arg2;
+	case EXPR_GEQUAL: return arg1 >= arg2;
+	case EXPR_SMALLER: return arg1 < arg2;
+	case EXPR_SEQUAL: return arg1 <= arg2;
+	case EXPR_LSHIFT: if (arg2 > MAX_LSHIFT_BITS)
+			      return 0;
+			  return (uvarnumber_T)arg1 << arg2;
+	case EXPR_RSHIFT: if (arg2 > MAX_LSHIFT_BITS)
+			      return 0;
+			  return (uvarnumber_T)arg1 >> arg2;
+	default: break;
+    }
+    return 0;
+}
+
+/*
+ * Execute the ISN_LOAD_LOAD_OPNR or ISN_LOAD_PUSHNR_OPNR superinstruction.
+ * Returns NOTDONE when the following instructions need to be executed one by
+ * one, e.g. for an argument that was not set or to give an error message.
+ * Returns FAIL when out of memory.
+ */
+    static int
+exec_load_opnr(isn_T *iptr, ectx_T *ectx)
+{
+    typval_T	*tv;
+    isn_T	*op_iptr = iptr + 2;
+    exprtype_T	op = op_iptr->isn_arg.op.op_type;
+    varnumber_T	arg1;
+    varnumber_T	arg2;
+
+    tv = STACK_TV_VAR(iptr->isn_arg.number);
+    if (tv->v_type != VAR_NUMBER)
+	return NOTDONE;
+    arg1 = tv->vval.v_number;
+    if (iptr->isn_type == ISN_LOAD_LOAD_OPNR)
+    {
+	tv = STACK_TV_VAR(iptr[1].isn_arg.number);
+	if (tv->v_type != VAR_NUMBER)
+	    return NOTDONE;
+	arg2 = tv->vval.v_number;
+    }
+    else
+	arg2 = iptr[1].isn_arg.number;
+
+    if (arg2 == 0 ? op == EXPR_DIV || op == EXPR_REM
+		  : arg2 < 0 && (op == EXPR_LSHIFT || op == EXPR_RSHIFT))
+	return NOTDONE;
+
+    if (GA_GROW_FAILS(&ectx->ec_stack, 1))
+	return FAIL;
+    tv = STACK_TV_BOT(0);
+    tv->v_lock = 0;
+    if (op_iptr->isn_type == ISN_COMPARENR)
+    {
+	tv->v_type = VAR_BOOL;
+	tv->vval.v_number = opnr_result(op, arg1, arg2)
+						      ? VVAL_TRUE : VVAL_FALSE;
+    }
+    else
+    {
+	tv->v_type = VAR_NUMBER;
+	tv->vval.v_number = opnr_result(op, arg1, arg2);
+    }
+    ++ectx->ec_stack.ga_len;
+
+    // skip over the ISN_LOAD/ISN_PUSHNR and the ISN_OPNR/ISN_COMPARENR
+    ectx->ec_iidx += 2;
+    return OK;
+}
+
 /*
  * Execute instructions in execution context "ectx".
  * Return OK or FAIL;
@@ -4091,6 +4178,19 @@ exec_instructions(ectx_T *ectx)
 		}
 		break;
 
+	    // load local variables or argument and a number operation
+	    case ISN_LOAD_LOAD_OPNR:
+	    case ISN_LOAD_PUSHNR_OPNR:
+		{
+		    int r = exec_load_opnr(iptr, ectx);
+
+		    if (r == OK)
+			break;
+		    if (r == FAIL)
+			goto theend;
+		}
+		// FALLTHROUGH
+
 	    // load local variable or argument
 	    case ISN_LOAD:
 		if (GA_GROW_FAILS(&ectx->ec_stack, 1))
@@ -5211,6 +5311,14 @@ exec_instructions(ectx_T *ectx)
 		    goto theend;
 		break;
 
+	    // jump back to the top of a for loop and execute it
+	    case ISN_JUMP_FOR:
+		ectx->ec_iidx = iptr->isn_arg.jump.jump_where + 1;
+		if (execute_for(&ectx->ec_instr[ectx->ec_iidx - 1], ectx)
+								       == FAIL)
+		    goto theend;
+		break;
+
 	    // end of a for or while loop
 	    case ISN_ENDLOOP:
 		if (execute_endloop(iptr, ectx) == FAIL)
@@ -5467,40 +5575,12 @@ exec_instructions(ectx_T *ectx)
 			}
 		    }
 
-		    switch (iptr->isn_arg.op.op_type)
-		    {
-			case EXPR_MULT: res = arg1 * arg2; break;
-			case EXPR_DIV:  if (arg2 == 0)
-					    div_zero = TRUE;
-					else
-					    res = arg1 / arg2;
-					break;
-			case EXPR_REM:  if (arg2 == 0)
-					    div_zero = TRUE;
-					else
-					    res = arg1 % arg2;
-					break;
-			case EXPR_SUB: res = arg1 - arg2; break;
-			case EXPR_ADD: res = arg1 + arg2; break;
-
-			case EXPR_EQUAL: res = arg1 == arg2; break;
-			case EXPR_NEQUAL: res = arg1 != arg2; break;
-			case EXPR_GREATER: res = arg1 > arg2; break;
-			case EXPR_GEQUAL: res = arg1 >= arg2; break;
-			case EXPR_SMALLER: res = arg1 < arg2; break;
-			case EXPR_SEQUAL: res = arg1 <= arg2; break;
-			case EXPR_LSHIFT: if (arg2 > MAX_LSHIFT_BITS)
-					      res = 0;
-					  else
-					      res = (uvarnumber_T)arg1 << arg2;
-					  break;
-			case EXPR_RSHIFT: if (arg2 > MAX_LSHIFT_BITS)
-					      res = 0;
-					  else
-					      res = (uvarnumber_T)arg1 >> arg2;
-					  break;
-			default: break;
-		    }
+		    if (arg2 == 0 && (iptr->isn_arg.op.op_type == EXPR_DIV
+				       || iptr->isn_arg.op.op_type == EXPR_REM))
+			div_zero = TRUE;
+		    else
+			res = opnr_result(iptr->isn_arg.op.op_type,
+								  arg1, arg2);
 
 		    --ectx->ec_stack.ga_len;
 		    if (iptr->isn_type == ISN_COMPARENR)
@@ -5525,11 +5605,18 @@ exec_instructions(ectx_T *ectx)
 		{
 		    typval_T	*tv1 = STACK_TV_BOT(-2);
 		    typval_T	*tv2 = STACK_TV_BOT(-1);
-		    float_T	arg1 = tv1->vval.v_float;
-		    float_T	arg2 = tv2->vval.v_float;
+		    float_T	arg1;
+		    float_T	arg2;
 		    float_T	res = 0;
 		    int		cmp = FALSE;
 
+		    // One of the arguments may be a number, e.g. for "nr * 1.5"
+		    // or a number assigned to a float variable.
+		    arg1 = tv1->v_type == VAR_NUMBER
+			    ? (float_T)tv1->vval.v_number : tv1->vval.v_float;
+		    arg2 = tv2->v_type == VAR_NUMBER
+			    ? (float_T)tv2->vval.v_number : tv2->vval.v_float;
+
 		    switch (iptr->isn_arg.op.op_type)
 		    {
 			case EXPR_MULT: res = arg1 * arg2; break;
@@ -5552,7 +5639,10 @@ exec_instructions(ectx_T *ectx)
 			tv1->vval.v_number = cmp ? VVAL_TRUE : VVAL_FALSE;
 		    }
 		    else
+		    {
+			tv1->v_type = VAR_FLOAT;
 			tv1->vval.v_float = res;
+		    }
 		}
 		break;
 
@@ -7170,13 +7260,19 @@ list_instructions(char *pfx, isn_T *instr, int instr_count, ufunc_T *ufunc)
 					  (varnumber_T)(iptr->isn_arg.number));
 		break;
 	    case ISN_LOAD:
+	    case ISN_LOAD_LOAD_OPNR:
+	    case ISN_LOAD_PUSHNR_OPNR:
 		{
+		    char *ins = iptr->isn_type == ISN_LOAD ? "LOAD"
+				: iptr->isn_type == ISN_LOAD_LOAD_OPNR
+				? "LOAD_LOAD_OPNR" : "LOAD_PUSHNR_OPNR";
+
 		    if (iptr->isn_arg.number < 0)
-			smsg("%s%4d LOAD arg[%lld]", pfx, current,
+			smsg("%s%4d %s arg[%lld]", pfx, current, ins,
 				(varnumber_T)(iptr->isn_arg.number
 							  + STACK_FRAME_SIZE));
 		    else
-			smsg("%s%4d LOAD $%lld", pfx, current,
+			smsg("%s%4d %s $%lld", pfx, current, ins,
 					  (varnumber_T)(iptr->isn_arg.number));
 		}
 		break;
@@ -7643,6 +7739,11 @@ list_instructions(char *pfx, isn_T *instr, int instr_count, ufunc_T *ufunc)
 		}
 		break;
 
+	    case ISN_JUMP_FOR:
+		smsg("%s%4d JUMP_FOR -> %d", pfx, current,
+						iptr->isn_arg.jump.jump_where);
+		break;
+
 	    case ISN_JUMP_IF_ARG_SET:
 		smsg("%s%4d JUMP_IF_ARG_SET arg[%d] -> %d", pfx, current,
 			 iptr->isn_arg.jumparg.jump_arg_off + STACK_FRAME_SIZE,
@@ -7753,7 +7854,9 @@ list_instructions(char *pfx, isn_T *instr, int instr_count, ufunc_T *ufunc)
 			case ISN_OPANY: ins = "OPANY"; break;
 			default: ins = "???"; break;
 		    }
-		    smsg("%s%4d %s %s", pfx, current, ins, what);
+		    smsg("%s%4d %s %s%s", pfx, current, ins, what,
+			    iptr->isn_arg.op.op_inferred
+						 ? " (type check elided)" : "");
 		}
 		break;
 
@@ -7813,7 +7916,9 @@ list_instructions(char *pfx, isn_T *instr, int instr_count, ufunc_T *ufunc)
 			   default: type = "???"; break;
 		       }
 
-		       smsg("%s%4d %s %s", pfx, current, type, buf);
+		       smsg("%s%4d %s %s%s", pfx, current, type, buf,
+			       iptr->isn_arg.op.op_inferred
+						 ? " (type check elided)" : "");
 		   }
 		   break;
 
@@ -67,14 +67,37 @@ clear_ppconst(ppconst_T *ppconst)
     ppconst->pp_used = 0;
 }
 
+/*
+ * When the index of a tuple with type "type" is the constant "*const_index",
+ * return the type of the item at that index.  Returns NULL when it is not
+ * known.
+ */
+    static type_T *
+tuple_const_item_type(type_T *type, varnumber_T *const_index)
+{
+    varnumber_T	idx;
+
+    if (const_index == NULL || type->tt_args == NULL
+					    || (type->tt_flags & TTFLAG_VARARGS))
+	return NULL;
+    idx = *const_index;
+    if (idx < 0)
+	idx += type->tt_argcount;
+    if (idx < 0 || idx >= type->tt_argcount)
+	return NULL;
+    return type->tt_args[idx];
+}
+
 /*
  * Compile getting a member from a tuple.  Stack has the indexable value and
  * the index or the two indexes of a slice.
+ * "const_index" points to the index when it is a constant, otherwise NULL.
  */
     static int
 compile_tuple_member(
     type2_T	*typep,
     int		is_slice,
+    varnumber_T	*const_index,
     cctx_T	*cctx)
 {
     if (is_slice)
@@ -101,6 +124,8 @@ compile_tuple_member(
     {
 	if (typep->type_curr->tt_type == VAR_TUPLE)
 	{
+	    type_T *item_type;
+
 	    if (typep->type_curr->tt_argcount == 1)
 	    {
 		if (typep->type_curr->tt_flags & TTFLAG_VARARGS)
@@ -109,6 +134,10 @@ compile_tuple_member(
 		else
 		    typep->type_curr = typep->type_curr->tt_args[0];
 	    }
+	    else if ((item_type = tuple_const_item_type(typep->type_curr,
+							const_index)) != NULL)
+		// constant index, e.g. "tuple[1]"
+		typep->type_curr = item_type;
 	    else
 		typep->type_curr = &t_any;
 	    if (typep->type_decl->tt_type == VAR_TUPLE)
@@ -121,8 +150,11 @@ compile_tuple_member(
 		    else
 			typep->type_decl = typep->type_decl->tt_args[0];
 		}
+		else if ((item_type = tuple_const_item_type(typep->type_decl,
+							const_index)) != NULL)
+		    typep->type_decl = item_type;
 		else
-		    typep->type_curr = &t_any;
+		    typep->type_decl = &t_any;
 	    }
 	    else
 		typep->type_decl = typep->type_curr;
@@ -138,9 +170,14 @@ compile_tuple_member(
  * Compile getting a member from a list/tuple/dict/string/blob.  Stack has the
  * indexable value and the index or the two indexes of a slice.
  * "keeping_dict" is used for dict[func](arg) to pass dict to func.
+ * "const_index" points to the index when it is a constant, otherwise NULL.
  */
     int
-compile_member(int is_slice, int *keeping_dict, cctx_T *cctx)
+compile_member(
+	int		is_slice,
+	int		*keeping_dict,
+	varnumber_T	*const_index,
+	cctx_T		*cctx)
 {
     type2_T	*typep;
     garray_T	*stack = &cctx->ctx_type_stack;
@@ -239,7 +276,7 @@ compile_member(int is_slice, int *keeping_dict, cctx_T *cctx)
     }
     else if (vartype == VAR_TUPLE)
     {
-	if (compile_tuple_member(typep, is_slice, cctx) == FAIL)
+	if (compile_tuple_member(typep, is_slice, const_index, cctx) == FAIL)
 	    return FAIL;
     }
     else if (vartype == VAR_LIST || typep->type_curr->tt_type == VAR_ANY
@@ -2734,6 +2771,9 @@ compile_subscript(
 	else if (**arg == '[')
 	{
 	    int		is_slice = FALSE;
+	    int		instr_count;
+	    varnumber_T	const_index = 0;
+	    int		has_const_index = FALSE;
 
 	    // list index: list[123]
 	    // tuple index: tuple[123]
@@ -2754,8 +2794,22 @@ compile_subscript(
 	    }
 	    else
 	    {
+		instr_count = cctx->ctx_instr.ga_len;
 		if (compile_expr0(arg, cctx) == FAIL)
 		    return FAIL;
+		// A constant index results in one ISN_PUSHNR.  Not when it
+		// uses jumps, e.g. "tuple[n ? 0 : 1]".
+		if (cctx->ctx_instr.ga_len == instr_count + 1)
+		{
+		    isn_T *isn = ((isn_T *)cctx->ctx_instr.ga_data)
+								 + instr_count;
+
+		    if (isn->isn_type == ISN_PUSHNR)
+		    {
+			const_index = isn->isn_arg.number;
+			has_const_index = TRUE;
+		    }
+		}
 		if (**arg == ':')
 		{
 		    semsg(_(e_white_space_required_before_and_after_str_at_str),
@@ -2805,7 +2859,9 @@ compile_subscript(
 		    return FAIL;
 	    }
 	    if (cctx->ctx_skip != SKIP_YES
-		    && compile_member(is_slice, &keeping_dict, cctx) == FAIL)
+		    && compile_member(is_slice, &keeping_dict,
+			      has_const_index && !is_slice ? &const_index : NULL,
+							       cctx) == FAIL)
 		return FAIL;
 	}
 	else if (*p == '.' && p[1] != '.')
@@ -3507,7 +3563,10 @@ compile_expr5(char_u **arg, cctx_T *cctx, ppconst_T *ppconst)
 		return FAIL;
 
 	    if (isn != NULL)
+	    {
 		isn->isn_arg.op.op_type = type;
+		isn->isn_arg.op.op_inferred = FALSE;
+	    }
 	}
     }
 
@@ -328,6 +328,36 @@ set_tuple_union_type_on_stack(type_T *type1, type_T *type2, cctx_T *cctx)
     return OK;
 }
 
+/*
+ * Return TRUE when the instruction for an operation of "vartype" on "type1"
+ * and "type2" is type-specific only because a type was inferred: a number is
+ * used as a float, or a preceding ISN_CHECKTYPE made sure of the type of an
+ * argument.  Without that a runtime type check would be needed.
+ */
+    static int
+op_is_inferred(
+	cctx_T	    *cctx,
+	vartype_T   vartype,
+	type_T	    *type1,
+	type_T	    *type2)
+{
+    garray_T	*instr = &cctx->ctx_instr;
+    isn_T	*isn;
+
+    if (vartype != VAR_NUMBER && vartype != VAR_FLOAT)
+	return FALSE;
+    if (type1->tt_type != type2->tt_type)
+	return TRUE;
+
+    // The operation instruction was already added.
+    if (instr->ga_len < 2)
+	return FALSE;
+    isn = ((isn_T *)instr->ga_data) + instr->ga_len - 2;
+    return isn->isn_type == ISN_CHECKTYPE
+	    && (isn->isn_arg.type.ct_off == -1 || isn->isn_arg.type.ct_off == -2)
+	    && isn->isn_arg.type.ct_type->tt_type == vartype;
+}
+
 /*
  * Generate instruction for "+".  For a list this creates a new list.
  */
@@ -361,6 +391,8 @@ generate_add_instr(
 	    isn->isn_arg.op.op_type = expr_type;
 	else
 	    isn->isn_arg.op.op_type = EXPR_ADD;
+	isn->isn_arg.op.op_inferred = op_is_inferred(cctx, vartype,
+								type1, type2);
     }
 
     // When concatenating two lists with different member types the member type
@@ -383,7 +415,8 @@ generate_add_instr(
 
 /*
  * Get the type to use for an instruction for an operation on "type1" and
- * "type2".  If they are matching use a type-specific instruction. Otherwise
+ * "type2".  If they are matching use a type-specific instruction.  A number
+ * and a float use the float instruction, it converts the number.  Otherwise
  * fall back to runtime type checking.
  */
     vartype_T
@@ -396,6 +429,9 @@ operator_type(type_T *type1, type_T *type2)
 		|| type1->tt_type == VAR_FLOAT
 		|| type1->tt_type == VAR_BLOB))
 	return type1->tt_type;
+    if ((type1->tt_type == VAR_NUMBER && type2->tt_type == VAR_FLOAT)
+	    || (type1->tt_type == VAR_FLOAT && type2->tt_type == VAR_NUMBER))
+	return VAR_FLOAT;
     return VAR_ANY;
 }
 
@@ -437,8 +473,12 @@ generate_two_op(cctx_T *cctx, char_u *op)
 		  else
 		      isn = generate_instr_drop(cctx, ISN_OPANY, 1);
 		  if (isn != NULL)
+		  {
 		      isn->isn_arg.op.op_type = *op == '*'
 				 ? EXPR_MULT : *op == '/'? EXPR_DIV : EXPR_SUB;
+		      isn->isn_arg.op.op_inferred = op_is_inferred(cctx,
+						      vartype, type1, type2);
+		  }
 		  break;
 
 	case '%': if ((type1->tt_type != VAR_ANY
@@ -454,7 +494,11 @@ generate_two_op(cctx_T *cctx, char_u *op)
 		  isn = generate_instr_drop(cctx,
 			      vartype == VAR_NUMBER ? ISN_OPNR : ISN_OPANY, 1);
 		  if (isn != NULL)
+		  {
 		      isn->isn_arg.op.op_type = EXPR_REM;
+		      isn->isn_arg.op.op_inferred = op_is_inferred(cctx,
+						      vartype, type1, type2);
+		  }
 		  break;
     }
 
@@ -469,6 +513,9 @@ generate_two_op(cctx_T *cctx, char_u *op)
 	    type = &t_float;
 	set_type_on_stack(cctx, type, 0);
     }
+    else if (vartype == VAR_FLOAT && type1->tt_type != VAR_FLOAT)
+	// number+float results in float
+	set_type_on_stack(cctx, &t_float, 0);
 
     return OK;
 }
@@ -526,6 +573,13 @@ get_compare_isn(
 	    default: isntype = ISN_COMPAREANY; break;
 	}
     }
+    else if (((vartype1 == VAR_NUMBER && vartype2 == VAR_FLOAT)
+		|| (vartype1 == VAR_FLOAT && vartype2 == VAR_NUMBER))
+	    && (exprtype == EXPR_EQUAL || exprtype == EXPR_NEQUAL
+		|| exprtype == EXPR_GREATER || exprtype == EXPR_GEQUAL
+		|| exprtype == EXPR_SMALLER || exprtype == EXPR_SEQUAL))
+	// ISN_COMPAREFLOAT converts the number to a float
+	isntype = ISN_COMPAREFLOAT;
     else if (vartype1 == VAR_ANY || vartype2 == VAR_ANY
 	    || ((vartype1 == VAR_NUMBER || vartype1 == VAR_FLOAT)
 			  && (vartype2 == VAR_NUMBER || vartype2 == VAR_FLOAT))
@@ -606,14 +660,17 @@ generate_COMPARE(cctx_T *cctx, exprtype_T exprtype, int ic)
     isntype_T	isntype;
     isn_T	*isn;
     garray_T	*stack = &cctx->ctx_type_stack;
+    type_T	*type1;
+    type_T	*type2;
 
     RETURN_OK_IF_SKIP(cctx);
 
     // Get the known type of the two items on the stack.  If they are matching
     // use a type-specific instruction. Otherwise fall back to runtime type
     // checking.
-    isntype = get_compare_isn(exprtype, NULL, NULL,
-		       get_type_on_stack(cctx, 1), get_type_on_stack(cctx, 0));
+    type1 = get_type_on_stack(cctx, 1);
+    type2 = get_type_on_stack(cctx, 0);
+    isntype = get_compare_isn(exprtype, NULL, NULL, type1, type2);
     if (isntype == ISN_DROP)
 	return FAIL;
 
@@ -621,6 +678,8 @@ generate_COMPARE(cctx_T *cctx, exprtype_T exprtype, int ic)
 	return FAIL;
     isn->isn_arg.op.op_type = exprtype;
     isn->isn_arg.op.op_ic = ic;
+    isn->isn_arg.op.op_inferred = isntype == ISN_COMPAREFLOAT
+				       && type1->tt_type != type2->tt_type;
 
     // takes two arguments, puts one bool back
     --stack->ga_len;
@@ -2641,6 +2700,47 @@ may_generate_prof_end(cctx_T *cctx, int prof_lnum)
 }
 #endif
 
+/*
+ * Optimization: replace the first instruction of a few often used sequences
+ * in the compiled function with a superinstruction that does the work of the
+ * whole sequence, avoiding the overhead of executing each instruction.
+ * The other instructions of the sequence are left in place, so that a jump
+ * into the middle of the sequence still works.
+ */
+    void
+generate_superinstructions(cctx_T *cctx)
+{
+    garray_T	*instr = &cctx->ctx_instr;
+    isn_T	*list = (isn_T *)instr->ga_data;
+    int		idx;
+
+    // Debugging and profiling use the plain instructions.
+    if (cctx->ctx_compile_type != CT_NONE)
+	return;
+
+    for (idx = 0; idx < instr->ga_len; ++idx)
+    {
+	isn_T	*isn = list + idx;
+
+	if (isn->isn_type == ISN_LOAD && idx + 2 < instr->ga_len
+		&& (isn[2].isn_type == ISN_OPNR
+					|| isn[2].isn_type == ISN_COMPARENR))
+	{
+	    // "var1 + var2", "var < 123", etc.
+	    if (isn[1].isn_type == ISN_LOAD)
+		isn->isn_type = ISN_LOAD_LOAD_OPNR;
+	    else if (isn[1].isn_type == ISN_PUSHNR)
+		isn->isn_type = ISN_LOAD_PUSHNR_OPNR;
+	}
+	else if (isn->isn_type == ISN_JUMP
+		&& isn->isn_arg.jump.jump_when == JUMP_ALWAYS
+		&& isn->isn_arg.jump.jump_where < instr->ga_len
+		&& list[isn->isn_arg.jump.jump_where].isn_type == ISN_FOR)
+	    // ":endfor" and ":continue" jump back to the ISN_FOR
+	    isn->isn_type = ISN_JUMP_FOR;
+    }
+}
+
 
 /*
  * Delete an instruction, free what it contains.
@@ -2891,6 +2991,7 @@ delete_instr(isn_T *isn)
 	case ISN_GETITEM:
 	case ISN_GET_OBJ_MEMBER:
 	case ISN_JUMP:
+	case ISN_JUMP_FOR:
 	case ISN_JUMP_IF_ARG_NOT_SET:
 	case ISN_JUMP_IF_ARG_SET:
 	case ISN_LISTAPPEND:
@@ -2899,6 +3000,8 @@ delete_instr(isn_T *isn)
 	case ISN_TUPLEINDEX:
 	case ISN_TUPLESLICE:
 	case ISN_LOAD:
+	case ISN_LOAD_LOAD_OPNR:
+	case ISN_LOAD_PUSHNR_OPNR:
 	case ISN_LOADBDICT:
 	case ISN_LOADGDICT:
 	case ISN_LOADOUTER:
@@ -5949,6 +5949,7 @@ win_free(
 
     vim_free(wp->w_lcs_chars.multispace);
     vim_free(wp->w_lcs_chars.leadmultispace);
+    ga_clear(&wp->w_vcol_cache.vc_points);
 
 #ifdef FEAT_EVAL
     vars_clear(&wp->w_vars->dv_hashtab);	// free all w: variables